@@ -54,6 +54,53 @@ class JuceLibGen {
   late final _juce_enableLogs =
       _juce_enableLogsPtr.asFunction<void Function(int)>();
 
+  /// Strings handed out by this API, returned or passed to a callback, belong to the receiver and stay valid
+  /// until they are given back here.
+  void JuceMixPlayer_freeString(
+    ffi.Pointer<pkg_ffi.Utf8> string,
+  ) {
+    return _JuceMixPlayer_freeString(
+      string,
+    );
+  }
+
+  late final _JuceMixPlayer_freeStringPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<pkg_ffi.Utf8>)>>(
+          'JuceMixPlayer_freeString');
+  late final _JuceMixPlayer_freeString = _JuceMixPlayer_freeStringPtr
+      .asFunction<void Function(ffi.Pointer<pkg_ffi.Utf8>)>();
+
+  /// players created after this call with 1 share one device callback, 0 gives each its own
+  void juce_setSharedOutputBus(
+    int enable,
+  ) {
+    return _juce_setSharedOutputBus(
+      enable,
+    );
+  }
+
+  late final _juce_setSharedOutputBusPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Int)>>(
+          'juce_setSharedOutputBus');
+  late final _juce_setSharedOutputBus =
+      _juce_setSharedOutputBusPtr.asFunction<void Function(int)>();
+
+  /// players released by `JuceMixPlayer_deinit` are kept for `JuceMixPlayer_init`, up to `size` of them created ahead
+  void juce_setPlayerPoolSize(
+    int size,
+  ) {
+    return _juce_setPlayerPoolSize(
+      size,
+    );
+  }
+
+  late final _juce_setPlayerPoolSizePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Int)>>(
+          'juce_setPlayerPoolSize');
+  late final _juce_setPlayerPoolSize =
+      _juce_setPlayerPoolSizePtr.asFunction<void Function(int)>();
+
+  /// a pooled player or a new one
   ffi.Pointer<ffi.Void> JuceMixPlayer_init() {
     return _JuceMixPlayer_init();
   }
@@ -64,6 +111,7 @@ class JuceLibGen {
   late final _JuceMixPlayer_init =
       _JuceMixPlayer_initPtr.asFunction<ffi.Pointer<ffi.Void> Function()>();
 
+  /// back to the pool, or disposed. Callbacks are dropped before it returns.
   void JuceMixPlayer_deinit(
     ffi.Pointer<ffi.Void> ptr,
   ) {
@@ -155,6 +203,170 @@ class JuceLibGen {
       _JuceMixPlayer_setSettingsPtr.asFunction<
           void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>)>();
 
+  void JuceMixPlayer_setTrackVolume(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<pkg_ffi.Utf8> track,
+    double volume,
+  ) {
+    return _JuceMixPlayer_setTrackVolume(
+      ptr,
+      track,
+      volume,
+    );
+  }
+
+  late final _JuceMixPlayer_setTrackVolumePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>,
+              ffi.Float)>>('JuceMixPlayer_setTrackVolume');
+  late final _JuceMixPlayer_setTrackVolume = _JuceMixPlayer_setTrackVolumePtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>, double)>();
+
+  /// seconds
+  void JuceMixPlayer_setTrackOffset(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<pkg_ffi.Utf8> track,
+    double offset,
+  ) {
+    return _JuceMixPlayer_setTrackOffset(
+      ptr,
+      track,
+      offset,
+    );
+  }
+
+  late final _JuceMixPlayer_setTrackOffsetPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>,
+              ffi.Float)>>('JuceMixPlayer_setTrackOffset');
+  late final _JuceMixPlayer_setTrackOffset = _JuceMixPlayer_setTrackOffsetPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>, double)>();
+
+  void JuceMixPlayer_setTrackEnabled(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<pkg_ffi.Utf8> track,
+    int enabled,
+  ) {
+    return _JuceMixPlayer_setTrackEnabled(
+      ptr,
+      track,
+      enabled,
+    );
+  }
+
+  late final _JuceMixPlayer_setTrackEnabledPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>,
+              ffi.Int)>>('JuceMixPlayer_setTrackEnabled');
+  late final _JuceMixPlayer_setTrackEnabled = _JuceMixPlayer_setTrackEnabledPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>, int)>();
+
+  /// seconds of the file from `fromTime`, `duration` 0 plays to its end
+  void JuceMixPlayer_setTrackTrim(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<pkg_ffi.Utf8> track,
+    double fromTime,
+    double duration,
+  ) {
+    return _JuceMixPlayer_setTrackTrim(
+      ptr,
+      track,
+      fromTime,
+      duration,
+    );
+  }
+
+  late final _JuceMixPlayer_setTrackTrimPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>, ffi.Float,
+              ffi.Float)>>('JuceMixPlayer_setTrackTrim');
+  late final _JuceMixPlayer_setTrackTrim = _JuceMixPlayer_setTrackTrimPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>, double, double)>();
+
+  /// `interval` in seconds
+  void JuceMixPlayer_setTrackRepeat(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<pkg_ffi.Utf8> track,
+    int repeat,
+    double interval,
+  ) {
+    return _JuceMixPlayer_setTrackRepeat(
+      ptr,
+      track,
+      repeat,
+      interval,
+    );
+  }
+
+  late final _JuceMixPlayer_setTrackRepeatPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>, ffi.Int,
+              ffi.Float)>>('JuceMixPlayer_setTrackRepeat');
+  late final _JuceMixPlayer_setTrackRepeat = _JuceMixPlayer_setTrackRepeatPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>, int, double)>();
+
+  /// `count` updates heard together, `params[i]` of the track at index `tracks[i]` in `tracks` set to `values[i]`,
+  /// booleans as 0 or 1. params: 0 volume, 1 offset, 2 fromTime, 3 duration, 4 enabled, 5 repeat, 6 repeatInterval.
+  /// One invalid update drops all of them and reports an error.
+  void JuceMixPlayer_updateTracks(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<ffi.Int> tracks,
+    ffi.Pointer<ffi.Int> params,
+    ffi.Pointer<ffi.Float> values,
+    int count,
+  ) {
+    return _JuceMixPlayer_updateTracks(
+      ptr,
+      tracks,
+      params,
+      values,
+      count,
+    );
+  }
+
+  late final _JuceMixPlayer_updateTracksPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Int>,
+              ffi.Pointer<ffi.Int>,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int)>>('JuceMixPlayer_updateTracks');
+  late final _JuceMixPlayer_updateTracks =
+      _JuceMixPlayer_updateTracksPtr.asFunction<
+          void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Int>,
+              ffi.Pointer<ffi.Int>, ffi.Pointer<ffi.Float>, int)>();
+
+  /// `JuceMixPlayer_updateTracks` with track ids
+  void JuceMixPlayer_updateTracksById(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<ffi.Pointer<pkg_ffi.Utf8>> tracks,
+    ffi.Pointer<ffi.Int> params,
+    ffi.Pointer<ffi.Float> values,
+    int count,
+  ) {
+    return _JuceMixPlayer_updateTracksById(
+      ptr,
+      tracks,
+      params,
+      values,
+      count,
+    );
+  }
+
+  late final _JuceMixPlayer_updateTracksByIdPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Pointer<pkg_ffi.Utf8>>,
+              ffi.Pointer<ffi.Int>,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int)>>('JuceMixPlayer_updateTracksById');
+  late final _JuceMixPlayer_updateTracksById =
+      _JuceMixPlayer_updateTracksByIdPtr.asFunction<
+          void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Pointer<pkg_ffi.Utf8>>,
+              ffi.Pointer<ffi.Int>, ffi.Pointer<ffi.Float>, int)>();
+
   void JuceMixPlayer_onStateUpdate(
     ffi.Pointer<ffi.Void> ptr,
     ffi.Pointer<
@@ -296,6 +508,61 @@ class JuceLibGen {
   late final _JuceMixPlayer_seek = _JuceMixPlayer_seekPtr.asFunction<
       void Function(ffi.Pointer<ffi.Void>, double)>();
 
+  /// loops `start` to `end` in seconds while the playhead is before `end`, `end <= start` clears it
+  void JuceMixPlayer_setLoopRegion(
+    ffi.Pointer<ffi.Void> ptr,
+    double start,
+    double end,
+  ) {
+    return _JuceMixPlayer_setLoopRegion(
+      ptr,
+      start,
+      end,
+    );
+  }
+
+  late final _JuceMixPlayer_setLoopRegionPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Void>, ffi.Float,
+              ffi.Float)>>('JuceMixPlayer_setLoopRegion');
+  late final _JuceMixPlayer_setLoopRegion = _JuceMixPlayer_setLoopRegionPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>, double, double)>();
+
+  /// linear gain of the player on the shared output bus
+  void JuceMixPlayer_setBusGain(
+    ffi.Pointer<ffi.Void> ptr,
+    double gain,
+  ) {
+    return _JuceMixPlayer_setBusGain(
+      ptr,
+      gain,
+    );
+  }
+
+  late final _JuceMixPlayer_setBusGainPtr = _lookup<
+          ffi
+          .NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>, ffi.Float)>>(
+      'JuceMixPlayer_setBusGain');
+  late final _JuceMixPlayer_setBusGain = _JuceMixPlayer_setBusGainPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>, double)>();
+
+  /// valid until `JuceMixPlayer_deinit`
+  ffi.Pointer<JuceMixPlayerTransport> JuceMixPlayer_getTransport(
+    ffi.Pointer<ffi.Void> ptr,
+  ) {
+    return _JuceMixPlayer_getTransport(
+      ptr,
+    );
+  }
+
+  late final _JuceMixPlayer_getTransportPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<JuceMixPlayerTransport> Function(
+              ffi.Pointer<ffi.Void>)>>('JuceMixPlayer_getTransport');
+  late final _JuceMixPlayer_getTransport =
+      _JuceMixPlayer_getTransportPtr.asFunction<
+          ffi.Pointer<JuceMixPlayerTransport> Function(ffi.Pointer<ffi.Void>)>();
+
   void JuceMixPlayer_prepareRecorder(
     ffi.Pointer<ffi.Void> ptr,
     ffi.Pointer<pkg_ffi.Utf8> file,
@@ -530,6 +797,196 @@ class JuceLibGen {
       _JuceMixPlayer_getDeviceLatencyInfoPtr.asFunction<
           ffi.Pointer<pkg_ffi.Utf8> Function(ffi.Pointer<ffi.Void>)>();
 
+  /// json of rendered, loading and evicted time ranges
+  ffi.Pointer<pkg_ffi.Utf8> JuceMixPlayer_getBufferedRanges(
+    ffi.Pointer<ffi.Void> ptr,
+  ) {
+    return _JuceMixPlayer_getBufferedRanges(
+      ptr,
+    );
+  }
+
+  late final _JuceMixPlayer_getBufferedRangesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<pkg_ffi.Utf8> Function(
+              ffi.Pointer<ffi.Void>)>>('JuceMixPlayer_getBufferedRanges');
+  late final _JuceMixPlayer_getBufferedRanges =
+      _JuceMixPlayer_getBufferedRangesPtr.asFunction<
+          ffi.Pointer<pkg_ffi.Utf8> Function(ffi.Pointer<ffi.Void>)>();
+
+  int JuceMixPlayer_readLevels(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<ffi.Float> output,
+    int maxFrames,
+  ) {
+    return _JuceMixPlayer_readLevels(
+      ptr,
+      output,
+      maxFrames,
+    );
+  }
+
+  late final _JuceMixPlayer_readLevelsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Float>,
+              ffi.Int)>>('JuceMixPlayer_readLevels');
+  late final _JuceMixPlayer_readLevels =
+      _JuceMixPlayer_readLevelsPtr.asFunction<
+          int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Float>, int)>();
+
+  int JuceMixPlayer_getWaveform(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<pkg_ffi.Utf8> path,
+    double startTime,
+    double endTime,
+    int numPoints,
+    ffi.Pointer<ffi.Float> output,
+  ) {
+    return _JuceMixPlayer_getWaveform(
+      ptr,
+      path,
+      startTime,
+      endTime,
+      numPoints,
+      output,
+    );
+  }
+
+  late final _JuceMixPlayer_getWaveformPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<pkg_ffi.Utf8>,
+              ffi.Float,
+              ffi.Float,
+              ffi.Int,
+              ffi.Pointer<ffi.Float>)>>('JuceMixPlayer_getWaveform');
+  late final _JuceMixPlayer_getWaveform =
+      _JuceMixPlayer_getWaveformPtr.asFunction<
+          int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>,
+              double, double, int, ffi.Pointer<ffi.Float>)>();
+
+  void JuceMixPlayer_onWaveformReady(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<
+            ffi.NativeFunction<
+                ffi.Void Function(
+                    ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>)>>
+        onReady,
+  ) {
+    return _JuceMixPlayer_onWaveformReady(
+      ptr,
+      onReady,
+    );
+  }
+
+  late final _JuceMixPlayer_onWaveformReadyPtr = _lookup<
+          ffi.NativeFunction<
+              ffi.Void Function(
+                  ffi.Pointer<ffi.Void>,
+                  ffi.Pointer<
+                      ffi.NativeFunction<
+                          ffi.Void Function(ffi.Pointer<ffi.Void>,
+                              ffi.Pointer<pkg_ffi.Utf8>)>>)>>(
+      'JuceMixPlayer_onWaveformReady');
+  late final _JuceMixPlayer_onWaveformReady =
+      _JuceMixPlayer_onWaveformReadyPtr.asFunction<
+          void Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<
+                  ffi.NativeFunction<
+                      ffi.Void Function(ffi.Pointer<ffi.Void>,
+                          ffi.Pointer<pkg_ffi.Utf8>)>>)>();
+
+  void JuceMixPlayer_setWaveformCacheDir(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<pkg_ffi.Utf8> path,
+  ) {
+    return _JuceMixPlayer_setWaveformCacheDir(
+      ptr,
+      path,
+    );
+  }
+
+  late final _JuceMixPlayer_setWaveformCacheDirPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Void>,
+              ffi.Pointer<pkg_ffi.Utf8>)>>('JuceMixPlayer_setWaveformCacheDir');
+  late final _JuceMixPlayer_setWaveformCacheDir =
+      _JuceMixPlayer_setWaveformCacheDirPtr.asFunction<
+          void Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>)>();
+
+  int JuceMixPlayer_getLoudness(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<pkg_ffi.Utf8> path,
+    ffi.Pointer<ffi.Float> output,
+  ) {
+    return _JuceMixPlayer_getLoudness(
+      ptr,
+      path,
+      output,
+    );
+  }
+
+  late final _JuceMixPlayer_getLoudnessPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>,
+              ffi.Pointer<ffi.Float>)>>('JuceMixPlayer_getLoudness');
+  late final _JuceMixPlayer_getLoudness =
+      _JuceMixPlayer_getLoudnessPtr.asFunction<
+          int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>,
+              ffi.Pointer<ffi.Float>)>();
+
+  int JuceMixPlayer_getMixLoudness(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<ffi.Float> output,
+  ) {
+    return _JuceMixPlayer_getMixLoudness(
+      ptr,
+      output,
+    );
+  }
+
+  late final _JuceMixPlayer_getMixLoudnessPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Float>)>>('JuceMixPlayer_getMixLoudness');
+  late final _JuceMixPlayer_getMixLoudness =
+      _JuceMixPlayer_getMixLoudnessPtr.asFunction<
+          int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Float>)>();
+
+  void JuceMixPlayer_onLoudnessReady(
+    ffi.Pointer<ffi.Void> ptr,
+    ffi.Pointer<
+            ffi.NativeFunction<
+                ffi.Void Function(
+                    ffi.Pointer<ffi.Void>, ffi.Pointer<pkg_ffi.Utf8>)>>
+        onReady,
+  ) {
+    return _JuceMixPlayer_onLoudnessReady(
+      ptr,
+      onReady,
+    );
+  }
+
+  late final _JuceMixPlayer_onLoudnessReadyPtr = _lookup<
+          ffi.NativeFunction<
+              ffi.Void Function(
+                  ffi.Pointer<ffi.Void>,
+                  ffi.Pointer<
+                      ffi.NativeFunction<
+                          ffi.Void Function(ffi.Pointer<ffi.Void>,
+                              ffi.Pointer<pkg_ffi.Utf8>)>>)>>(
+      'JuceMixPlayer_onLoudnessReady');
+  late final _JuceMixPlayer_onLoudnessReady =
+      _JuceMixPlayer_onLoudnessReadyPtr.asFunction<
+          void Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<
+                  ffi.NativeFunction<
+                      ffi.Void Function(ffi.Pointer<ffi.Void>,
+                          ffi.Pointer<pkg_ffi.Utf8>)>>)>();
+
   void JuceMixPlayer_export(
     ffi.Pointer<ffi.Void> ptr,
     ffi.Pointer<pkg_ffi.Utf8> outputPath,
@@ -575,3 +1032,41 @@ class JuceLibGen {
   late final _JuceMixPlayer_fileExists = _JuceMixPlayer_fileExistsPtr
       .asFunction<int Function(ffi.Pointer<pkg_ffi.Utf8>)>();
 }
+
+/// One 64 byte aligned block per player that the host reads in place, e.g. once per display frame, instead of
+/// progress callbacks (`progressCallbacks` false in the settings turns those off). Fields are updated one by one,
+/// `sequence` changes after every update so unchanged frames can be skipped. Read each field with one aligned load.
+final class JuceMixPlayerTransport extends ffi.Struct {
+  @ffi.Uint32()
+  external int sequence;
+
+  @ffi.Int32()
+  external int state;
+
+  @ffi.Int32()
+  external int recState;
+
+  @ffi.Float()
+  external double sampleRate;
+
+  @ffi.Int64()
+  external int playHead;
+
+  @ffi.Int64()
+  external int duration;
+
+  @ffi.Int64()
+  external int recordedSamples;
+
+  @ffi.Float()
+  external double recordSampleRate;
+
+  @ffi.Float()
+  external double inputLevel;
+
+  @ffi.Float()
+  external double outputLevel;
+
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Uint32> reserved;
+}
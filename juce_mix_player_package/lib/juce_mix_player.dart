@@ -4,6 +4,7 @@ import 'dart:async';
 import 'dart:convert';
 import 'dart:developer';
 import 'dart:ffi';
+import 'dart:typed_data';
 import 'package:ffi/ffi.dart';
 import 'package:flutter/foundation.dart';
 import 'juce_lib_gen.dart';
@@ -41,6 +42,16 @@ class JuceMixPlayer {
   NativeCallable<StringUpdateCallback>? _errorUpdateNativeCallable;
   NativeCallable<StringUpdateCallback>? _deviceUpdateNativeCallable;
   NativeCallable<StringUpdateCallback2>? _exportUpdateNativeCallable;
+  NativeCallable<StringUpdateCallback>? _waveformReadyNativeCallable;
+  NativeCallable<StringUpdateCallback>? _loudnessReadyNativeCallable;
+
+  late final Pointer<JuceMixPlayerTransport> _transport;
+
+  // `getWaveform` calls waiting for the peaks of a path
+  final Map<String, List<Completer<void>>> _waveformWaiters = {};
+
+  // `getLoudness` calls waiting for the measurement of a path
+  final Map<String, List<Completer<void>>> _loudnessWaiters = {};
 
   //Rec
   NativeCallable<FloatCallback>? _recInputlevelCallbackNativeCallable;
@@ -65,6 +76,27 @@ class JuceMixPlayer {
     _juceLib.juce_enableLogs(enable ? 1 : 0);
   }
 
+  /// Players created after this call are summed by one device callback
+  /// instead of registering one each, e.g. for many previews at once.
+  static void setSharedOutputBus(bool enable) {
+    _juceLib.juce_setSharedOutputBus(enable ? 1 : 0);
+  }
+
+  /// Keeps up to [size] disposed players and reuses them for new ones, so
+  /// opening and closing previews doesn't create and tear down threads.
+  static void setPlayerPoolSize(int size) {
+    _juceLib.juce_setPlayerPoolSize(size);
+  }
+
+  // strings from the native side are ours, read once and handed back
+  static String _takeString(Pointer<Utf8> cstring) {
+    try {
+      return cstring.toDartString();
+    } finally {
+      _juceLib.JuceMixPlayer_freeString(cstring);
+    }
+  }
+
   static int fileExists(String path) {
     return _juceLib.JuceMixPlayer_fileExists(path.toNativeUtf8());
   }
@@ -75,6 +107,7 @@ class JuceMixPlayer {
         : DynamicLibrary.open(libname));
 
     _ptr = _juceLib.JuceMixPlayer_init();
+    _transport = _juceLib.JuceMixPlayer_getTransport(_ptr);
   }
 
   void setProgressHandler(void Function(double progress) callback) {
@@ -90,7 +123,7 @@ class JuceMixPlayer {
 
   void setStateUpdateHandler(void Function(JuceMixPlayerState state) callback) {
     NativeStringCallbackDart closure = (ptr, cstring) {
-      callback(JuceMixPlayerState.values.byName(cstring.toDartString()));
+      callback(JuceMixPlayerState.values.byName(_takeString(cstring)));
     };
     _stateUpdateNativeCallable?.close();
     _stateUpdateNativeCallable =
@@ -101,7 +134,7 @@ class JuceMixPlayer {
 
   void setErrorHandler(void Function(String error) callback) {
     NativeStringCallbackDart closure = (ptr, cstring) {
-      callback(cstring.toDartString());
+      callback(_takeString(cstring));
     };
     _errorUpdateNativeCallable?.close();
     _errorUpdateNativeCallable =
@@ -114,7 +147,7 @@ class JuceMixPlayer {
       void Function(MixerDeviceList deviceList) callback) {
     NativeStringCallbackDart closure = (ptr, cstring) {
       MixerDeviceList data =
-          MixerDeviceList.fromJson(json.decode(cstring.toDartString()));
+          MixerDeviceList.fromJson(json.decode(_takeString(cstring)));
       callback(data);
     };
     _deviceUpdateNativeCallable?.close();
@@ -128,8 +161,7 @@ class JuceMixPlayer {
     MixerComposeModel data = MixerComposeModel(tracks: [
       MixerTrack(id: "id_0", path: path),
     ]);
-    final jsonStr = json.encode(data.toJson());
-    _juceLib.JuceMixPlayer_set(_ptr, jsonStr.toNativeUtf8());
+    setMixData(data);
   }
 
   void setMixData(MixerComposeModel data) {
@@ -137,6 +169,74 @@ class JuceMixPlayer {
     _juceLib.JuceMixPlayer_set(_ptr, jsonStr.toNativeUtf8());
   }
 
+  void _withTrackId(String id, void Function(Pointer<Utf8> track) call) {
+    final track = id.toNativeUtf8(allocator: calloc);
+    try {
+      call(track);
+    } finally {
+      calloc.free(track);
+    }
+  }
+
+  /// Track edits for sliders and toggles, without sending the whole
+  /// composition again. [id] is a track of the last [setMixData], an unknown
+  /// one is reported to the error handler.
+  void setTrackVolume(String id, double volume) {
+    _withTrackId(id,
+        (track) => _juceLib.JuceMixPlayer_setTrackVolume(_ptr, track, volume));
+  }
+
+  void setTrackOffset(String id, double offset) {
+    _withTrackId(id,
+        (track) => _juceLib.JuceMixPlayer_setTrackOffset(_ptr, track, offset));
+  }
+
+  void setTrackEnabled(String id, bool enabled) {
+    _withTrackId(
+        id,
+        (track) => _juceLib.JuceMixPlayer_setTrackEnabled(
+            _ptr, track, enabled ? 1 : 0));
+  }
+
+  /// Plays [duration] seconds of the file from [fromTime], 0 plays to its end.
+  void setTrackTrim(String id, double fromTime, double duration) {
+    _withTrackId(
+        id,
+        (track) => _juceLib.JuceMixPlayer_setTrackTrim(
+            _ptr, track, fromTime, duration));
+  }
+
+  void setTrackRepeat(String id, bool repeat, double interval) {
+    _withTrackId(
+        id,
+        (track) => _juceLib.JuceMixPlayer_setTrackRepeat(
+            _ptr, track, repeat ? 1 : 0, interval));
+  }
+
+  /// Applies all [updates] together, e.g. a fade of several tracks. One
+  /// invalid value drops the batch and reports it to the error handler.
+  void updateTracks(List<MixerTrackUpdate> updates) {
+    final tracks = calloc<Pointer<Utf8>>(updates.length);
+    final params = calloc<Int>(updates.length);
+    final values = calloc<Float>(updates.length);
+    try {
+      for (var i = 0; i < updates.length; i++) {
+        tracks[i] = updates[i].id.toNativeUtf8(allocator: calloc);
+        params[i] = updates[i].param.index;
+        values[i] = updates[i].value;
+      }
+      _juceLib.JuceMixPlayer_updateTracksById(
+          _ptr, tracks, params, values, updates.length);
+    } finally {
+      for (var i = 0; i < updates.length; i++) {
+        calloc.free(tracks[i]);
+      }
+      calloc.free(tracks);
+      calloc.free(params);
+      calloc.free(values);
+    }
+  }
+
   void setSettings(MixerSettings settings) {
     final jsonStr = json.encode(settings.toJson());
     _juceLib.JuceMixPlayer_setSettings(_ptr, jsonStr.toNativeUtf8());
@@ -166,6 +266,21 @@ class JuceMixPlayer {
     _juceLib.JuceMixPlayer_seek(_ptr, position);
   }
 
+  /// Loops [start] to [end] in seconds while the playhead is before [end],
+  /// e.g. to practice a section. Changing it doesn't interrupt playback.
+  void setLoopRegion(double start, double end) {
+    _juceLib.JuceMixPlayer_setLoopRegion(_ptr, start, end);
+  }
+
+  void clearLoopRegion() {
+    _juceLib.JuceMixPlayer_setLoopRegion(_ptr, 0, 0);
+  }
+
+  /// Linear gain of this player on the shared output bus, see [setSharedOutputBus].
+  void setBusGain(double gain) {
+    _juceLib.JuceMixPlayer_setBusGain(_ptr, gain);
+  }
+
   void togglePlayPause() {
     if (isPlaying()) {
       pause();
@@ -194,7 +309,7 @@ class JuceMixPlayer {
 
   void setRecErrorHandler(void Function(String error) callback) {
     NativeStringCallbackDart closure = (ptr, cstring) {
-      callback(cstring.toDartString());
+      callback(_takeString(cstring));
     };
     _recErrorUpdateNativeCallable?.close();
     _recErrorUpdateNativeCallable =
@@ -205,7 +320,7 @@ class JuceMixPlayer {
 
   void setRecStateUpdateHandler(void Function(JuceMixRecState state) callback) {
     NativeStringCallbackDart closure = (ptr, cstring) {
-      callback(JuceMixRecState.values.byName(cstring.toDartString()));
+      callback(JuceMixRecState.values.byName(_takeString(cstring)));
     };
     _recStateUpdateNativeCallable?.close();
     _recStateUpdateNativeCallable =
@@ -243,20 +358,156 @@ class JuceMixPlayer {
     - sampleRate -> sample rate per second
   */
   String getDeviceLatencyInfo() {
-    return _juceLib.JuceMixPlayer_getDeviceLatencyInfo(_ptr).toDartString();
+    return _takeString(_juceLib.JuceMixPlayer_getDeviceLatencyInfo(_ptr));
   }
 
   LatencyInfo getDeviceLatencyInfoObject() {
-    var str = _juceLib.JuceMixPlayer_getDeviceLatencyInfo(_ptr).toDartString();
+    var str = _takeString(_juceLib.JuceMixPlayer_getDeviceLatencyInfo(_ptr));
     LatencyInfo info = LatencyInfo.fromJson(json.decode(str));
     return info;
   }
 
+  /// Time ranges of the composition that are rendered, loading or evicted,
+  /// like a video player's buffered ranges.
+  BufferedRanges getBufferedRanges() {
+    var str = _takeString(_juceLib.JuceMixPlayer_getBufferedRanges(_ptr));
+    return BufferedRanges.fromJson(json.decode(str));
+  }
+
+  /// Drains up to [maxFrames] live level frames of the device input and output,
+  /// oldest first, as consecutive [inputMin, inputMax, inputRms, outputMin,
+  /// outputMax, outputRms] values. Poll it from a ticker to draw scrolling
+  /// waveforms, frames cover `MixerSettings.levelFrameDuration` each.
+  Float32List readLevels({int maxFrames = 256}) {
+    final output = calloc<Float>(maxFrames * 6);
+    try {
+      final count = _juceLib.JuceMixPlayer_readLevels(_ptr, output, maxFrames);
+      return Float32List.fromList(output.asTypedList(count * 6));
+    } finally {
+      calloc.free(output);
+    }
+  }
+
+  /// Playhead, state, recording time and levels, read from the player's
+  /// memory without a native call. Poll it from a ticker instead of the
+  /// progress handlers, `MixerSettings.progressCallbacks` false stops those.
+  TransportState readTransport() {
+    final transport = _transport.ref;
+    final sampleRate = transport.sampleRate;
+    final recordSampleRate = transport.recordSampleRate;
+    return TransportState(
+      sequence: transport.sequence,
+      state: JuceMixPlayerState.values[transport.state],
+      recState: JuceMixRecState.values[transport.recState],
+      position: sampleRate > 0 ? transport.playHead / sampleRate : 0,
+      duration: sampleRate > 0 ? transport.duration / sampleRate : 0,
+      recordedTime: recordSampleRate > 0
+          ? transport.recordedSamples / recordSampleRate
+          : 0,
+      inputLevel: transport.inputLevel,
+      outputLevel: transport.outputLevel,
+    );
+  }
+
+  /// Sets the directory for cached waveform peaks, defaults to the temp directory.
+  void setWaveformCacheDir(String path) {
+    _juceLib.JuceMixPlayer_setWaveformCacheDir(_ptr, path.toNativeUtf8());
+  }
+
+  /// Min, max and rms (-1 to 1) of the file at [path] for [numPoints] points
+  /// between [startTime] and [endTime] seconds, as consecutive triplets.
+  /// Completes once the peaks are built, files the player already decoded are fast.
+  /// Returns an empty list when the file can't be read.
+  Future<Float32List> getWaveform(
+      String path, double startTime, double endTime, int numPoints) async {
+    if (_waveformReadyNativeCallable == null) {
+      NativeStringCallbackDart closure = (ptr, cstring) {
+        final waiters = _waveformWaiters.remove(_takeString(cstring));
+        waiters?.forEach((completer) => completer.complete());
+      };
+      _waveformReadyNativeCallable =
+          NativeCallable<StringUpdateCallback>.listener(closure);
+      _juceLib.JuceMixPlayer_onWaveformReady(
+          _ptr, _waveformReadyNativeCallable!.nativeFunction);
+    }
+
+    final output = calloc<Float>(numPoints * 3);
+    final pathPtr = path.toNativeUtf8();
+    try {
+      while (true) {
+        // registered first, the ready callback can't arrive before the await
+        final completer = Completer<void>();
+        _waveformWaiters.putIfAbsent(path, () => []).add(completer);
+        final count = _juceLib.JuceMixPlayer_getWaveform(
+            _ptr, pathPtr, startTime, endTime, numPoints, output);
+        if (count != -1) {
+          _waveformWaiters[path]?.remove(completer);
+          if (count <= 0) {
+            return Float32List(0);
+          }
+          return Float32List.fromList(output.asTypedList(count * 3));
+        }
+        await completer.future;
+      }
+    } finally {
+      calloc.free(output);
+      malloc.free(pathPtr);
+    }
+  }
+
+  /// EBU R128 loudness of the file at [path], measured in the background and
+  /// cached next to the waveform peaks. Files the player already decoded are fast.
+  /// Returns null when the file can't be read.
+  Future<Loudness?> getLoudness(String path) async {
+    if (_loudnessReadyNativeCallable == null) {
+      NativeStringCallbackDart closure = (ptr, cstring) {
+        final waiters = _loudnessWaiters.remove(_takeString(cstring));
+        waiters?.forEach((completer) => completer.complete());
+      };
+      _loudnessReadyNativeCallable =
+          NativeCallable<StringUpdateCallback>.listener(closure);
+      _juceLib.JuceMixPlayer_onLoudnessReady(
+          _ptr, _loudnessReadyNativeCallable!.nativeFunction);
+    }
+
+    final output = calloc<Float>(Loudness._numValues);
+    final pathPtr = path.toNativeUtf8();
+    try {
+      while (true) {
+        // registered first, the ready callback can't arrive before the await
+        final completer = Completer<void>();
+        _loudnessWaiters.putIfAbsent(path, () => []).add(completer);
+        final result =
+            _juceLib.JuceMixPlayer_getLoudness(_ptr, pathPtr, output);
+        if (result != -1) {
+          _loudnessWaiters[path]?.remove(completer);
+          return result == 1 ? Loudness._fromPointer(output) : null;
+        }
+        await completer.future;
+      }
+    } finally {
+      calloc.free(output);
+      malloc.free(pathPtr);
+    }
+  }
+
+  /// Loudness of the last export, null if nothing was exported yet.
+  Loudness? getMixLoudness() {
+    final output = calloc<Float>(Loudness._numValues);
+    try {
+      return _juceLib.JuceMixPlayer_getMixLoudness(_ptr, output) == 1
+          ? Loudness._fromPointer(output)
+          : null;
+    } finally {
+      calloc.free(output);
+    }
+  }
+
   Future<void> export(String outputFile) async {
     final completer = Completer<void>();
 
     NativeStringCallbackDart2 closure = (cstring) {
-      String error = cstring.toDartString();
+      String error = _takeString(cstring);
       if (error.isNotEmpty) {
         completer.completeError(Exception('Export failed: $error'));
       } else {
@@ -274,43 +525,98 @@ class JuceMixPlayer {
   }
 
   void dispose() {
+    // the player drops its callbacks before they are closed
+    _juceLib.JuceMixPlayer_deinit(_ptr);
+
     // Clear callbacks
     _progressCallbackNativeCallable?.close();
     _stateUpdateNativeCallable?.close();
     _errorUpdateNativeCallable?.close();
     _deviceUpdateNativeCallable?.close();
     _exportUpdateNativeCallable?.close();
+    _waveformReadyNativeCallable?.close();
+    _loudnessReadyNativeCallable?.close();
 
     //Rec
     _recInputlevelCallbackNativeCallable?.close();
     _recRrogressCallbackNativeCallable?.close();
     _recStateUpdateNativeCallable?.close();
     _recErrorUpdateNativeCallable?.close();
-
-    _juceLib.JuceMixPlayer_deinit(_ptr);
   }
 }
 
+/// Snapshot of [JuceMixPlayer.readTransport], times in seconds, levels as
+/// linear peaks of the last device callback.
+class TransportState {
+  /// changes whenever the player updated the transport
+  final int sequence;
+  final JuceMixPlayerState state;
+  final JuceMixRecState recState;
+  final double position;
+  final double duration;
+  final double recordedTime;
+  final double inputLevel;
+  final double outputLevel;
+
+  TransportState({
+    required this.sequence,
+    required this.state,
+    required this.recState,
+    required this.position,
+    required this.duration,
+    required this.recordedTime,
+    required this.inputLevel,
+    required this.outputLevel,
+  });
+
+  double get progress => duration > 0 ? (position / duration).clamp(0.0, 1.0) : 0;
+}
+
+/// Track fields of [JuceMixPlayer.updateTracks], in the order of the C API.
+enum MixerTrackParam {
+  volume,
+  offset,
+  fromTime,
+  duration,
+  enabled,
+  repeat,
+  repeatInterval
+}
+
+class MixerTrackUpdate {
+  final String id;
+  final MixerTrackParam param;
+
+  /// seconds for times, 0 or 1 for [MixerTrackParam.enabled] and [MixerTrackParam.repeat]
+  final double value;
+
+  MixerTrackUpdate(this.id, this.param, this.value);
+}
+
 class MixerComposeModel {
   List<MixerTrack>? tracks;
   String? output;
   double? outputDuration;
+  MixerMetronome? metronome;
 
   MixerComposeModel({
     required this.tracks,
     this.output,
     this.outputDuration,
+    this.metronome,
   });
 
   MixerComposeModel copyWith({
     List<MixerTrack>? tracks,
     String? output,
     double? outputDuration,
+    MixerMetronome? metronome,
   }) {
     return MixerComposeModel(
       tracks: tracks ?? this.tracks,
       output: output ?? this.output,
       outputDuration: outputDuration ?? this.outputDuration,
+      metronome: metronome ?? this.metronome,
     );
   }
 
@@ -321,6 +627,9 @@ class MixerComposeModel {
             .toList(),
         output: json['output'],
         outputDuration: json['outputDuration']?.toDouble(),
+        metronome: json['metronome'] != null
+            ? MixerMetronome.fromJson(json['metronome'])
+            : null,
       );
 
   Map<String, dynamic> toJson() {
@@ -329,6 +638,94 @@ class MixerComposeModel {
       json['tracks'] = tracks?.map((e) => e.toJson()).toList();
     if (output != null) json['output'] = output;
     if (outputDuration != null) json['outputDuration'] = outputDuration;
+    if (metronome != null) json['metronome'] = metronome?.toJson();
+    return json;
+  }
+}
+
+/// Click track generated by the player, tempo changes apply without reloading.
+class MixerMetronome {
+  bool? enabled;
+
+  /// quarter notes per minute
+  double? bpm;
+
+  /// time signature, clicks per bar [4]
+  int? beatsPerBar;
+
+  /// time signature, note value of one click [4]
+  int? beatUnit;
+
+  /// per beat of the bar: 0 silent, 1 click, 2 accent, empty accents the first beat
+  List<int>? accents;
+
+  /// delay of the first bar in seconds
+  double? offset;
+  double? volume;
+
+  /// optional audio files, synthesised clicks by default
+  String? clickPath;
+  String? accentPath;
+
+  MixerMetronome({
+    this.enabled = true,
+    this.bpm,
+    this.beatsPerBar,
+    this.beatUnit,
+    this.accents,
+    this.offset,
+    this.volume,
+    this.clickPath,
+    this.accentPath,
+  });
+
+  MixerMetronome copyWith({
+    bool? enabled,
+    double? bpm,
+    int? beatsPerBar,
+    int? beatUnit,
+    List<int>? accents,
+    double? offset,
+    double? volume,
+    String? clickPath,
+    String? accentPath,
+  }) {
+    return MixerMetronome(
+      enabled: enabled ?? this.enabled,
+      bpm: bpm ?? this.bpm,
+      beatsPerBar: beatsPerBar ?? this.beatsPerBar,
+      beatUnit: beatUnit ?? this.beatUnit,
+      accents: accents ?? this.accents,
+      offset: offset ?? this.offset,
+      volume: volume ?? this.volume,
+      clickPath: clickPath ?? this.clickPath,
+      accentPath: accentPath ?? this.accentPath,
+    );
+  }
+
+  factory MixerMetronome.fromJson(Map<String, dynamic> json) => MixerMetronome(
+        enabled: json['enabled'],
+        bpm: json['bpm']?.toDouble(),
+        beatsPerBar: json['beatsPerBar'],
+        beatUnit: json['beatUnit'],
+        accents: (json['accents'] as List<dynamic>?)?.cast<int>(),
+        offset: json['offset']?.toDouble(),
+        volume: json['volume']?.toDouble(),
+        clickPath: json['clickPath'],
+        accentPath: json['accentPath'],
+      );
+
+  Map<String, dynamic> toJson() {
+    final json = <String, dynamic>{};
+    if (enabled != null) json['enabled'] = enabled;
+    if (bpm != null) json['bpm'] = bpm;
+    if (beatsPerBar != null) json['beatsPerBar'] = beatsPerBar;
+    if (beatUnit != null) json['beatUnit'] = beatUnit;
+    if (accents != null) json['accents'] = accents;
+    if (offset != null) json['offset'] = offset;
+    if (volume != null) json['volume'] = volume;
+    if (clickPath != null) json['clickPath'] = clickPath;
+    if (accentPath != null) json['accentPath'] = accentPath;
     return json;
   }
 }
@@ -489,6 +886,9 @@ class MixerSettings {
   /// in seconds [0.05]
   double progressUpdateInterval;
 
+  /// progress, recording time and level callbacks, off when the transport is polled [true]
+  bool progressCallbacks;
+
   /// in Hz [48000]
   int sampleRate;
 
@@ -507,36 +907,100 @@ class MixerSettings {
   /// disallow bluetooth mic [false]
   bool dissallowBluetoothMic;
 
+  /// in seconds, upper limit for rendering ahead of the playhead [30]
+  double maxLookAhead;
+
+  /// in seconds, rendered audio kept in memory [120]
+  double maxBufferedDuration;
+
+  /// in seconds, rendered before READY [0.5]
+  double startMargin;
+
+  /// renders the rest of the composition in the background when idle [true]
+  bool backgroundFill;
+
+  /// in seconds, duration of one live level frame, 0 disables [0.01]
+  double levelFrameDuration;
+
+  /// scales tracks to `loudnessTarget` once their loudness is measured [false]
+  bool loudnessMatch;
+
+  /// in LUFS, integrated loudness tracks are matched to [-16]
+  double loudnessTarget;
+
+  /// when the device rate differs: 0 linear, 1 sinc 16 taps, 2 sinc 32 taps [1]
+  int resamplerQuality;
+
+  /// keeps rendered audio as 16 bit, half the memory, clips beyond 0 dBFS [false]
+  bool compactBuffer;
+
+  /// in MB, evicted audio kept losslessly compressed and restored without mixing again, 0 disables [0].
+  /// Only with [compactBuffer], float audio is mixed again.
+  double compressedCacheSize;
+
   MixerSettings({
     this.progressUpdateInterval = 0.05,
+    this.progressCallbacks = true,
     this.sampleRate = 48000,
     this.stopRecOnPlaybackComplete = true,
     this.loop = false,
     this.recBgPlayback = true,
     this.enableMicMonitoring = false,
     this.dissallowBluetoothMic = false,
+    this.maxLookAhead = 30,
+    this.maxBufferedDuration = 120,
+    this.startMargin = 0.5,
+    this.backgroundFill = true,
+    this.levelFrameDuration = 0.01,
+    this.loudnessMatch = false,
+    this.loudnessTarget = -16,
+    this.resamplerQuality = 1,
+    this.compactBuffer = false,
+    this.compressedCacheSize = 0,
   });
 
   factory MixerSettings.fromJson(Map<String, dynamic> json) => MixerSettings(
         progressUpdateInterval:
             json['progressUpdateInterval']?.toDouble() ?? 0.05,
+        progressCallbacks: json['progressCallbacks'] ?? true,
         sampleRate: json['sampleRate'] ?? 48000,
         stopRecOnPlaybackComplete: json['stopRecOnPlaybackComplete'] ?? true,
         loop: json['loop'] ?? true,
         recBgPlayback: json['recBgPlayback'] ?? true,
         enableMicMonitoring: json['enableMicMonitoring'] ?? false,
         dissallowBluetoothMic: json['dissallowBluetoothMic'] ?? false,
+        maxLookAhead: json['maxLookAhead']?.toDouble() ?? 30,
+        maxBufferedDuration: json['maxBufferedDuration']?.toDouble() ?? 120,
+        startMargin: json['startMargin']?.toDouble() ?? 0.5,
+        backgroundFill: json['backgroundFill'] ?? true,
+        levelFrameDuration: json['levelFrameDuration']?.toDouble() ?? 0.01,
+        loudnessMatch: json['loudnessMatch'] ?? false,
+        loudnessTarget: json['loudnessTarget']?.toDouble() ?? -16,
+        resamplerQuality: json['resamplerQuality'] ?? 1,
+        compactBuffer: json['compactBuffer'] ?? false,
+        compressedCacheSize: json['compressedCacheSize']?.toDouble() ?? 0,
       );
 
   Map<String, dynamic> toJson() {
     final json = <String, dynamic>{};
     json['progressUpdateInterval'] = progressUpdateInterval;
+    json['progressCallbacks'] = progressCallbacks;
     json['sampleRate'] = sampleRate;
     json['stopRecOnPlaybackComplete'] = stopRecOnPlaybackComplete;
     json['loop'] = loop;
     json['recBgPlayback'] = recBgPlayback;
     json['enableMicMonitoring'] = enableMicMonitoring;
     json['dissallowBluetoothMic'] = dissallowBluetoothMic;
+    json['maxLookAhead'] = maxLookAhead;
+    json['maxBufferedDuration'] = maxBufferedDuration;
+    json['startMargin'] = startMargin;
+    json['backgroundFill'] = backgroundFill;
+    json['levelFrameDuration'] = levelFrameDuration;
+    json['loudnessMatch'] = loudnessMatch;
+    json['loudnessTarget'] = loudnessTarget;
+    json['resamplerQuality'] = resamplerQuality;
+    json['compactBuffer'] = compactBuffer;
+    json['compressedCacheSize'] = compressedCacheSize;
     return json;
   }
 }
@@ -576,3 +1040,79 @@ class LatencyInfo {
         sampleRate: json['sampleRate'],
       );
 }
+
+enum BufferState { RENDERED, LOADING, EVICTED }
+
+class BufferedRange {
+  /// in seconds
+  double start;
+  double end;
+  BufferState state;
+
+  BufferedRange({
+    required this.start,
+    required this.end,
+    required this.state,
+  });
+
+  factory BufferedRange.fromJson(Map<String, dynamic> json) => BufferedRange(
+        start: json['start']?.toDouble() ?? 0,
+        end: json['end']?.toDouble() ?? 0,
+        state: BufferState.values.byName(json['state']),
+      );
+}
+
+class Loudness {
+  static const _numValues = 5;
+
+  /// in LUFS, gated over the whole file
+  double integrated;
+
+  /// in LUFS, loudest 400ms window
+  double maxMomentary;
+
+  /// in LUFS, loudest 3s window
+  double maxShortTerm;
+
+  /// in LU
+  double loudnessRange;
+
+  /// in dBTP
+  double truePeak;
+
+  Loudness({
+    required this.integrated,
+    required this.maxMomentary,
+    required this.maxShortTerm,
+    required this.loudnessRange,
+    required this.truePeak,
+  });
+
+  factory Loudness._fromPointer(Pointer<Float> values) => Loudness(
+        integrated: values[0],
+        maxMomentary: values[1],
+        maxShortTerm: values[2],
+        loudnessRange: values[3],
+        truePeak: values[4],
+      );
+}
+
+class BufferedRanges {
+  /// in seconds
+  double duration;
+
+  /// ordered by start, time not listed is not buffered
+  List<BufferedRange> ranges;
+
+  BufferedRanges({
+    required this.duration,
+    required this.ranges,
+  });
+
+  factory BufferedRanges.fromJson(Map<String, dynamic> json) => BufferedRanges(
+        duration: json['duration']?.toDouble() ?? 0,
+        ranges: (json['ranges'] as List? ?? [])
+            .map((e) => BufferedRange.fromJson(e))
+            .toList(),
+      );
+}
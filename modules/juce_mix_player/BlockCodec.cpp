@@ -0,0 +1,330 @@
+#include "BlockCodec.h"
+
+#if defined (_MSC_VER)
+ #include <intrin.h>
+#endif
+
+namespace {
+
+// residuals per Rice parameter
+constexpr int blockPartitionSize = 256;
+constexpr int blockMaxOrder = 3;
+// unary lengths from this on are an escape followed by the raw 32 bit value
+constexpr int blockEscape = 32;
+// Rice parameter of a partition without residuals, e.g. silence or a constant
+constexpr int blockZeroPartition = 31;
+// zigzagged warm-up samples, side samples take 17 bits
+constexpr int blockWarmUpBits = 18;
+constexpr size_t blockHeaderSize = 6;
+
+inline juce::uint32 blockZigzag(juce::int32 value) {
+    return ((juce::uint32)value << 1) ^ (juce::uint32)(value >> 31);
+}
+
+inline juce::int32 blockUnzigzag(juce::uint32 value) {
+    return (juce::int32)(value >> 1) ^ -(juce::int32)(value & 1);
+}
+
+/// fixed polynomial prediction of `x[i]` from the `order` samples before it
+inline juce::int32 blockPrediction(const juce::int32* x, int i, int order) {
+    switch (order) {
+        case 0: return 0;
+        case 1: return x[i - 1];
+        case 2: return 2 * x[i - 1] - x[i - 2];
+        default: return 3 * x[i - 1] - 3 * x[i - 2] + x[i - 3];
+    }
+}
+
+/// predictor order with the smallest residuals, `cost` is their absolute sum
+int blockChooseOrder(const juce::int32* x, int numSamples, juce::int64& cost) {
+    juce::int64 sums[blockMaxOrder + 1] = {};
+    for (int i=blockMaxOrder; i<numSamples; i++) {
+        for (int order=0; order<=blockMaxOrder; order++) {
+            sums[order] += std::abs(x[i] - blockPrediction(x, i, order));
+        }
+    }
+    int best = 0;
+    for (int order=1; order<=blockMaxOrder; order++) {
+        if (sums[order] < sums[best]) {
+            best = order;
+        }
+    }
+    cost = sums[best];
+    return best;
+}
+
+/// Rice parameter with the fewest bits for `numValues` zigzagged residuals summing to `sum`
+int blockChooseRiceParameter(const juce::uint32* values, int numValues, juce::uint64 sum) {
+    int estimate = 0;
+    while (estimate < 30 && ((juce::uint64)numValues << (estimate + 1)) <= sum) {
+        estimate++;
+    }
+    int best = estimate;
+    juce::uint64 bestBits = std::numeric_limits<juce::uint64>::max();
+    for (int k = std::max(0, estimate - 1); k <= std::min(blockZeroPartition - 1, estimate + 1); k++) {
+        juce::uint64 bits = (juce::uint64)numValues * (juce::uint64)(k + 1);
+        for (int i=0; i<numValues; i++) {
+            const juce::uint32 q = values[i] >> k;
+            bits += q < (juce::uint32)blockEscape ? q : (juce::uint64)(blockEscape + 32 - k - 1);
+        }
+        if (bits < bestBits) {
+            bestBits = bits;
+            best = k;
+        }
+    }
+    return best;
+}
+
+inline int blockCountLeadingZeros(juce::uint64 value) {
+#if defined (_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - (int)index;
+#else
+    return __builtin_clzll(value);
+#endif
+}
+
+/// most significant bit first
+class BlockBitWriter {
+public:
+
+    explicit BlockBitWriter(std::vector<juce::uint8>& output) : output(output) {}
+
+    /// the low `numBits` (up to 32) of `value`
+    void write(juce::uint32 value, int numBits) {
+        if (numBits == 0) {
+            return;
+        }
+        const juce::uint64 mask = ((juce::uint64)1 << numBits) - 1;
+        buffer = (buffer << numBits) | (value & mask);
+        count += numBits;
+        while (count >= 8) {
+            count -= 8;
+            output.push_back((juce::uint8)(buffer >> count));
+        }
+    }
+
+    void flush() {
+        if (count > 0) {
+            output.push_back((juce::uint8)(buffer << (8 - count)));
+            count = 0;
+        }
+    }
+
+private:
+
+    std::vector<juce::uint8>& output;
+    juce::uint64 buffer = 0;
+    int count = 0;
+};
+
+class BlockBitReader {
+public:
+
+    BlockBitReader(const juce::uint8* data, size_t size) : data(data), size(size) {}
+
+    /// up to 32 bits
+    juce::uint32 read(int numBits) {
+        if (numBits == 0) {
+            return 0;
+        }
+        refill();
+        const juce::uint32 value = (juce::uint32)(buffer >> (64 - numBits));
+        skip(numBits);
+        return value;
+    }
+
+    /// zero bits up to the next one bit, which is consumed too, or `limit` zero bits
+    int readUnary(int limit) {
+        refill();
+        const int zeros = buffer == 0 ? 64 : blockCountLeadingZeros(buffer);
+        if (zeros >= limit) {
+            skip(limit);
+            return limit;
+        }
+        skip(zeros + 1);
+        return zeros;
+    }
+
+    /// false when more was read than there is
+    bool isValid() const {
+        return consumed <= (juce::uint64)size * 8;
+    }
+
+private:
+
+    const juce::uint8* data;
+    size_t size;
+    size_t position = 0;
+    // next bits from the most significant one
+    juce::uint64 buffer = 0;
+    int count = 0;
+    juce::uint64 consumed = 0;
+
+    void refill() {
+        while (count <= 56) {
+            const juce::uint64 byte = position < size ? data[position] : 0;
+            buffer |= byte << (56 - count);
+            position++;
+            count += 8;
+        }
+    }
+
+    void skip(int numBits) {
+        buffer <<= numBits;
+        count -= numBits;
+        consumed += (juce::uint64)numBits;
+    }
+};
+
+}
+
+std::vector<juce::uint8> BlockCodec::encode(const juce::int16* samples, int numChannels, int numSamples) {
+    numChannels = juce::jlimit(1, 2, numChannels);
+    numSamples = std::max(0, numSamples);
+
+    std::vector<juce::int32> channels((size_t)numChannels * (size_t)numSamples);
+    for (size_t i=0; i<channels.size(); i++) {
+        channels[i] = samples[i];
+    }
+    int orders[2] = {};
+    juce::int64 costs[2] = {};
+    for (int ch=0; ch<numChannels; ch++) {
+        orders[ch] = blockChooseOrder(channels.data() + ch * numSamples, numSamples, costs[ch]);
+    }
+
+    bool midSide = false;
+    if (numChannels == 2) {
+        // like FLAC, the dropped bit of the mid is the lowest bit of the side
+        std::vector<juce::int32> midSideChannels(channels.size());
+        for (int i=0; i<numSamples; i++) {
+            const juce::int32 left = channels[(size_t)i];
+            const juce::int32 right = channels[(size_t)(numSamples + i)];
+            midSideChannels[(size_t)i] = (left + right) >> 1;
+            midSideChannels[(size_t)(numSamples + i)] = left - right;
+        }
+        int midSideOrders[2] = {};
+        juce::int64 midSideCosts[2] = {};
+        for (int ch=0; ch<2; ch++) {
+            midSideOrders[ch] = blockChooseOrder(midSideChannels.data() + ch * numSamples, numSamples, midSideCosts[ch]);
+        }
+        if (midSideCosts[0] + midSideCosts[1] < costs[0] + costs[1]) {
+            midSide = true;
+            channels.swap(midSideChannels);
+            orders[0] = midSideOrders[0];
+            orders[1] = midSideOrders[1];
+        }
+    }
+
+    std::vector<juce::uint8> data;
+    data.reserve(blockHeaderSize + channels.size());
+    data.push_back((juce::uint8)numChannels);
+    data.push_back(midSide ? 1 : 0);
+    for (int shift=0; shift<32; shift+=8) {
+        data.push_back((juce::uint8)((juce::uint32)numSamples >> shift));
+    }
+
+    BlockBitWriter writer(data);
+    juce::uint32 residuals[blockPartitionSize];
+    for (int ch=0; ch<numChannels; ch++) {
+        const juce::int32* x = channels.data() + ch * numSamples;
+        const int order = std::min(orders[ch], numSamples);
+        writer.write((juce::uint32)order, 2);
+        for (int i=0; i<order; i++) {
+            writer.write(blockZigzag(x[i]), blockWarmUpBits);
+        }
+        // partitions are aligned to the channel start, the first one is shorter by the warm-up
+        for (int start = order; start < numSamples;) {
+            const int end = std::min(numSamples, (start / blockPartitionSize + 1) * blockPartitionSize);
+            juce::uint64 sum = 0;
+            for (int i=start; i<end; i++) {
+                residuals[i - start] = blockZigzag(x[i] - blockPrediction(x, i, order));
+                sum += residuals[i - start];
+            }
+            if (sum == 0) {
+                writer.write((juce::uint32)blockZeroPartition, 5);
+                start = end;
+                continue;
+            }
+            const int k = blockChooseRiceParameter(residuals, end - start, sum);
+            writer.write((juce::uint32)k, 5);
+            const juce::uint32 mask = (juce::uint32)(((juce::uint64)1 << k) - 1);
+            for (int i=0; i<end - start; i++) {
+                const juce::uint32 q = residuals[i] >> k;
+                if (q >= (juce::uint32)blockEscape) {
+                    writer.write(0, blockEscape);
+                    writer.write(residuals[i], 32);
+                } else {
+                    // `q` zeros and a one
+                    writer.write(1, (int)q + 1);
+                    writer.write(residuals[i] & mask, k);
+                }
+            }
+            start = end;
+        }
+    }
+    writer.flush();
+    return data;
+}
+
+bool BlockCodec::decode(const std::vector<juce::uint8>& data, juce::int16* samples, int numChannels, int numSamples) {
+    if (data.size() < blockHeaderSize || numChannels < 1 || numChannels > 2 || data[0] != numChannels) {
+        return false;
+    }
+    const bool midSide = data[1] == 1;
+    juce::uint32 storedSamples = 0;
+    for (int i=0; i<4; i++) {
+        storedSamples |= (juce::uint32)data[(size_t)(2 + i)] << (8 * i);
+    }
+    if (numSamples < 0 || storedSamples != (juce::uint32)numSamples) {
+        return false;
+    }
+
+    std::vector<juce::int32> channels((size_t)numChannels * (size_t)numSamples);
+    BlockBitReader reader(data.data() + blockHeaderSize, data.size() - blockHeaderSize);
+    for (int ch=0; ch<numChannels; ch++) {
+        juce::int32* x = channels.data() + ch * numSamples;
+        const int order = (int)reader.read(2);
+        if (order > numSamples) {
+            return false;
+        }
+        for (int i=0; i<order; i++) {
+            x[i] = blockUnzigzag(reader.read(blockWarmUpBits));
+        }
+        for (int start = order; start < numSamples;) {
+            const int end = std::min(numSamples, (start / blockPartitionSize + 1) * blockPartitionSize);
+            const int k = (int)reader.read(5);
+            if (k == blockZeroPartition) {
+                for (int i=start; i<end; i++) {
+                    x[i] = blockPrediction(x, i, order);
+                }
+                start = end;
+                continue;
+            }
+            for (int i=start; i<end; i++) {
+                const int q = reader.readUnary(blockEscape);
+                const juce::uint32 value = q == blockEscape ? reader.read(32) : ((juce::uint32)q << k) | reader.read(k);
+                x[i] = blockUnzigzag(value) + blockPrediction(x, i, order);
+            }
+            start = end;
+        }
+        if (!reader.isValid()) {
+            return false;
+        }
+    }
+
+    if (midSide) {
+        juce::int32* mid = channels.data();
+        juce::int32* side = channels.data() + numSamples;
+        for (int i=0; i<numSamples; i++) {
+            const juce::int32 sum = mid[i] * 2 + (side[i] & 1);
+            mid[i] = (sum + side[i]) >> 1;
+            side[i] = (sum - side[i]) >> 1;
+        }
+    }
+    for (size_t i=0; i<channels.size(); i++) {
+        samples[i] = (juce::int16)juce::jlimit(-32768, 32767, channels[i]);
+    }
+    return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/// Lossless codec for 16 bit pages in the spirit of FLAC's fixed predictors. Per channel the best of the
+/// polynomial predictors of order 0 to 3 is chosen, stereo is coded as mid and side when that's smaller,
+/// and the residuals are Rice coded in partitions with their own parameter. Mixed music typically takes half
+/// of its 16 bit size, silence next to nothing. Decoding is a few ns per sample, hundreds of times real time.
+class BlockCodec {
+public:
+
+    /// `numChannels` (1 or 2) runs of `numSamples`, one after the other
+    static std::vector<juce::uint8> encode(const juce::int16* samples, int numChannels, int numSamples);
+
+    /// Writes `numChannels` runs of `numSamples` to `samples`, false when `data` isn't a block of that size.
+    static bool decode(const std::vector<juce::uint8>& data, juce::int16* samples, int numChannels, int numSamples);
+};
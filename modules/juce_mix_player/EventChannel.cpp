@@ -0,0 +1,176 @@
+#include "EventChannel.h"
+
+EventChannel::Dispatcher EventChannel::dispatcher;
+
+EventChannel::~EventChannel() {
+    close();
+}
+
+void EventChannel::open() {
+    std::lock_guard<std::mutex> guard(dispatchMutex);
+    if (std::find(channels.begin(), channels.end(), this) == channels.end()) {
+        channels.push_back(this);
+    }
+    dispatcher.start();
+    // delivers what was posted before
+    signalled = true;
+    dispatchCondition.notify_one();
+}
+
+void EventChannel::close() {
+    {
+        std::lock_guard<std::mutex> guard(dispatchMutex);
+        auto it = std::find(channels.begin(), channels.end(), this);
+        if (it == channels.end()) {
+            return;
+        }
+        channels.erase(it);
+    }
+    // waits for a delivery by the dispatcher, which can't start another one now
+    std::lock_guard<std::recursive_mutex> delivery(deliveryMutex);
+    _deliver();
+}
+
+void EventChannel::flush() {
+    std::lock_guard<std::recursive_mutex> delivery(deliveryMutex);
+    _deliver();
+}
+
+void EventChannel::discard() {
+    std::lock_guard<std::recursive_mutex> delivery(deliveryMutex);
+    {
+        std::lock_guard<std::mutex> guard(messagesMutex);
+        messages.clear();
+    }
+    for (auto& slot: slots) {
+        slot = 0;
+    }
+    pendingValues = 0;
+}
+
+void EventChannel::post(const Event& event) {
+    slots[(size_t)_getSlot(event.type, event.index)] = ((juce::uint64)_nextSequence() << 32) | (juce::uint32)event.value;
+    _signal();
+}
+
+void EventChannel::postMessage(Type type, const std::string& text) {
+    {
+        std::lock_guard<std::mutex> guard(messagesMutex);
+        Event event;
+        event.type = type;
+        event.text = text;
+        messages.emplace_back(_nextSequence(), std::move(event));
+    }
+    _signal();
+}
+
+void EventChannel::setLatest(Value value, float amount) {
+    latest[(size_t)value] = amount;
+    pendingValues.fetch_or(1u << (int)value);
+    _signal();
+}
+
+int EventChannel::_getSlot(Type type, int index) {
+    switch (type) {
+        case Type::ENDED: return 0;
+        case Type::RECORD_BUFFER: return 1 + juce::jlimit(0, 1, index);
+        case Type::PREFETCH: return 3;
+        case Type::WAVEFORM_READY:
+        case Type::LOUDNESS_READY:
+            break;
+    }
+    jassertfalse;
+    return 0;
+}
+
+juce::uint32 EventChannel::_nextSequence() {
+    juce::uint32 next = ++sequence;
+    if (next == 0) {
+        next = ++sequence;
+    }
+    return next;
+}
+
+void EventChannel::_deliver() {
+    static constexpr std::array<Type, numSlots> slotTypes { Type::ENDED, Type::RECORD_BUFFER, Type::RECORD_BUFFER, Type::PREFETCH };
+    static constexpr std::array<juce::int32, numSlots> slotIndices { 0, 0, 1, 0 };
+
+    // taken all at once, then in posting order
+    std::vector<std::pair<juce::uint32, Event>> pending;
+    {
+        std::lock_guard<std::mutex> guard(messagesMutex);
+        pending.swap(messages);
+    }
+    for (int i=0; i<numSlots; i++) {
+        const juce::uint64 slot = slots[(size_t)i].exchange(0);
+        if (slot != 0) {
+            pending.emplace_back((juce::uint32)(slot >> 32), Event { slotTypes[(size_t)i], (juce::int32)(juce::uint32)slot, slotIndices[(size_t)i], {} });
+        }
+    }
+    // the sequence wraps, compared by distance
+    std::stable_sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+        return (juce::int32)(a.first - b.first) < 0;
+    });
+    for (const auto& event: pending) {
+        if (onEvent) onEvent(event.second);
+    }
+
+    const juce::uint32 pendingMask = pendingValues.exchange(0);
+    for (int i=0; i<numValues; i++) {
+        if ((pendingMask & (1u << i)) != 0 && onValue) {
+            onValue((Value)i, latest[(size_t)i]);
+        }
+    }
+}
+
+void EventChannel::_signal() {
+    // without the mutex, a wakeup lost while the dispatcher was busy is picked up by its timeout
+    signalled = true;
+    dispatchCondition.notify_one();
+}
+
+EventChannel::Dispatcher::~Dispatcher() {
+    {
+        std::lock_guard<std::mutex> guard(dispatchMutex);
+        stop = true;
+    }
+    dispatchCondition.notify_one();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void EventChannel::Dispatcher::start() {
+    if (!thread.joinable() && !stop) {
+        thread = std::thread([this] { run(); });
+    }
+}
+
+void EventChannel::Dispatcher::run() {
+    std::unique_lock<std::mutex> lock(dispatchMutex);
+    while (!stop) {
+        if (channels.empty()) {
+            // no wakeups while no player is open
+            dispatchCondition.wait(lock, [this] { return stop || !channels.empty(); });
+            continue;
+        }
+        signalled = false;
+        const std::vector<EventChannel*> snapshot = channels;
+        for (EventChannel* channel: snapshot) {
+            // closed by a handler meanwhile
+            if (stop || std::find(channels.begin(), channels.end(), channel) == channels.end()) {
+                continue;
+            }
+            // taken while `channels` is locked so `close` waits for it, a flush in progress delivers instead
+            std::unique_lock<std::recursive_mutex> delivery(channel->deliveryMutex, std::try_to_lock);
+            if (!delivery.owns_lock()) {
+                continue;
+            }
+            lock.unlock();
+            channel->_deliver();
+            delivery.unlock();
+            lock.lock();
+        }
+        dispatchCondition.wait_for(lock, std::chrono::milliseconds(dispatchInterval), [this] { return stop || signalled; });
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+
+/// Notifications out of the audio callback. `post` stores an event in its own slot and `setLatest` stores a value,
+/// neither allocates, locks, blocks or calls into the host. Both wake the dispatcher with a condition variable notify,
+/// which can be a syscall (a futex wake on Linux and Android) when the dispatcher waits. One dispatcher thread shared
+/// by all open channels calls the handlers, events in posting order and only the latest of each value however often
+/// it was set. Other threads post messages with a path, e.g. a finished waveform, delivered in order with them.
+class EventChannel {
+public:
+
+    enum class Type {
+        // playback reached the end, `value` is the `JuceMixPlayerState` to report
+        ENDED,
+        // a record buffer is full, `value` samples of buffer `index`, 0 or 1
+        RECORD_BUFFER,
+        // the look-ahead needs loading
+        PREFETCH,
+        // `postMessage` only, the peaks of the file at `text` are ready
+        WAVEFORM_READY,
+        // `postMessage` only, the loudness of the file at `text` is measured
+        LOUDNESS_READY
+    };
+
+    struct Event {
+        Type type = Type::ENDED;
+        juce::int32 value = 0;
+        juce::int32 index = 0;
+        // `postMessage` only, empty from the audio callback so it doesn't allocate
+        std::string text;
+    };
+
+    enum class Value {
+        PROGRESS,
+        REC_PROGRESS,
+        REC_LEVEL
+    };
+
+    static constexpr int numValues = 3;
+
+    ~EventChannel();
+
+    /// Dispatcher thread, or the thread calling `flush` or `close`. They may open, close or flush channels.
+    std::function<void(const Event&)> onEvent;
+    std::function<void(Value, float)> onValue;
+
+    /// Registers with the dispatcher, set the handlers first.
+    void open();
+
+    /// Delivers what is pending one last time and unregisters, no handler runs after it returns
+    /// unless it is called from one.
+    void close();
+
+    /// Delivers what is pending on the calling thread, e.g. before work that must follow the posted events.
+    void flush();
+
+    /// Drops what is pending, waits for a delivery in progress. Not from a handler.
+    void discard();
+
+    /// One producer at a time, the audio callback. Each type and index has one slot, an event posted again before
+    /// it was delivered replaces the undelivered one: an ENDED, or a RECORD_BUFFER of the same index filled twice,
+    /// is delivered once with the latest value.
+    void post(const Event& event);
+
+    /// any thread but the audio callback, locks and allocates. Each message is delivered.
+    void postMessage(Type type, const std::string& text);
+
+    /// any thread, replaces a value not delivered yet
+    void setLatest(Value value, float amount);
+
+private:
+
+    // ENDED, RECORD_BUFFER 0 and 1, PREFETCH
+    static constexpr int numSlots = 4;
+
+    // per slot the posting sequence in the high half and the value in the low half, 0 when empty
+    std::array<std::atomic<juce::uint64>, numSlots> slots {};
+    // orders the slots and messages, never 0
+    std::atomic<juce::uint32> sequence { 0 };
+
+    std::mutex messagesMutex;
+    // by sequence
+    std::vector<std::pair<juce::uint32, Event>> messages;
+
+    std::array<std::atomic<float>, numValues> latest {};
+    // bit per `Value` set since the last delivery
+    std::atomic<juce::uint32> pendingValues { 0 };
+
+    // held while the handlers run, recursive so they can flush or close their own channel
+    std::recursive_mutex deliveryMutex;
+
+    static int _getSlot(Type type, int index);
+
+    juce::uint32 _nextSequence();
+
+    /// `deliveryMutex` held, `dispatchMutex` not
+    void _deliver();
+
+    /// wakes the dispatcher, doesn't lock or block but the notify may be a syscall
+    static void _signal();
+
+    // the dispatcher looks again after this long in case a wakeup came while it was busy
+    static constexpr int dispatchInterval = 250; // ms
+
+    // guards `channels`, never held while handlers run
+    inline static std::mutex dispatchMutex;
+    inline static std::condition_variable dispatchCondition;
+    inline static std::vector<EventChannel*> channels;
+    // something was posted since the dispatcher last looked
+    inline static std::atomic<bool> signalled { false };
+
+    /// the thread, stopped and joined at exit
+    class Dispatcher {
+    public:
+        ~Dispatcher();
+
+        /// `dispatchMutex` held
+        void start();
+
+    private:
+        std::thread thread;
+        bool stop = false;
+
+        void run();
+    };
+
+    static Dispatcher dispatcher;
+};
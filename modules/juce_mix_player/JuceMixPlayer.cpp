@@ -47,22 +47,59 @@ std::string JuceMixPlayerState_toString(JuceMixPlayerState state) {
     return j;
 }
 
-JuceMixPlayer::JuceMixPlayer() {
+JuceMixPlayer::JuceMixPlayer(bool attachToAudioDevice): attachToAudioDevice(attachToAudioDevice) {
     PRINT("JuceMixPlayer()");
 
     taskQueue.name = "taskQueue";
     heavyTaskQueue.name = "heavyTaskQueue";
     recWriteTaskQueue.name = "recWriteTaskQueue";
+    compressTaskQueue.name = "compressTaskQueue";
 
     formatManager.registerBasicFormats();
 
+    synthesizedClick = OneShotSampler::synthesizeClick(sampleRate, 1000, 0.5f);
+    synthesizedAccent = OneShotSampler::synthesizeClick(sampleRate, 1500, 0.8f);
+
+    waveforms.createReader = [this](const juce::File& file) {
+        return _createFileReader(file);
+    };
+    // the workers post, the host is called from the dispatcher like for the other notifications
+    waveforms.onReady = [this](const std::string& path) {
+        events.postMessage(EventChannel::Type::WAVEFORM_READY, path);
+    };
+    loudness.createReader = waveforms.createReader;
+    loudness.onReady = [this](const std::string& path) {
+        events.postMessage(EventChannel::Type::LOUDNESS_READY, path);
+    };
+
+    events.onEvent = [this](const EventChannel::Event& event) {
+        _onEvent(event);
+    };
+    events.onValue = [this](EventChannel::Value value, float amount) {
+        _onEventValue(value, amount);
+    };
+    events.open();
+
     juce::WindowedSincInterpolator interpolator;
 
+    if (!attachToAudioDevice) {
+        return;
+    }
+
     juce::MessageManager::getInstanceWithoutCreating()->callAsync([&, this]{
         if (deviceManager == nullptr) {
             deviceManager = new juce::AudioDeviceManager();
         }
-        deviceManager->addAudioCallback(this);
+        if (useSharedBus) {
+            if (sharedBus == nullptr) {
+                sharedBus = new MixBus();
+            }
+            sharedBus->attach(*deviceManager);
+            onSharedBus = sharedBus->add(this);
+        }
+        if (!onSharedBus) {
+            deviceManager->addAudioCallback(this);
+        }
         deviceManager->addChangeListener(this);
         deviceManager->initialise(0, 2, nullptr, true, {}, nullptr);
 
@@ -75,31 +112,220 @@ JuceMixPlayer::JuceMixPlayer() {
 }
 
 void JuceMixPlayer::dispose() {
+    if (!attachToAudioDevice) {
+        delete this;
+        return;
+    }
+    // the caller may free them right after this returns
+    _clearCallbacks();
     juce::MessageManager::getInstanceWithoutCreating()->callAsync([&]{
         PRINT("JuceMixPlayer::dispose");
-        _stopProgressTimer();
-        deviceManager->removeAudioCallback(this);
+        stopTimer();
+        if (onSharedBus) {
+            sharedBus->remove(this);
+        } else {
+            deviceManager->removeAudioCallback(this);
+        }
         deviceManager->removeChangeListener(this);
-        stop();
+        // finishing a recording posts its own message first, the shutdown is queued behind it
         stopRecorder();
-        std::thread thread([&]{
-            taskQueue.stopQueue();
-            heavyTaskQueue.stopQueue();
-            juce::Thread::sleep(5000);
-            delete this;
+        juce::MessageManager::getInstanceWithoutCreating()->callAsync([&]{
+            TaskQueue::shared.async([&]{
+                _shutdown();
+            });
         });
-        thread.detach();
     });
 }
 
+void JuceMixPlayer::_shutdown() {
+    // the device is detached, what the last callbacks posted still reaches the queues
+    events.close();
+    // loads in flight stop at their next slice, `taskQueue` work that would start new ones is dropped
+    ++taskQueueIndex;
+    ++seekIndex;
+    taskQueue.stopQueue();
+    taskQueue.join();
+    heavyTaskQueue.stopQueue();
+    heavyTaskQueue.join();
+    compressTaskQueue.stopQueue();
+    compressTaskQueue.join();
+    // the recorded file is completed
+    recWriteTaskQueue.finishQueue();
+    recWriteTaskQueue.join();
+    // messages the queues posted run before this one
+    juce::MessageManager::getInstanceWithoutCreating()->callAsync([this]{
+        delete this;
+    });
+}
+
+void JuceMixPlayer::setPoolSize(int size) {
+    size_t missing = 0;
+    {
+        const std::lock_guard<std::mutex> guard(poolMutex);
+        poolSize = (size_t)std::max(0, size);
+        missing = poolSize - std::min(poolSize, pool.size());
+    }
+    // created without the lock, `acquire` and `release` don't wait for them
+    std::vector<JuceMixPlayer*> created;
+    for (size_t i=0; i<missing; i++) {
+        created.push_back(new JuceMixPlayer());
+    }
+    std::vector<JuceMixPlayer*> disposed;
+    {
+        const std::lock_guard<std::mutex> guard(poolMutex);
+        for (JuceMixPlayer* player: created) {
+            pool.push_back(player);
+        }
+        // released players or a smaller size meanwhile
+        while (pool.size() > poolSize) {
+            disposed.push_back(pool.back());
+            pool.pop_back();
+        }
+    }
+    for (JuceMixPlayer* player: disposed) {
+        player->dispose();
+    }
+}
+
+JuceMixPlayer* JuceMixPlayer::acquire() {
+    {
+        const std::lock_guard<std::mutex> guard(poolMutex);
+        if (!pool.empty()) {
+            JuceMixPlayer* player = pool.back();
+            pool.pop_back();
+            // the reset forgot the list the previous owner got, a new one gets it like after creation
+            juce::MessageManager::getInstanceWithoutCreating()->callAsync([player]{
+                player->notifyDeviceUpdates();
+            });
+            return player;
+        }
+    }
+    return new JuceMixPlayer();
+}
+
+void JuceMixPlayer::release() {
+    // the recorder reopens the device and finishes on the message thread, such players are not reused
+    if (!attachToAudioDevice || _isRecording || _isRecorderPrepared) {
+        dispose();
+        return;
+    }
+    // the caller may free them right after this returns
+    _clearCallbacks();
+    // what the callback and the caches posted for this owner, `_resetInPlace` drops what is posted until it runs
+    events.discard();
+    {
+        const juce::ScopedLock sl (listenersLock);
+        trackLoadListener = nullptr;
+        mergeReadyListener = nullptr;
+        readerFactory = nullptr;
+    }
+    busGain = 1;
+    // only reset players are handed out by `acquire`
+    taskQueue.async([&]{
+        _resetInPlace();
+        bool pooled = false;
+        {
+            const std::lock_guard<std::mutex> guard(poolMutex);
+            if (pool.size() < poolSize) {
+                pool.push_back(this);
+                pooled = true;
+            }
+        }
+        if (!pooled) {
+            dispose();
+        }
+    });
+}
+
+void JuceMixPlayer::_clearCallbacks() {
+    // e.g. an export completes without its callback
+    ++ownerIndex;
+    onProgressCallback = nullptr;
+    onStateUpdateCallback = nullptr;
+    onErrorCallback = nullptr;
+    onRecLevelCallback = nullptr;
+    onRecProgressCallback = nullptr;
+    onRecStateUpdateCallback = nullptr;
+    onRecErrorCallback = nullptr;
+    onDeviceUpdateCallback = nullptr;
+    onWaveformReadyCallback = nullptr;
+    onLoudnessReadyCallback = nullptr;
+    // calls that loaded one before run to their end
+    while (callbacksInFlight > 0) {
+        std::this_thread::yield();
+    }
+}
+
+void JuceMixPlayer::_resetInPlace() {
+    // silently, state notifications would reach the next owner
+    _isPlaying = false;
+    _isPlayingInternal = false;
+    _isSeeking = false;
+    _stopProgressTimer();
+    // what the callback and the caches posted for the previous owner, and the work its handlers queued
+    events.discard();
+    ++ownerIndex;
+    prefetchQueued = false;
+    {
+        const juce::ScopedLock sl (readyRequestsLock);
+        waveformRequests.clear();
+        loudnessRequests.clear();
+    }
+    levelStream.reset();
+    deviceList = {};
+    currentState = JuceMixPlayerState::IDLE;
+    currentRecState = JuceMixPlayerRecState::IDLE;
+    transport.state = (juce::int32)JuceMixPlayerState::IDLE;
+    transport.recState = (juce::int32)JuceMixPlayerRecState::IDLE;
+    transport.playHead = 0;
+    transport.duration = 0;
+    transport.recordedSamples = 0;
+    transport.inputLevel = 0;
+    transport.outputLevel = 0;
+    transport.sequence++;
+    // pooled players never had a recording in progress, only what it left behind
+    recordPath.clear();
+    recWriter.reset();
+    deviceCallbackTime1 = -1;
+    deviceCallbackTime2 = -1;
+    playBufferTime = -1;
+    resetCompletion = nullptr;
+    ++seekIndex;
+    _setMixerData(MixerData());
+    // cancels loads of the old mix even when it was empty too
+    ++taskQueueIndex;
+    repetedBufferCache.clear();
+    std::unique_ptr<SincResampler> newResampler = _createResampler(MixerSettings().resamplerQuality, sampleRate);
+    PlayBuffer::ReleasedPages releasedPages;
+    {
+        const juce::ScopedLock sl (lock);
+        settings = MixerSettings();
+        _swapResampler(newResampler);
+        playHeadIndex = 0;
+        loopRegion = {};
+        hasMixLoudness = false;
+        playBuffer.setSize(2, 0, pageDuration * sampleRate, &releasedPages);
+        playBuffer.setSampleFormat(PlayBuffer::SampleFormat::FLOAT32);
+        recordHeadIndex = 0;
+        recordTimerIndex = 0;
+        recordBufferSelect = 0;
+        recordBuffer1.setSize(1, 0);
+        recordBuffer2.setSize(1, 0);
+    }
+}
+
 JuceMixPlayer::~JuceMixPlayer() {
     PRINT("~JuceMixPlayer");
+    events.close();
+    if (onSharedBus) {
+        sharedBus->remove(this);
+    }
 }
 
 // MARK: Timer
 
 void JuceMixPlayer::_startProgressTimer() {
-    if (!isTimerRunning()) {
+    if (settings.progressCallbacks && !isTimerRunning()) {
         startTimer(settings.progressUpdateInterval * 1000);
     }
 }
@@ -161,32 +387,49 @@ void JuceMixPlayer::seek(float value) {
         return;
     }
     float _value = std::min(1.0f, std::max(value, 0.0f));
-    taskQueue.async([&, _value] {
+    // cancels running prefetch and older seeks right away, loads check it between slices
+    int seekIndex = ++this->seekIndex;
+    taskQueue.async([&, _value, seekIndex] {
+        if (seekIndex != this->seekIndex) {
+            // replaced by a newer seek
+            return;
+        }
         _isSeeking = true;
         playHeadIndex = playBuffer.getNumSamples() * _value;
-        _loadAudioBlockSafe(getDuration() * _value / blockDuration, false, [&] {
+        _loadSeekBlock(playHeadIndex, seekIndex, [&] {
             _isSeeking = false;
         });
     });
 }
 
+void JuceMixPlayer::setLoopRegion(float start, float end) {
+    {
+        const juce::ScopedLock sl (lock);
+        loopRegion = end > start ? juce::Range<float>(std::max(0.0f, start), end) : juce::Range<float>();
+    }
+    // loads the pages around the new wrap, the callback reads missing ones as silence meanwhile
+    _requestPrefetch();
+}
+
 void JuceMixPlayer::_onProgressNotify(float progress) {
-    if (onProgressCallback != nullptr)
-        onProgressCallback(this, std::min(progress, 1.0F));
+    if (auto callback = _holdCallback(onProgressCallback))
+        callback(this, std::min(progress, 1.0F));
 }
 
 void JuceMixPlayer::_onStateUpdateNotify(JuceMixPlayerState state) {
-    if (onStateUpdateCallback != nullptr) {
+    transport.state = (juce::int32)state;
+    transport.sequence++;
+    if (auto callback = _holdCallback(onStateUpdateCallback)) {
         if (currentState != state) {
             currentState = state;
-            onStateUpdateCallback(this, returnCopyCharDelete(JuceMixPlayerState_toString(state)));
+            callback(this, returnCopyChar(JuceMixPlayerState_toString(state)));
         }
     }
 }
 
 void JuceMixPlayer::_onErrorNotify(std::string error) {
-    if (onErrorCallback != nullptr)
-        onErrorCallback(this, returnCopyCharDelete(error));
+    if (auto callback = _holdCallback(onErrorCallback))
+        callback(this, returnCopyChar(error));
 }
 
 void JuceMixPlayer::togglePlayPause() {
@@ -208,22 +451,45 @@ void JuceMixPlayer::setJson(const char* json) {
             MixerData data = MixerModel::parse(json_.c_str());
             if (!(mixerData == data)) {
                 PRINT("Replacing mix data!")
-                mixerData = data;
+                _setMixerData(data);
                 _prepare();
             } else {
                 PRINT("Same mix data! updating volume/offset/fromTime" << json_);
                 _copyReaders(mixerData, data);
-                mixerData = data;
-                _resetPlayBufferBlocks();
+                // repeat track edits are heard right away, without rendering
+                _applyRenderChange(_setMixerData(data));
             }
         } catch (const std::exception& e) {
-            mixerData = MixerData();
+            _setMixerData(MixerData());
             _prepare();
             _onErrorNotify(std::string(e.what()));
         }
     });
 }
 
+void JuceMixPlayer::updateTracks(std::vector<MixerTrackUpdate> updates) {
+    if (_isExporting) {
+        _onErrorNotify("updateTracks is not supported while exporting");
+        return;
+    }
+    taskQueue.async([&, updates]{
+        MixerData data;
+        {
+            const juce::ScopedLock sl (mixerDataLock);
+            data = mixerData;
+        }
+        try {
+            MixerModel::apply(data, updates);
+        } catch (const std::exception& e) {
+            _onErrorNotify(std::string(e.what()));
+            return;
+        }
+        // the track may have just become a repeat track
+        _loadRepeatSamples(data);
+        _applyRenderChange(_setMixerData(data));
+    });
+}
+
 void JuceMixPlayer::resetPlayBuffer() {
     taskQueue.async([&]{
         _resetPlayBufferBlocks();
@@ -241,11 +507,45 @@ void JuceMixPlayer::setSettings(const char* json) {
     taskQueue.async([&, json_]{
         try {
             MixerSettings _settings = MixerModel::parseSettings(json_.c_str());
-            settings = _settings;
+            const bool loudnessChanged = _settings.loudnessMatch != settings.loudnessMatch
+            || (_settings.loudnessMatch && _settings.loudnessTarget != settings.loudnessTarget);
+            // the table is built before the lock is taken, the callback never sees a quality it isn't prepared for
+            std::unique_ptr<SincResampler> newResampler;
+            if (_settings.resamplerQuality != settings.resamplerQuality) {
+                newResampler = _createResampler(_settings.resamplerQuality, sampleRate);
+            }
+
+            {
+                const juce::ScopedLock sl (lock);
+                settings = _settings;
+                if (newResampler) {
+                    _swapResampler(newResampler);
+                }
+                // rendered pages keep their format until they are evicted
+                playBuffer.setSampleFormat(settings.compactBuffer ? PlayBuffer::SampleFormat::INT16 : PlayBuffer::SampleFormat::FLOAT32);
+                _trimCompressedPages();
+            }
+
+            if (!settings.progressCallbacks) {
+                stopTimer();
+            } else if (_isPlaying || _isRecording) {
+                _startProgressTimer();
+            }
+
+            if (loudnessChanged) {
+                MixerData data;
+                {
+                    const juce::ScopedLock sl (mixerDataLock);
+                    data = mixerData;
+                }
+                _applyRenderChange(_setMixerData(data));
+            }
 
             juce::MessageManager::getInstanceWithoutCreating()->callAsync([&]{
                 juce::AudioDeviceManager::AudioDeviceSetup setup = deviceManager->getAudioDeviceSetup();
                 setup.sampleRate = settings.sampleRate;
+                // the output restarts at the rate asked for, the timeline follows it
+                renderRateRequested = true;
                 bool treatAsChosenDevice = false;
                 juce::String error = deviceManager->setAudioDeviceSetup(setup, treatAsChosenDevice);
                 if (error.isNotEmpty()) {
@@ -260,13 +560,15 @@ void JuceMixPlayer::setSettings(const char* json) {
 }
 
 void JuceMixPlayer::_prepare() {
+    // no prefetch until the readers for new data exist
+    _isPlayingInternal = false;
     taskQueue.async([&]{
         _isPlayingInternal = false;
         _pauseInternal(false);
         playHeadIndex = 0;
         _createFileReadersAndTotalDuration();
         if (playBuffer.getNumSamples() > 0) {
-            _loadAudioBlockSafe(0, true, [&]{
+            _loadAudioBlockSafe(0, [&]{
                 _onStateUpdateNotify(JuceMixPlayerState::READY);
                 _isPlayingInternal = true;
                 if (_isPlaying) {
@@ -281,9 +583,31 @@ void JuceMixPlayer::_prepare() {
 
 void JuceMixPlayer::_resetPlayBufferBlocks() {
     _isPlayingInternal = false;
-    _loadAudioBlockSafe((getCurrentTime()/blockDuration), true, [&] {
-        _isPlayingInternal = true;
-    });
+    // a reset still in flight (READY after `_prepare`) is restarted with its own completion
+    std::function<void()> completion = resetCompletion;
+    if (!completion) {
+        completion = [&] {
+            _isPlayingInternal = true;
+        };
+    }
+    _loadAudioBlockSafe(playHeadIndex, completion);
+}
+
+void JuceMixPlayer::_refreshPlayBufferBlocks(const std::vector<juce::Range<double>>& spans) {
+    // the new data cancelled a reset in flight, it starts again with its completion
+    if (resetCompletion) {
+        _resetPlayBufferBlocks();
+        return;
+    }
+    {
+        const juce::ScopedLock sl (lock);
+        for (const juce::Range<double>& span: spans) {
+            // whole samples around the span
+            playBuffer.markStale({ (int)std::floor(span.getStart() * sampleRate), (int)std::ceil(span.getEnd() * sampleRate) });
+        }
+    }
+    // from the playhead, seeks load the stale pages they land on first
+    _requestPrefetch();
 }
 
 void JuceMixPlayer::_copyReaders(const MixerData& from, MixerData& to) {
@@ -291,233 +615,927 @@ void JuceMixPlayer::_copyReaders(const MixerData& from, MixerData& to) {
         for (MixerTrack& toTrack: to.tracks) {
             if (toTrack.id_ == fromTrack.id_) {
                 toTrack.reader = fromTrack.reader;
+                toTrack.sample = toTrack.repeat ? fromTrack.sample : nullptr;
                 break;
             }
         }
     }
+    // the track may have just become a repeat track
+    _loadRepeatSamples(to);
+    _loadMetronomeSamples(to.metronome);
+}
+
+void JuceMixPlayer::_applyRenderChange(const RenderChange& change) {
+    // e.g. a longer trim or a later offset, the old pages are laid out for the old length
+    const bool resized = _resizePlayBuffer();
+    if (playBuffer.getNumSamples() == 0) {
+        return;
+    }
+    if (resized || change.kind == RenderChange::TIMELINE) {
+        _resetPlayBufferBlocks();
+    } else if (change.kind == RenderChange::TRACKS) {
+        _refreshPlayBufferBlocks(change.spans);
+    }
+}
+
+bool JuceMixPlayer::_resizePlayBuffer() {
+    float outputDuration = 0;
+    {
+        const juce::ScopedLock sl (mixerDataLock);
+        outputDuration = MixerModel::getTotalDuration(mixerData);
+    }
+    if ((int)(outputDuration * sampleRate) == playBuffer.getNumSamples()) {
+        return false;
+    }
+    // loads in flight write pages of the old length
+    ++taskQueueIndex;
+    PlayBuffer::ReleasedPages releasedPages;
+    const juce::ScopedLock sl (lock);
+    _setPlayBufferSize(outputDuration, releasedPages);
+    playHeadIndex = std::min(playHeadIndex, playBuffer.getNumSamples());
+    return true;
+}
+
+void JuceMixPlayer::_setPlayBufferSize(float outputDuration, PlayBuffer::ReleasedPages& released) {
+    playBuffer.setSize(2, outputDuration * sampleRate, pageDuration * sampleRate, &released);
+    // the callback keeps it current once the device runs
+    transport.duration = playBuffer.getNumSamples();
+    transport.sampleRate = sampleRate.load();
+    transport.sequence++;
+}
+
+JuceMixPlayer::RenderChange JuceMixPlayer::_setMixerData(const MixerData& data) {
+    MixerData newData = data;
+    for (MixerTrack& track: newData.tracks) {
+        track.loudnessGain = _getLoudnessGain(track.path, false);
+    }
+    OneShotSampler newOneShots = _createOneShots(newData.tracks, newData.metronome);
+
+    const juce::ScopedLock sl (mixerDataLock);
+    RenderChange change = _getRenderChange(mixerData, newData);
+    mixerData = newData;
+    if (change.kind != RenderChange::NONE) {
+        // loads in flight mix the old tracks
+        ++taskQueueIndex;
+    }
+    {
+        const juce::ScopedLock bufferLock (lock);
+        std::swap(oneShots, newOneShots);
+    }
+    return change;
+}
+
+JuceMixPlayer::RenderChange JuceMixPlayer::_getRenderChange(const MixerData& from, const MixerData& to) {
+    RenderChange change;
+    if (!(from == to) || from.outputDuration != to.outputDuration) {
+        change.kind = RenderChange::TIMELINE;
+        return change;
+    }
+    for (size_t i=0; i<from.tracks.size(); i++) {
+        const MixerTrack& a = from.tracks[i];
+        const MixerTrack& b = to.tracks[i];
+        if (a.repeat && b.repeat) {
+            // played by `oneShots`
+            continue;
+        }
+        if (a.repeat != b.repeat
+            || a.offset != b.offset
+            || a.fromTime != b.fromTime
+            || a.duration != b.duration
+            || a.reader != b.reader
+            || a.volume != b.volume
+            || a.enabled != b.enabled
+            || a.loudnessGain != b.loudnessGain) {
+            change.kind = RenderChange::TRACKS;
+            for (const juce::Range<double>& span: { _getTrackSpan(a), _getTrackSpan(b) }) {
+                if (!span.isEmpty()) {
+                    change.spans.push_back(span);
+                }
+            }
+        }
+    }
+    return change;
+}
+
+juce::Range<double> JuceMixPlayer::_getTrackSpan(const MixerTrack& track) {
+    if (track.repeat || !track.reader) {
+        return {};
+    }
+    // as `_calculateRangeToRead` reads it, the file can end before
+    const double length = track.duration == 0 ? (double)track.reader->lengthInSamples / track.reader->sampleRate : track.duration;
+    return { track.offset, track.offset + length };
+}
+
+float JuceMixPlayer::_getLoudnessGain(const std::string& path, bool analyse) {
+    if (!settings.loudnessMatch || path.empty()) {
+        return 1;
+    }
+    MixerLoudness measured;
+    const int status = analyse ? loudness.analyse(path, measured) : loudness.getLoudness(path, measured);
+    // silent files stay as they are
+    if (status != 1 || measured.integrated <= -70) {
+        return 1;
+    }
+    // never pushes the true peak above -1 dBTP
+    const float gainDb = std::min(settings.loudnessTarget - measured.integrated, -1 - measured.truePeak);
+    return juce::Decibels::decibelsToGain(gainDb);
+}
+
+void JuceMixPlayer::_onLoudnessReady(const std::string& path) {
+    if (!settings.loudnessMatch || _isExporting) {
+        return;
+    }
+    MixerData data;
+    {
+        const juce::ScopedLock sl (mixerDataLock);
+        data = mixerData;
+    }
+    const bool used = std::any_of(data.tracks.begin(), data.tracks.end(), [&](const MixerTrack& track) {
+        return track.path == path;
+    });
+    if (!used) {
+        return;
+    }
+    _applyRenderChange(_setMixerData(data));
 }
 
 void JuceMixPlayer::_createFileReadersAndTotalDuration() {
-    for (MixerTrack& track: mixerData.tracks) {
-        juce::File file(track.path);
-        track.reader.reset(formatManager.createReaderFor(file));
-        if (!track.reader) {
+    std::vector<std::shared_ptr<juce::AudioFormatReader>> readers;
+    std::vector<std::shared_ptr<const juce::AudioBuffer<float>>> samples;
+    std::unordered_set<std::string> samplePaths;
+    for (const MixerTrack& track: mixerData.tracks) {
+        readers.emplace_back(_createReader(track.path));
+        if (!readers.back()) {
             _onErrorNotify("unable to read " + track.path);
         }
+        samples.emplace_back(track.repeat && readers.back() ? _loadOneShotSample(track.path) : nullptr);
+        if (track.repeat) {
+            samplePaths.insert(track.path);
+        }
+    }
+    MixerMetronome metronome = mixerData.metronome;
+    _loadMetronomeSamples(metronome);
+    if (metronome.enabled) {
+        samplePaths.insert(metronome.clickPath);
+        samplePaths.insert(metronome.accentPath);
+    }
+    // files no longer repeated
+    for (auto it = repetedBufferCache.begin(); it != repetedBufferCache.end(); ) {
+        it = samplePaths.count(it->first) == 0 ? repetedBufferCache.erase(it) : std::next(it);
     }
 
+    // loads in flight keep the old readers
+    const juce::ScopedLock sl (mixerDataLock);
+    for (size_t i=0; i<readers.size(); i++) {
+        mixerData.tracks[i].reader = readers[i];
+        mixerData.tracks[i].sample = samples[i];
+    }
+    mixerData.metronome = metronome;
+
     float outputDuration = MixerModel::getTotalDuration(mixerData);
+    OneShotSampler newOneShots = _createOneShots(mixerData.tracks, mixerData.metronome);
 
-    bool keepExistingContent = false;
-    bool clearExtraSpace = true;
-    bool avoidReallocating = false;
-    playBuffer.setSize(2, outputDuration * sampleRate, keepExistingContent, clearExtraSpace, avoidReallocating);
+    PlayBuffer::ReleasedPages releasedPages;
+    const juce::ScopedLock bufferLock (lock);
+    _setPlayBufferSize(outputDuration, releasedPages);
+    std::swap(oneShots, newOneShots);
 }
 
-std::optional<std::tuple<float, float, float>> JuceMixPlayer::_calculateBlockToRead(float block, MixerTrack& track) {
-    if (track.offset > block * blockDuration + blockDuration) {
-        PRINT("block <--");
+std::optional<std::tuple<int, int, juce::int64>> JuceMixPlayer::_calculateRangeToRead(int startSample, int numSamples, MixerTrack& track) {
+    const juce::int64 rangeEnd = (juce::int64)startSample + numSamples;
+    const juce::int64 offset = std::llround(track.offset * sampleRate);
+    if (offset > rangeEnd) {
+        PRINT("range <--");
         return std::nullopt;
     }
 
-    float track_duration = track.duration == 0 ? track.reader->lengthInSamples / sampleRate : track.duration;
+    const juce::int64 trackLength = track.duration == 0 ? track.reader->lengthInSamples : std::llround(track.duration * sampleRate);
 
-    if (track.offset + track_duration < block * blockDuration) {
-        PRINT("--> block");
+    if (offset + trackLength < startSample) {
+        PRINT("--> range");
         return std::nullopt;
     }
 
-    float diff = track.offset - block * blockDuration;
+    const juce::int64 diff = offset - startSample;
+
+    const juce::int64 dstStart = std::min<juce::int64>(numSamples, std::max<juce::int64>(diff, 0));
+    const juce::int64 readStart = std::max<juce::int64>(-diff, 0) + std::llround(track.fromTime * sampleRate);
 
-    float dstStart = std::min(blockDuration, std::max(diff, 0.0f)) * sampleRate;
-    float numSamples = blockDuration * sampleRate;
-    float readStart = (std::abs(std::min(diff, 0.0f)) + track.fromTime) * sampleRate;
+    juce::int64 count = numSamples - dstStart;
+    count = std::min(count, track.reader->lengthInSamples - readStart);
+    // track ends inside the range
+    count = std::min(count, offset + trackLength - startSample - dstStart);
 
-    if (readStart + numSamples > track.reader->lengthInSamples) {
-        numSamples = track.reader->lengthInSamples - readStart;
+    if (count <= 0) {
+        return std::nullopt;
     }
-    if (dstStart + numSamples > blockDuration * sampleRate) {
-        numSamples = blockDuration * sampleRate - dstStart;
+    return std::tuple((int)dstStart, (int)count, readStart);
+}
+
+juce::AudioFormatReader* JuceMixPlayer::_createFileReader(const juce::File& file) {
+    std::function<juce::AudioFormatReader*(const juce::File& file)> factory;
+    {
+        const juce::ScopedLock sl (listenersLock);
+        factory = readerFactory;
     }
-    float lefover = (track.offset + track_duration - block * blockDuration) * sampleRate;
-    if (numSamples > lefover) {
-        numSamples = lefover;
+    if (factory) {
+        return factory(file);
     }
-
-    return std::tuple(dstStart, numSamples, readStart);
+    // WAV and AIFF are converted straight from the mapped file, no stream buffer or read calls, and the OS pages
+    // them in and out. The recorder and export delete a file before writing it, so a mapping never sees it shrink.
+    if (juce::AudioFormat* format = formatManager.findFormatForFileExtension(file.getFileExtension())) {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+        if (mapped != nullptr && mapped->mapEntireFile()) {
+            return mapped.release();
+        }
+    }
+    return formatManager.createReaderFor(file);
 }
 
-void JuceMixPlayer::_loadRepeatedTrack(int block,
-                                       int blockDuration,
-                                       juce::AudioBuffer<float>& output,
-                                       float offset,
-                                       float repeatInterval,
-                                       juce::AudioBuffer<float>* track)
-{
-    const int numChannels = output.getNumChannels();
-    const int outputLength = output.getNumSamples();              // blockDuration * sampleRate
-    const int trackLength = track->getNumSamples();
-    const int blockStart = block * blockDuration * sampleRate;  // first sample of this block in the full timeline
-
-    const int offsetSamples   = static_cast<int>(offset * sampleRate);
-    const int intervalSamples = static_cast<int>(repeatInterval * sampleRate);
+juce::AudioFormatReader* JuceMixPlayer::_createReader(const std::string& path) {
+    juce::AudioFormatReader* reader = _createFileReader(juce::File(path));
+    if (reader == nullptr || reader->sampleRate == sampleRate) {
+        return reader;
+    }
+    auto resampling = new ResamplingReader(reader, sampleRate);
+    // the caches keep peaks and loudness of the file itself
+    resampling->onSourceDecoded = [this, path](const juce::AudioFormatReader& source,
+                                               const juce::AudioBuffer<float>& buffer,
+                                               int startSample,
+                                               int numSamples,
+                                               juce::int64 fileStartSample) {
+        waveforms.addDecodedAudio(path, source, buffer, startSample, numSamples, fileStartSample);
+        loudness.addDecodedAudio(path, source, buffer, startSample, numSamples, fileStartSample);
+    };
+    return resampling;
+}
 
-    for (int repeatIndex = 0; ; ++repeatIndex)
+void JuceMixPlayer::_setRenderRate(float rate) {
+    if (rate <= 0 || rate == sampleRate) {
+        return;
+    }
+    PRINT("_setRenderRate: " << sampleRate << " -> " << rate);
+    // loads in flight mix at the old rate
+    ++taskQueueIndex;
+    std::unique_ptr<SincResampler> newResampler = _createResampler(settings.resamplerQuality, rate);
+    PlayBuffer::ReleasedPages releasedPages;
     {
-        // absolute sample where this repeat begins
-        int repeatStartAbs = offsetSamples + repeatIndex * intervalSamples;
-        // if the start is beyond the end of this block, we're done
-        if (repeatStartAbs >= blockStart + outputLength)
-            break;
+        const juce::ScopedLock sl (lock);
+        playHeadIndex = (int)std::llround((double)playHeadIndex * rate / sampleRate);
+        sampleRate = rate;
+        // silence until the pages are mixed again at the new rate
+        playBuffer.clear(&releasedPages);
+        _swapResampler(newResampler);
+    }
+    synthesizedClick = OneShotSampler::synthesizeClick(sampleRate, 1000, 0.5f);
+    synthesizedAccent = OneShotSampler::synthesizeClick(sampleRate, 1500, 0.8f);
+    // decoded at the old rate
+    repetedBufferCache.clear();
+    // new readers and samples at the new rate, and `playBuffer` pages of the new size
+    _createFileReadersAndTotalDuration();
+    if (playBuffer.getNumSamples() > 0) {
+        _resetPlayBufferBlocks();
+    }
+}
+
+std::shared_ptr<const juce::AudioBuffer<float>> JuceMixPlayer::_loadOneShotSample(const std::string& path) {
+    auto cached = repetedBufferCache.find(path);
+    if (cached != repetedBufferCache.end()) {
+        return cached->second;
+    }
+    auto sample = _decodeOneShotSample(path);
+    if (sample) {
+        repetedBufferCache[path] = sample;
+    }
+    return sample;
+}
 
-        // if the end of this track-play occurs before this block starts, skip it
-        if (repeatStartAbs + trackLength <= blockStart)
+void JuceMixPlayer::_loadRepeatSamples(MixerData& data) {
+    std::vector<std::string> paths;
+    for (MixerTrack& track: data.tracks) {
+        if (!track.repeat || !track.reader || track.sample) {
             continue;
+        }
+        auto cached = repetedBufferCache.find(track.path);
+        if (cached != repetedBufferCache.end()) {
+            track.sample = cached->second;
+        } else if (std::find(paths.begin(), paths.end(), track.path) == paths.end()) {
+            paths.push_back(track.path);
+        }
+    }
+    if (paths.empty()) {
+        return;
+    }
+    const int owner = ownerIndex;
+    heavyTaskQueue.async([&, paths, owner] {
+        std::vector<std::pair<std::string, std::shared_ptr<const juce::AudioBuffer<float>>>> samples;
+        for (const std::string& path: paths) {
+            samples.emplace_back(path, _decodeOneShotSample(path));
+        }
+        taskQueue.async([&, samples, owner] {
+            if (owner != ownerIndex) {
+                return;
+            }
+            MixerData data;
+            {
+                const juce::ScopedLock sl (mixerDataLock);
+                data = mixerData;
+            }
+            bool used = false;
+            for (const auto& [path, sample]: samples) {
+                for (MixerTrack& track: data.tracks) {
+                    // replaced or no longer repeated meanwhile otherwise
+                    if (sample && track.repeat && track.reader && !track.sample && track.path == path) {
+                        track.sample = sample;
+                        repetedBufferCache[path] = sample;
+                        used = true;
+                    }
+                }
+            }
+            if (used) {
+                _applyRenderChange(_setMixerData(data));
+            }
+        });
+    });
+}
 
-        // local position in the block buffer
-        int writePos = repeatStartAbs - blockStart;
-        // if it's negative, we'll start reading from inside the track
-        int trackReadPos = writePos < 0 ? -writePos : 0;
-        // clamp to the block
-        int samplesToCopy = std::min(trackLength - trackReadPos, outputLength - std::max(writePos, 0));
+std::shared_ptr<const juce::AudioBuffer<float>> JuceMixPlayer::_decodeOneShotSample(const std::string& path) {
+    // own reader, the track reader can be in use by a load
+    std::unique_ptr<juce::AudioFormatReader> reader(_createReader(path));
+    if (!reader) {
+        return nullptr;
+    }
+    const int sampleCount = (int)reader->lengthInSamples;
+    // mono stays mono, the sampler plays it on both sides
+    auto sample = std::make_shared<juce::AudioBuffer<float>>(juce::jlimit(1, 2, (int)reader->numChannels), sampleCount);
+    if (!reader->read(sample.get(), 0, sampleCount, 0, true, true)) {
+        _onErrorNotify("Read operation was not success for: " + path);
+        return nullptr;
+    }
+    // converted readers pass on the file audio themselves
+    if (dynamic_cast<ResamplingReader*>(reader.get()) == nullptr) {
+        waveforms.addDecodedAudio(path, *reader, *sample, 0, sampleCount, 0);
+        loudness.addDecodedAudio(path, *reader, *sample, 0, sampleCount, 0);
+    }
+    return sample;
+}
+
+void JuceMixPlayer::_loadMetronomeSamples(MixerMetronome& metronome) {
+    if (!metronome.enabled) {
+        return;
+    }
+    metronome.clickSample = metronome.clickPath.empty() ? synthesizedClick : _loadOneShotSample(metronome.clickPath);
+    metronome.accentSample = metronome.accentPath.empty() ? synthesizedAccent : _loadOneShotSample(metronome.accentPath);
+}
 
-        for (int channel = 0; channel < numChannels; ++channel) {
-            int trackChannel = (channel < track->getNumChannels() ? channel : 0);
-            output.addFrom(channel, std::max(writePos, 0) /*destStartSample*/, *track, trackChannel,/*srcStartSample=*/ trackReadPos, samplesToCopy, 1.0f);
+OneShotSampler JuceMixPlayer::_createOneShots(const std::vector<MixerTrack>& tracks, const MixerMetronome& metronome) {
+    OneShotSampler sampler;
+    for (const MixerTrack& track: tracks) {
+        if (track.enabled && track.repeat && track.sample) {
+            OneShotSampler::Pattern pattern;
+            pattern.sample = track.sample;
+            // whole samples, as repeat tracks always were
+            pattern.offset = (double)static_cast<juce::int64>(track.offset * sampleRate);
+            pattern.interval = (double)static_cast<juce::int64>(track.repeatInterval * sampleRate);
+            pattern.gain = track.volume * track.loudnessGain;
+            sampler.add(pattern);
         }
     }
+
+    if (metronome.enabled) {
+        // one pattern per beat of the bar, repeating every bar
+        const double beatSamples = 60.0 / metronome.bpm * 4.0 / metronome.beatUnit * sampleRate;
+        for (int beat=0; beat<metronome.beatsPerBar; beat++) {
+            const int accent = metronome.accents.empty()
+            ? (beat == 0 ? 2 : 1)
+            : metronome.accents[(size_t)beat % metronome.accents.size()];
+            if (accent == 0) {
+                continue;
+            }
+            OneShotSampler::Pattern pattern;
+            pattern.sample = accent == 2 ? metronome.accentSample : metronome.clickSample;
+            pattern.offset = (double)metronome.offset * sampleRate + beat * beatSamples;
+            pattern.interval = metronome.beatsPerBar * beatSamples;
+            pattern.gain = metronome.volume;
+            sampler.add(pattern);
+        }
+    }
+    return sampler;
+}
+
+int JuceMixPlayer::_getPageCount(float duration) {
+    return std::max(1, (int)std::lround(duration / pageDuration));
+}
+
+float JuceMixPlayer::_getLookAhead() {
+    // the look-ahead window is never evicted, keep it inside the memory budget
+    return loadPolicy.getLookAhead(std::min(settings.maxLookAhead, settings.maxBufferedDuration));
+}
+
+juce::Range<int> JuceMixPlayer::_getLoopRange(int playHead) {
+    // recording never loops, it stops at the end of the timeline
+    if (_isRecording) {
+        return {};
+    }
+    const juce::Range<int> timeline(0, playBuffer.getNumSamples());
+    const juce::Range<int> region = timeline.getIntersectionWith({ (int)std::lround(loopRegion.getStart() * sampleRate),
+                                                                   (int)std::lround(loopRegion.getEnd() * sampleRate) });
+    // a seek after the region leaves it
+    if (!region.isEmpty() && playHead < region.getEnd()) {
+        return region;
+    }
+    return settings.loop ? timeline : juce::Range<int>();
 }
 
-void JuceMixPlayer::_loadAudioBlockSafe(int block, bool reset, std::function<void()> completion) {
-    int taskQueueIndex = reset ? ++this->taskQueueIndex : this->taskQueueIndex;
-    heavyTaskQueue.async([&, taskQueueIndex, block, reset, completion] {
-        if (reset) {
-            loadingBlocks.clear();
-            loadedBlocks.clear();
-            playBuffer.clear();
+void JuceMixPlayer::_loadAudioBlockSafe(int startSample, std::function<void()> completion) {
+    int taskQueueIndex = ++this->taskQueueIndex;
+    resetCompletion = completion;
+    heavyTaskQueue.asyncPriority([&, taskQueueIndex, startSample, completion] {
+        int firstPage = 0;
+        {
+            PlayBuffer::ReleasedPages releasedPages;
+            const juce::ScopedLock sl (lock);
+            playBuffer.clear(&releasedPages);
+            firstPage = playBuffer.getPageForSample(startSample);
         }
-        _loadAudioBlock(block, taskQueueIndex);
+        // nothing is buffered, `completion` (READY) only waits for the start margin, prefetch loads the rest
+        const int numPages = std::max(1, (int)std::ceil(settings.startMargin / pageDuration));
+        _loadAudioBlock(firstPage, numPages, taskQueueIndex);
         taskQueue.async([&, completion, taskQueueIndex] {
             if (taskQueueIndex == this->taskQueueIndex) {
+                resetCompletion = nullptr;
                 completion();
+                _requestPrefetch();
             }
         });
     });
 }
 
-void JuceMixPlayer::_loadAudioBlock(int block, int taskQueueIndex) {
-    if (taskQueueIndex != this->taskQueueIndex) return;
+void JuceMixPlayer::_loadSeekBlock(int startSample, int seekIndex, std::function<void()> completion) {
+    int taskQueueIndex = this->taskQueueIndex;
+    heavyTaskQueue.asyncPriority([&, taskQueueIndex, seekIndex, startSample, completion] {
+        bool notified = false;
+        auto notify = [&, seekIndex, completion] {
+            notified = true;
+            taskQueue.async([&, seekIndex, completion] {
+                // a newer seek clears `_isSeeking` itself
+                if (seekIndex == this->seekIndex) {
+                    completion();
+                }
+            });
+        };
+        int firstPage = 0;
+        {
+            const juce::ScopedLock sl (lock);
+            firstPage = playBuffer.getPageForSample(startSample);
+        }
+        // the seek page plus the one playback continues into, prefetch takes over from there
+        const int numPages = _getPageCount(loadPolicy.getBlockDuration(0)) + 1;
+        _loadAudioBlock(firstPage, numPages, taskQueueIndex, seekIndex, startSample, notify);
+        // pages were loaded already, or the load was cancelled
+        if (!notified) {
+            notify();
+        }
+        _requestPrefetch();
+    });
+}
 
-    const float destStartSample = block * blockDuration * sampleRate;
-    if (destStartSample >= playBuffer.getNumSamples()) {
-        return;
+void JuceMixPlayer::_requestPrefetch() {
+    if (!prefetchQueued.exchange(true)) {
+        heavyTaskQueue.async([&] {
+            prefetchQueued = false;
+            _prefetch();
+        });
+    }
+}
+
+void JuceMixPlayer::_prefetch() {
+    // runs while paused too. Pages loaded while new data is prepared are cancelled by the index,
+    // or cleared by the reset load that runs after them.
+    const int taskQueueIndex = this->taskQueueIndex;
+    const int seekIndex = this->seekIndex;
+    const int playHead = playHeadIndex;
+    const float lookAhead = _getLookAhead();
+
+    int firstPage = -1;
+    int numPages = 0;
+    {
+        const juce::ScopedLock sl (lock);
+        const juce::Range<int> loopRange = _getLoopRange(playHead);
+        const int lookAheadSamples = (int)(lookAhead * sampleRate);
+
+        // the look-ahead window in play order, it continues from the loop start when it passes the loop end
+        std::vector<juce::Range<int>> windows;
+        if (!loopRange.isEmpty() && playHead < loopRange.getEnd()) {
+            windows.push_back({ playHead, std::min(loopRange.getEnd(), playHead + lookAheadSamples) });
+            const int wrapped = playHead + lookAheadSamples - loopRange.getEnd();
+            if (wrapped > 0) {
+                windows.push_back({ loopRange.getStart(), loopRange.getStart() + std::min(wrapped, loopRange.getLength()) });
+            }
+        } else {
+            windows.push_back({ playHead, (int)std::min<juce::int64>(playBuffer.getNumSamples(), playHead + (juce::int64)lookAheadSamples) });
+        }
+
+        int lastPage = -1;
+        int windowDistance = 0;
+        for (const juce::Range<int>& window: windows) {
+            if (window.isEmpty()) {
+                continue;
+            }
+            lastPage = playBuffer.getPageForSample(window.getEnd() - 1);
+            for (int page = playBuffer.getPageForSample(window.getStart()); page <= lastPage; page++) {
+                if (playBuffer.getPageState(page) != PlayBuffer::PageState::RENDERED) {
+                    firstPage = page;
+                    break;
+                }
+            }
+            if (firstPage >= 0) {
+                const float bufferedAhead = (windowDistance + std::max(0, playBuffer.getPageRange(firstPage).getStart() - window.getStart())) / sampleRate;
+                numPages = std::min(_getPageCount(loadPolicy.getBlockDuration(bufferedAhead)), lastPage - firstPage + 1);
+                break;
+            }
+            windowDistance += window.getLength();
+        }
+        if (firstPage < 0 && settings.backgroundFill) {
+            // look-ahead is full, fill the rest of the timeline after it and then from the start,
+            // only the loop when looping. One page per job, so the next prefetch or seek never waits long behind it.
+            // Stale pages are rendered again beyond the memory budget, they are allocated already.
+            const bool belowBudget = playBuffer.getNumAllocatedPages() < _getPageCount(settings.maxBufferedDuration);
+            const int fillFirstPage = loopRange.isEmpty() ? 0 : playBuffer.getPageForSample(loopRange.getStart());
+            const int fillPages = loopRange.isEmpty() ? playBuffer.getNumPages() : playBuffer.getPageForSample(loopRange.getEnd() - 1) - fillFirstPage + 1;
+            for (int i=1; i<=fillPages; i++) {
+                const int page = fillFirstPage + ((lastPage - fillFirstPage + i) % fillPages + fillPages) % fillPages;
+                const PlayBuffer::PageState state = playBuffer.getPageState(page);
+                if (state == PlayBuffer::PageState::STALE
+                    || (belowBudget && (state == PlayBuffer::PageState::EMPTY || state == PlayBuffer::PageState::EVICTED))) {
+                    firstPage = page;
+                    numPages = 1;
+                    break;
+                }
+            }
+        }
     }
 
-    if (setContains(loadedBlocks, block)) {
-        // block is already loaded
-        return;
+    if (firstPage >= 0) {
+        _loadAudioBlock(firstPage, numPages, taskQueueIndex, seekIndex);
     }
-    if (setContains(loadingBlocks, block)) {
-        // already block is getting loaded
-        return;
+    _evictPages();
+    if (firstPage >= 0) {
+        // until the look-ahead is full, or the memory budget with background fill
+        _requestPrefetch();
     }
-    if (playBuffer.getNumSamples() == 0) {
-        _onErrorNotify("output duration is 0");
+}
+
+void JuceMixPlayer::_evictPages() {
+    const int playHead = playHeadIndex;
+    const float lookAhead = _getLookAhead();
+
+    // freed after the lock
+    PlayBuffer::ReleasedPages releasedPages;
+    const juce::ScopedLock sl (lock);
+    const int maxPages = _getPageCount(settings.maxBufferedDuration);
+    if (playBuffer.getNumAllocatedPages() <= maxPages) {
         return;
     }
+    // the callback wraps to the loop start without waiting, keep it as if it was ahead of the playhead,
+    // and the page the loop ends in
+    const juce::Range<int> loopRange = _getLoopRange(playHead);
+    const int loopFirstPage = loopRange.isEmpty() ? 0 : playBuffer.getPageForSample(loopRange.getStart());
+    const int loopLastPage = loopRange.isEmpty() ? -1 : playBuffer.getPageForSample(std::min(loopRange.getEnd(), loopRange.getStart() + (int)(lookAhead * sampleRate)) - 1);
+    const int loopEndPage = loopRange.isEmpty() ? -1 : playBuffer.getPageForSample(loopRange.getEnd() - 1);
+    const int playHeadPage = playBuffer.getPageForSample(playHead);
+    // nothing after the loop end is ahead of the playhead
+    const int lookAheadEnd = playHead + (int)(lookAhead * sampleRate);
+    const int lookAheadPage = playBuffer.getPageForSample(loopRange.isEmpty() ? lookAheadEnd : std::min(lookAheadEnd, loopRange.getEnd() - 1));
+
+    // rendered 16 bit pages without a compressed copy, encoded on `compressTaskQueue` once evicted.
+    // Float pages would come back narrowed and clipped.
+    const bool compress = settings.compressedCacheSize > 0;
+    std::vector<std::pair<int, std::shared_ptr<const PlayBuffer::PageAudio>>> evictedPages;
+
+    // pages outside the loop are never played again and go first. Then the farthest page from the playhead,
+    // from whichever end of the timeline is farther.
+    for (int pass = loopRange.isEmpty() ? 1 : 0; pass < 2; pass++) {
+        int low = 0;
+        int high = playBuffer.getNumPages() - 1;
+        while (playBuffer.getNumAllocatedPages() > maxPages && low <= high) {
+            const int page = playHeadPage - low >= high - playHeadPage ? low++ : high--;
+            if ((page >= playHeadPage && page <= lookAheadPage) || (page >= loopFirstPage && page <= loopLastPage) || page == loopEndPage) {
+                continue;
+            }
+            if (pass == 0 && playBuffer.getPageRange(page).intersects(loopRange)) {
+                continue;
+            }
+            if (playBuffer.isPageAllocated(page) && playBuffer.getPageState(page) != PlayBuffer::PageState::LOADING) {
+                if (compress && playBuffer.getPageState(page) == PlayBuffer::PageState::RENDERED && !playBuffer.getCompressedPage(page)) {
+                    auto audio = playBuffer.getPageAudio(page);
+                    if (audio->format == PlayBuffer::SampleFormat::INT16) {
+                        evictedPages.emplace_back(page, std::move(audio));
+                    }
+                }
+                playBuffer.evict(page, &releasedPages);
+            }
+        }
+    }
 
-    loadingBlocks.insert(block);
-
-    // load the block
-    juce::AudioBuffer<float> tempBuffer;
-    tempBuffer.setSize(2, blockDuration * sampleRate);
+    if (!evictedPages.empty()) {
+        const int numChannels = playBuffer.getNumChannels();
+        const int pageSize = playBuffer.getPageSize();
+        const int generation = playBuffer.getGeneration();
+        auto pagesToCompress = std::make_shared<std::vector<std::pair<int, std::shared_ptr<const PlayBuffer::PageAudio>>>>(std::move(evictedPages));
+        compressTaskQueue.async([this, pagesToCompress, numChannels, pageSize, generation] {
+            std::vector<juce::int16> samples((size_t)(numChannels * pageSize));
+            for (const auto& [page, audio]: *pagesToCompress) {
+                // evicted, nothing writes it anymore. 16 bit, copied as is.
+                audio->read(samples.data());
+                auto data = std::make_shared<const std::vector<juce::uint8>>(BlockCodec::encode(samples.data(), numChannels, pageSize));
+                const juce::ScopedLock sl (lock);
+                // the pages were cleared for a new mix meanwhile
+                if (playBuffer.getGeneration() != generation) {
+                    return;
+                }
+                playBuffer.setCompressedPage(page, data);
+            }
+            const juce::ScopedLock sl (lock);
+            _trimCompressedPages();
+        });
+    }
+}
 
-    // clear the result block
-    int start = (int)(block * blockDuration * sampleRate);
-    int num = (int)(blockDuration * sampleRate);
-    if (start + num <= playBuffer.getNumSamples()) {
-        playBuffer.clear(start, num);
+void JuceMixPlayer::_trimCompressedPages() {
+    const size_t maxBytes = (size_t)(settings.compressedCacheSize * 1024 * 1024);
+    const int playHeadPage = playBuffer.getPageForSample(playHeadIndex);
+    int low = 0;
+    int high = playBuffer.getNumPages() - 1;
+    while (playBuffer.getNumCompressedBytes() > maxBytes && low <= high) {
+        const int page = playHeadPage - low >= high - playHeadPage ? low++ : high--;
+        playBuffer.setCompressedPage(page, nullptr);
     }
+}
 
-    int sampleCount = blockDuration * sampleRate;
+bool JuceMixPlayer::_isLoadCancelled(int taskQueueIndex, int seekIndex) {
+    return taskQueueIndex != this->taskQueueIndex || (seekIndex >= 0 && seekIndex != this->seekIndex);
+}
 
-    for (MixerTrack& track: mixerData.tracks) {
-        if (taskQueueIndex != this->taskQueueIndex) return;
+void JuceMixPlayer::_loadAudioBlock(int firstPage,
+                                    int numPages,
+                                    int taskQueueIndex,
+                                    int seekIndex,
+                                    int firstSample,
+                                    std::function<void()> firstSliceLoaded) {
+    if (_isLoadCancelled(taskQueueIndex, seekIndex)) return;
+
+    // claim the pages that still need rendering, other loads skip them
+    std::vector<int> pages;
+    std::vector<PlayBuffer::PageState> claimedStates;
+    std::vector<juce::Range<int>> pageRanges;
+    std::vector<std::shared_ptr<const std::vector<juce::uint8>>> compressedPages;
+    // pages without memory, it is allocated before the lock is taken to write them
+    std::vector<bool> needsAudio;
+    PlayBuffer::SampleFormat sampleFormat = PlayBuffer::SampleFormat::FLOAT32;
+    int numChannels = 0;
+    int pageSize = 0;
+    int generation = 0;
+    {
+        const juce::ScopedLock sl (lock);
+        const int endPage = std::min(playBuffer.getNumPages(), firstPage + numPages);
+        for (int page = std::max(0, firstPage); page < endPage; page++) {
+            const PlayBuffer::PageState state = playBuffer.getPageState(page);
+            if (state == PlayBuffer::PageState::EMPTY || state == PlayBuffer::PageState::EVICTED || state == PlayBuffer::PageState::STALE) {
+                playBuffer.setPageState(page, PlayBuffer::PageState::LOADING);
+                pages.push_back(page);
+                claimedStates.push_back(state);
+                pageRanges.push_back(playBuffer.getPageRange(page));
+                compressedPages.push_back(playBuffer.getCompressedPage(page));
+                needsAudio.push_back(!playBuffer.isPageAllocated(page));
+            }
+        }
+        sampleFormat = playBuffer.getSampleFormat();
+        numChannels = playBuffer.getNumChannels();
+        pageSize = playBuffer.getPageSize();
+        generation = playBuffer.getGeneration();
+    }
+    if (pages.empty()) {
+        // already loaded or loading
+        return;
+    }
+
+    std::vector<std::shared_ptr<PlayBuffer::PageAudio>> pageAudio(pages.size());
+    for (size_t i=0; i<pages.size(); i++) {
+        if (needsAudio[i]) {
+            pageAudio[i] = std::make_shared<PlayBuffer::PageAudio>(sampleFormat, numChannels, pageSize);
+        }
+    }
 
-        if (!track.enabled) {
+    // evicted pages of this mix are decoded instead of mixed again, the mix is rendered for the rest
+    std::vector<bool> restored(pages.size(), false);
+    std::vector<juce::int16> pageSamples;
+    for (size_t i=0; i<pages.size(); i++) {
+        if (!compressedPages[i] || _isLoadCancelled(taskQueueIndex, seekIndex)) {
             continue;
         }
-        if (!track.reader) {
-            _onErrorNotify("reader not found for " + track.path);
+        pageSamples.resize((size_t)(numChannels * pageSize));
+        if (!BlockCodec::decode(*compressedPages[i], pageSamples.data(), numChannels, pageSize)) {
             continue;
         }
-
-        // clear block buffer
-        tempBuffer.clear();
-
-        // mix audio from block buffer
-        if (destStartSample + sampleCount > playBuffer.getNumSamples()) {
-            sampleCount = playBuffer.getNumSamples() - destStartSample;
+        {
+            // unused when the format changed meanwhile, freed after the lock
+            std::shared_ptr<PlayBuffer::PageAudio> unusedAudio;
+            const juce::ScopedLock sl (lock);
+            if (_isLoadCancelled(taskQueueIndex, seekIndex) || playBuffer.getGeneration() != generation) {
+                continue;
+            }
+            unusedAudio = playBuffer.attachPageAudio(pages[i], std::move(pageAudio[i]));
+            playBuffer.writePage(pages[i], pageSamples.data());
+            playBuffer.setPageState(pages[i], PlayBuffer::PageState::RENDERED);
+            restored[i] = true;
         }
+        if (i == 0 && firstSliceLoaded) {
+            firstSliceLoaded();
+            firstSliceLoaded = nullptr;
+        }
+    }
 
-        if (track.repeat) {
-            int sampleCount = (int)track.reader->lengthInSamples;
-            std::shared_ptr<juce::AudioBuffer<float>> buff;
-            if (repetedBufferCache.find(track.path) == repetedBufferCache.end()) {
-                buff.reset(new juce::AudioBuffer<float>(2, sampleCount));
-                track.reader->read(buff.get(), 0, sampleCount, 0, true, true);
-                if (taskQueueIndex != this->taskQueueIndex) return;
-                repetedBufferCache[track.path] = buff;
-            } else {
-                buff = repetedBufferCache.at(track.path);
+    struct Slice {
+        size_t pageIndex;
+        juce::Range<int> range;
+    };
+
+    // the seek point first, then the pages forward and finally the part of the first page before the seek point
+    std::vector<Slice> slices;
+    juce::Range<int> behindSeekPoint;
+    for (size_t i=0; i<pages.size(); i++) {
+        const juce::Range<int> range = pageRanges[i];
+        if (restored[i]) {
+            continue;
+        }
+        if (i == 0 && range.contains(firstSample)) {
+            const int seekSliceEnd = std::min(range.getEnd(), firstSample + (int)(seekSliceDuration * sampleRate));
+            slices.push_back({ i, { firstSample, seekSliceEnd } });
+            if (seekSliceEnd < range.getEnd()) {
+                slices.push_back({ i, { seekSliceEnd, range.getEnd() } });
             }
-            _loadRepeatedTrack(block, blockDuration, tempBuffer, track.offset, track.repeatInterval, buff.get());
+            behindSeekPoint = { range.getStart(), firstSample };
         } else {
-            auto res = _calculateBlockToRead(block, track);
-            if (!res.has_value()) {
-                continue;
-            }
+            slices.push_back({ i, range });
+        }
+    }
+    if (!behindSeekPoint.isEmpty()) {
+        slices.push_back({ 0, behindSeekPoint });
+    }
+    if (slices.empty()) {
+        // all restored
+        return;
+    }
 
-            float dstStart = std::get<0>(res.value());
-            float numSamples = std::get<1>(res.value());
-            float readStart = std::get<2>(res.value());
+    std::vector<int> remainingSlices(pages.size(), 0);
+    for (const Slice& slice: slices) {
+        remainingSlices[slice.pageIndex]++;
+    }
 
-            // read data into block buffer
-            const bool success = track.reader->read(&tempBuffer, dstStart, numSamples, readStart, true, true);
-            if (taskQueueIndex != this->taskQueueIndex) return;
-            if (!success) {
-                std::string err = "Read operation was not success for: " + track.path;
-                _onErrorNotify(err);
+    // tracks can be replaced on `taskQueue` while these pages are loading
+    std::vector<MixerTrack> tracks;
+    {
+        const juce::ScopedLock sl (mixerDataLock);
+        tracks = mixerData.tracks;
+    }
+    // played by the audio callback, headless players have none and keep them in the pages
+    OneShotSampler pageOneShots;
+    if (!attachToAudioDevice) {
+        const juce::ScopedLock sl (lock);
+        pageOneShots = oneShots;
+    }
+
+    juce::AudioBuffer<float> tempBuffer(2, pageSize);
+    juce::AudioBuffer<float> trackBuffer(2, pageSize);
+
+    const double startTime = juce::Time::getMillisecondCounterHiRes();
+    int renderedSamples = 0;
+    bool cancelled = false;
+
+    for (size_t i=0; i<slices.size(); i++) {
+        const Slice& slice = slices[i];
+        bool rendered = _renderRange(tracks, pageOneShots, slice.range.getStart(), slice.range.getLength(), tempBuffer, trackBuffer, taskQueueIndex, seekIndex);
+        if (rendered) {
+            std::shared_ptr<PlayBuffer::PageAudio> unusedAudio;
+            const juce::ScopedLock sl (lock);
+            // the buffer is resized for new data only after the index changed
+            rendered = !_isLoadCancelled(taskQueueIndex, seekIndex) && slice.range.getEnd() <= playBuffer.getNumSamples();
+            if (rendered) {
+                unusedAudio = playBuffer.attachPageAudio(pages[slice.pageIndex], std::move(pageAudio[slice.pageIndex]));
+                playBuffer.write(slice.range.getStart(), tempBuffer, 0, slice.range.getLength());
+                if (--remainingSlices[slice.pageIndex] == 0) {
+                    playBuffer.setPageState(pages[slice.pageIndex], PlayBuffer::PageState::RENDERED);
+                }
             }
-            auto listener = trackLoadListener;
-            if (listener) {
-                listener(track.id_,
-                         tempBuffer,
-                         sampleRate);
+        }
+        if (!rendered) {
+            cancelled = true;
+            break;
+        }
+        renderedSamples += slice.range.getLength();
+        if (i == 0 && firstSliceLoaded) {
+            firstSliceLoaded();
+        }
+    }
+
+    if (cancelled) {
+        // partially mixed, load again when needed. Stale pages still play, partly from the new mix.
+        const juce::ScopedLock sl (lock);
+        for (size_t i=0; i<pages.size(); i++) {
+            if (remainingSlices[i] > 0 && playBuffer.getPageState(pages[i]) == PlayBuffer::PageState::LOADING) {
+                playBuffer.setPageState(pages[i], claimedStates[i] == PlayBuffer::PageState::STALE ? PlayBuffer::PageState::STALE : PlayBuffer::PageState::EMPTY);
             }
         }
+        return;
+    }
 
-        for (int i=0; i<2; i++) {
-            playBuffer.addFrom(i, destStartSample, tempBuffer, i, 0, sampleCount, track.volume);
+    loadPolicy.addMeasurement(renderedSamples / sampleRate, juce::Time::getMillisecondCounterHiRes() - startTime);
+}
+
+bool JuceMixPlayer::_renderRange(std::vector<MixerTrack>& tracks,
+                                 const OneShotSampler& oneShots,
+                                 int startSample,
+                                 int numSamples,
+                                 juce::AudioBuffer<float>& output,
+                                 juce::AudioBuffer<float>& trackBuffer,
+                                 int taskQueueIndex,
+                                 int seekIndex) {
+    output.clear(0, numSamples);
+
+    for (MixerTrack& track: tracks) {
+        if (_isLoadCancelled(taskQueueIndex, seekIndex)) return false;
+
+        // repeat tracks are played by `oneShots`
+        if (!track.enabled || !track.reader || track.repeat) {
+            continue;
+        }
+
+        auto res = _calculateRangeToRead(startSample, numSamples, track);
+        if (!res.has_value()) {
+            continue;
+        }
+
+        int dstStart = std::get<0>(res.value());
+        int count = std::get<1>(res.value());
+        juce::int64 readStart = std::get<2>(res.value());
+
+        // mono files are decoded into the first channel only and mixed to both sides in one pass
+        const int trackChannels = juce::jlimit(1, 2, (int)track.reader->numChannels);
+        for (int ch=0; ch<trackChannels; ch++) {
+            trackBuffer.clear(ch, 0, numSamples);
         }
+
+        // read data into track buffer
+        float* const destinations[2] = { trackBuffer.getWritePointer(0, dstStart), trackBuffer.getWritePointer(1, dstStart) };
+        const bool success = track.reader->read(destinations, trackChannels, readStart, count);
+        if (_isLoadCancelled(taskQueueIndex, seekIndex)) return false;
+        if (!success) {
+            std::string err = "Read operation was not success for: " + track.path;
+            _onErrorNotify(err);
+        } else if (dynamic_cast<ResamplingReader*>(track.reader.get()) == nullptr) {
+            // converted readers pass on the file audio themselves
+            waveforms.addDecodedAudio(track.path, *track.reader, trackBuffer, dstStart, count, readStart);
+            loudness.addDecodedAudio(track.path, *track.reader, trackBuffer, dstStart, count, readStart);
+        }
+        std::function<bool(std::string, juce::AudioBuffer<float>&, int)> listener;
+        {
+            const juce::ScopedLock sl (listenersLock);
+            listener = trackLoadListener;
+        }
+        if (listener) {
+            // listeners get stereo
+            if (trackChannels == 1) {
+                trackBuffer.copyFrom(1, 0, trackBuffer, 0, 0, numSamples);
+            }
+            listener(track.id_,
+                     trackBuffer,
+                     sampleRate);
+        }
+
+        MixKernels::addChannels(output, 0, trackBuffer, trackChannels, 0, numSamples, track.volume * track.loudnessGain);
     }
 
-    if (taskQueueIndex != this->taskQueueIndex) return;
-    auto listener = mergeReadyListener;
+    if (_isLoadCancelled(taskQueueIndex, seekIndex)) return false;
+    oneShots.render(output, 0, startSample, numSamples);
+
+    std::function<bool(juce::AudioBuffer<float>&, int)> listener;
+    {
+        const juce::ScopedLock sl (listenersLock);
+        listener = mergeReadyListener;
+    }
     if (listener) {
         for (int i=0; i<2; i++) {
-            tempBuffer.copyFrom(i, 0, playBuffer, i, destStartSample, sampleCount);
+            trackBuffer.copyFrom(i, 0, output, i, 0, numSamples);
         }
-        bool shouldMerge = listener(tempBuffer, sampleRate);
+        bool shouldMerge = listener(trackBuffer, sampleRate);
         if (shouldMerge) {
             for (int i=0; i<2; i++) {
-                playBuffer.addFrom(i, destStartSample, tempBuffer, i, 0, sampleCount, 1.0f);
+                output.addFrom(i, 0, trackBuffer, i, 0, numSamples, 1.0f);
             }
         }
     }
-
-    loadedBlocks.insert(block);
-    loadingBlocks.erase(block);
+    return true;
 }
 
 float JuceMixPlayer::getCurrentTime() {
@@ -549,18 +1567,20 @@ void JuceMixPlayer::exportToFile(const char* outputFile, std::function<void(cons
         completion("Export not supported while playing/recording");
         return;
     }
-    heavyTaskQueue.async([&, outputFile, completion]{
-        _isExporting = true;
-        int total = getDuration() / blockDuration;
-        for (int i=0; i<total; i++) {
-            _loadAudioBlock(i, taskQueueIndex);
+    // a released player drops the export's completion and results, the next owner gets neither
+    const int owner = ownerIndex;
+    auto complete = [&, owner, completion](const char* error) {
+        ++callbacksInFlight;
+        if (owner == ownerIndex) {
+            completion(error);
         }
-        _isExporting = false;
-
-        int targetSampleRate = settings.sampleRate;
+        --callbacksInFlight;
+    };
+    heavyTaskQueue.async([&, outputFile, owner, complete]{
+        // tracks are mixed at the render rate and converted to the rate asked for when the device runs at another one
+        const float renderRate = sampleRate;
+        const int targetSampleRate = settings.sampleRate > 0 ? settings.sampleRate : (int)renderRate;
         juce::File file(outputFile);
-        file.deleteFile();
-        juce::FileOutputStream* outputStream = new juce::FileOutputStream(file);
         std::shared_ptr<juce::AudioFormat> audioFormat;
         std::shared_ptr<juce::AudioFormatWriter> writer;
         if (juce::String(outputFile).toLowerCase().endsWith("wav")) {
@@ -568,22 +1588,200 @@ void JuceMixPlayer::exportToFile(const char* outputFile, std::function<void(cons
         } else if (juce::String(outputFile).toLowerCase().endsWith("flac")) {
             audioFormat.reset(new juce::FlacAudioFormat());
         } else {
-            completion("Failed to export, unsupported file extension");
+            complete("Failed to export, unsupported file extension");
             return;
         }
+        file.deleteFile();
+        juce::FileOutputStream* outputStream = new juce::FileOutputStream(file);
         writer.reset(audioFormat->createWriterFor(outputStream, targetSampleRate, 1, 16, {}, 0));
-        bool success = writer->writeFromAudioSampleBuffer(playBuffer, 0, playBuffer.getNumSamples());
-        completion(success ? "" : "Failed to export");
+
+        _isExporting = true;
+        std::vector<MixerTrack> tracks;
+        {
+            const juce::ScopedLock sl (mixerDataLock);
+            tracks = mixerData.tracks;
+        }
+        MixerMetronome metronome;
+        {
+            const juce::ScopedLock sl (mixerDataLock);
+            metronome = mixerData.metronome;
+        }
+        // tracks playback has not measured yet are measured now, before anything is written
+        for (MixerTrack& track: tracks) {
+            track.loudnessGain = _getLoudnessGain(track.path, true);
+        }
+        // the audio callback plays repeat tracks and the metronome, export mixes them in
+        const OneShotSampler exportOneShots = _createOneShots(tracks, metronome);
+        // measures what is written
+        LoudnessMeter meter(targetSampleRate, writer ? (int)writer->getNumChannels() : 1);
+        // mixed straight into the writer, the play buffer only keeps what playback needs
+        const int numSamples = getDuration() * renderRate;
+        const int blockSamples = maxBlockDuration * renderRate;
+        juce::AudioBuffer<float> output(2, blockSamples);
+        juce::AudioBuffer<float> trackBuffer(2, blockSamples);
+        bool success = writer != nullptr;
+        if (targetSampleRate == (int)renderRate) {
+            for (int start=0; success && start<numSamples; start+=blockSamples) {
+                const int count = std::min(blockSamples, numSamples - start);
+                success = _renderRange(tracks, exportOneShots, start, count, output, trackBuffer, taskQueueIndex, -1)
+                && writer->writeFromAudioSampleBuffer(output, 0, count);
+                meter.process(output, 0, count);
+            }
+        } else {
+            // streamed through one resampler, `pending` holds the mix it hasn't consumed yet
+            const int numOutputSamples = getDuration() * targetSampleRate;
+            const int outputBlockSamples = maxBlockDuration * targetSampleRate;
+            SincResampler converter;
+            // off the audio thread, the best quality
+            converter.prepare(2, renderRate / targetSampleRate, 2, outputBlockSamples);
+            // the first taps read silence before the mix
+            const int historySize = SincResampler::getNumTaps(2) / 2 - 1;
+            converter.reset(historySize);
+            juce::AudioBuffer<float> pending(2, blockSamples + converter.getNumInputSamplesNeeded(outputBlockSamples));
+            pending.clear();
+            int pendingCount = historySize;
+            juce::AudioBuffer<float> converted(2, outputBlockSamples);
+            int written = 0;
+            for (int start=0; success && written<numOutputSamples; start+=blockSamples) {
+                const int count = std::clamp(numSamples - start, 0, blockSamples);
+                if (count > 0) {
+                    success = _renderRange(tracks, exportOneShots, start, count, output, trackBuffer, taskQueueIndex, -1);
+                    for (int ch=0; ch<2; ch++) {
+                        pending.copyFrom(ch, pendingCount, output, ch, 0, count);
+                    }
+                    pendingCount += count;
+                } else {
+                    // past the end of the mix, silence for the last taps
+                    const int needed = converter.getNumInputSamplesNeeded(std::min(outputBlockSamples, numOutputSamples - written));
+                    if (needed > pendingCount) {
+                        pending.clear(pendingCount, needed - pendingCount);
+                        pendingCount = needed;
+                    }
+                }
+                while (success && written < numOutputSamples) {
+                    const int outputCount = std::min(outputBlockSamples, numOutputSamples - written);
+                    if (converter.getNumInputSamplesNeeded(outputCount) > pendingCount) {
+                        break;
+                    }
+                    const int consumed = converter.process(pending.getArrayOfReadPointers(), converted.getArrayOfWritePointers(), 2, outputCount);
+                    pendingCount -= consumed;
+                    for (int ch=0; ch<2; ch++) {
+                        float* data = pending.getWritePointer(ch);
+                        std::memmove(data, data + consumed, sizeof(float) * pendingCount);
+                    }
+                    success = writer->writeFromAudioSampleBuffer(converted, 0, outputCount);
+                    meter.process(converted, 0, outputCount);
+                    written += outputCount;
+                }
+            }
+        }
+        writer.reset();
+        if (success) {
+            meter.flush();
+            const juce::ScopedLock sl (lock);
+            // a later owner's `_resetInPlace` would not clear it
+            if (owner == ownerIndex) {
+                mixLoudness = LoudnessMeter::getLoudness(meter.getSegments());
+                hasMixLoudness = true;
+            }
+        }
+        _isExporting = false;
+        complete(success ? "" : "Failed to export");
     });
 }
 
+// MARK: Offline rendering
+
+MixerRenderStats JuceMixPlayer::renderOffline(const char* json, const char* outputPath) {
+    MixerRenderStats stats;
+
+    double time = juce::Time::getMillisecondCounterHiRes();
+    mixerData = MixerModel::parse(json);
+    stats.parseTime = juce::Time::getMillisecondCounterHiRes() - time;
+
+    time = juce::Time::getMillisecondCounterHiRes();
+    _createFileReadersAndTotalDuration();
+    stats.openReadersTime = juce::Time::getMillisecondCounterHiRes() - time;
+
+    playBuffer.clear();
+
+    // full size blocks, the last one can be partial
+    const int blockPages = _getPageCount(maxBlockDuration);
+    const int total = (playBuffer.getNumPages() + blockPages - 1) / blockPages;
+
+    time = juce::Time::getMillisecondCounterHiRes();
+    for (int i=0; i<total; i++) {
+        const double blockTime = juce::Time::getMillisecondCounterHiRes();
+        _loadAudioBlock(i * blockPages, blockPages, taskQueueIndex);
+        const double elapsed = juce::Time::getMillisecondCounterHiRes() - blockTime;
+        stats.blockTimeMin = i == 0 ? elapsed : std::min(stats.blockTimeMin, elapsed);
+        stats.blockTimeMax = std::max(stats.blockTimeMax, elapsed);
+    }
+    stats.renderTime = juce::Time::getMillisecondCounterHiRes() - time;
+
+    stats.duration = getDuration();
+    stats.sampleRate = sampleRate;
+    stats.blocks = total;
+    stats.blockTimeAvg = total > 0 ? stats.renderTime / total : 0;
+    stats.realtimeFactor = stats.renderTime > 0 ? stats.duration * 1000 / stats.renderTime : 0;
+
+    {
+        LoudnessMeter meter(sampleRate, playBuffer.getNumChannels());
+        juce::AudioBuffer<float> page(playBuffer.getNumChannels(), playBuffer.getPageSize());
+        for (int i=0; i<playBuffer.getNumPages(); i++) {
+            const juce::Range<int> range = playBuffer.getPageRange(i);
+            playBuffer.read(range.getStart(), page, 0, range.getLength());
+            meter.process(page, 0, range.getLength());
+        }
+        meter.flush();
+        stats.loudness = LoudnessMeter::getLoudness(meter.getSegments());
+        const juce::ScopedLock sl (lock);
+        mixLoudness = stats.loudness;
+        hasMixLoudness = true;
+    }
+
+    if (outputPath == nullptr) {
+        return stats;
+    }
+
+    time = juce::Time::getMillisecondCounterHiRes();
+    juce::File file(outputPath);
+    file.deleteFile();
+    std::unique_ptr<juce::AudioFormat> audioFormat;
+    if (juce::String(outputPath).toLowerCase().endsWith("wav")) {
+        audioFormat.reset(new juce::WavAudioFormat());
+    } else if (juce::String(outputPath).toLowerCase().endsWith("flac")) {
+        audioFormat.reset(new juce::FlacAudioFormat());
+    } else {
+        throw std::runtime_error("unsupported file extension: " + std::string(outputPath));
+    }
+    juce::FileOutputStream* outputStream = new juce::FileOutputStream(file);
+    std::unique_ptr<juce::AudioFormatWriter> writer(audioFormat->createWriterFor(outputStream, sampleRate, playBuffer.getNumChannels(), 16, {}, 0));
+    if (!writer) {
+        delete outputStream;
+        throw std::runtime_error("unable to create writer for: " + std::string(outputPath));
+    }
+    juce::AudioBuffer<float> page(playBuffer.getNumChannels(), playBuffer.getPageSize());
+    for (int i=0; i<playBuffer.getNumPages(); i++) {
+        const juce::Range<int> range = playBuffer.getPageRange(i);
+        playBuffer.read(range.getStart(), page, 0, range.getLength());
+        if (!writer->writeFromAudioSampleBuffer(page, 0, range.getLength())) {
+            throw std::runtime_error("failed to write: " + std::string(outputPath));
+        }
+    }
+    writer.reset();
+    stats.writeTime = juce::Time::getMillisecondCounterHiRes() - time;
+
+    return stats;
+}
+
 // MARK: Recorder
 
 void JuceMixPlayer::prepareRecorder(const char *file) {
     std::string path(file);
     taskQueue.async([&, path]{
         if (_isRecording) {
-            if (onRecErrorCallback) onRecErrorCallback(this, "Failed to prepare recorder, stop recorder first");
+            if (auto callback = _holdCallback(onRecErrorCallback)) callback(this, returnCopyChar("Failed to prepare recorder, stop recorder first"));
             return;
         }
         recordPath = path;
@@ -595,14 +1793,14 @@ void JuceMixPlayer::startRecorder() {
     if (_isRecording) return;
     juce::MessageManager::getInstanceWithoutCreating()->callAsync([&]{
         if (!_isRecorderPrepared) {
-            if (onRecErrorCallback) onRecErrorCallback(this, "Failed to start recording, prepare not called");
+            if (auto callback = _holdCallback(onRecErrorCallback)) callback(this, returnCopyChar("Failed to start recording, prepare not called"));
             _onRecStateUpdateNotify(JuceMixPlayerRecState::ERROR);
             return;
         }
 
         bool success = setAudioSessionRecord(this->settings);
         if (!success) {
-            if (onRecErrorCallback) onRecErrorCallback(this, "Failed to start system audio session");
+            if (auto callback = _holdCallback(onRecErrorCallback)) callback(this, returnCopyChar("Failed to start system audio session"));
             _onRecStateUpdateNotify(JuceMixPlayerRecState::ERROR);
             return;
         }
@@ -618,7 +1816,7 @@ void JuceMixPlayer::startRecorder() {
 
         success = setAudioSessionRecord(this->settings);
         if (!success) {
-            if (onRecErrorCallback) onRecErrorCallback(this, "Failed to start system audio session");
+            if (auto callback = _holdCallback(onRecErrorCallback)) callback(this, returnCopyChar("Failed to start system audio session"));
             _onRecStateUpdateNotify(JuceMixPlayerRecState::ERROR);
             return;
         }
@@ -643,7 +1841,11 @@ void JuceMixPlayer::stopRecorder() {
     juce::MessageManager::getInstanceWithoutCreating()->callAsync([&]{
         if (_isRecording) {
             this->outputLatencyInSamples = deviceManager->getCurrentAudioDevice()->getOutputLatencyInSamples();
-            PRINT("getDeviceLatencyInfo: " << getDeviceLatencyInfo());
+            if (enableLogsValue) {
+                const char* latencyInfo = getDeviceLatencyInfo();
+                PRINT("getDeviceLatencyInfo: " << latencyInfo);
+                freeCopyChar(latencyInfo);
+            }
             stop();
             _stopProgressTimer();
             _isRecording = false;
@@ -660,7 +1862,7 @@ void JuceMixPlayer::_createWriterForRecorder() {
     PRINT("recordPath: " << recordPath);
     _resetRecorder();
     if (deviceSampleRate == 0) {
-        if (onRecErrorCallback) onRecErrorCallback(this, "deviceSampleRate is 0");
+        if (auto callback = _holdCallback(onRecErrorCallback)) callback(this, returnCopyChar("deviceSampleRate is 0"));
         _onRecStateUpdateNotify(JuceMixPlayerRecState::ERROR);
         return;
     }
@@ -677,7 +1879,7 @@ void JuceMixPlayer::_createWriterForRecorder() {
     } else if (juce::String(recordPath).toLowerCase().endsWith("flac")) {
         recAudioFormat.reset(new juce::FlacAudioFormat());
     } else {
-        if (onRecErrorCallback) onRecErrorCallback(this, "unsupported file extension");
+        if (auto callback = _holdCallback(onRecErrorCallback)) callback(this, returnCopyChar("unsupported file extension"));
         _onRecStateUpdateNotify(JuceMixPlayerRecState::ERROR);
         return;
     }
@@ -694,6 +1896,8 @@ void JuceMixPlayer::_resetRecorder() {
 }
 
 void JuceMixPlayer::_finishRecording() {
+    // full buffers the callback posted are written first
+    events.flush();
     recWriteTaskQueue.async([&]{
         juce::AudioBuffer<float>& buff = recordBufferSelect == 0 ? recordBuffer1 : recordBuffer2;
         flushRecordBufferToFile(buff, recordHeadIndex);
@@ -705,8 +1909,8 @@ void JuceMixPlayer::_finishRecording() {
 
 void JuceMixPlayer::flushRecordBufferToFile(juce::AudioBuffer<float>& buffer, int sampleCount) {
     if (!recWriter) {
-        if (onRecErrorCallback)
-            onRecErrorCallback(this, "Failed to write file, writer not created");
+        if (auto callback = _holdCallback(onRecErrorCallback))
+            callback(this, returnCopyChar("Failed to write file, writer not created"));
         _onRecStateUpdateNotify(JuceMixPlayerRecState::ERROR);
         return;
     }
@@ -764,16 +1968,18 @@ void JuceMixPlayer::flushRecordBufferToFile(juce::AudioBuffer<float>& buffer, in
     if (!success) {
         stopRecorder();
         _onRecStateUpdateNotify(JuceMixPlayerRecState::ERROR);
-        if (onRecErrorCallback)
-            onRecErrorCallback(this, "Failed to write file");
+        if (auto callback = _holdCallback(onRecErrorCallback))
+            callback(this, returnCopyChar("Failed to write file"));
     }
 }
 
 void JuceMixPlayer::_onRecStateUpdateNotify(JuceMixPlayerRecState state) {
-    if (onRecStateUpdateCallback != nullptr) {
+    transport.recState = (juce::int32)state;
+    transport.sequence++;
+    if (auto callback = _holdCallback(onRecStateUpdateCallback)) {
         if (currentRecState != state) {
             currentRecState = state;
-            onRecStateUpdateCallback(this, returnCopyCharDelete(JuceMixPlayerRecState_toString(state)));
+            callback(this, returnCopyChar(JuceMixPlayerRecState_toString(state)));
         }
     }
 }
@@ -782,15 +1988,34 @@ void JuceMixPlayer::_onRecStateUpdateNotify(JuceMixPlayerRecState state) {
 void JuceMixPlayer::setTrackLoadListener(std::function<bool(std::string trackId,
                                                             juce::AudioBuffer<float>& buffer,
                                                             int sampleRate)> closure) {
+    const juce::ScopedLock sl (listenersLock);
     this->trackLoadListener = closure;
 }
 
 void JuceMixPlayer::setMergeReadyListener(std::function<bool(juce::AudioBuffer<float>& buffer,
                                                              int sampleRate)> closure) {
+    const juce::ScopedLock sl (listenersLock);
     this->mergeReadyListener = closure;
 }
 
+void JuceMixPlayer::setReaderFactory(std::function<juce::AudioFormatReader*(const juce::File& file)> closure) {
+    const juce::ScopedLock sl (listenersLock);
+    this->readerFactory = closure;
+}
+
 // MARK: Device management
+void JuceMixPlayer::setAudioDeviceManager(juce::AudioDeviceManager* manager) {
+    deviceManager = manager;
+}
+
+void JuceMixPlayer::setSharedOutputBus(bool enabled) {
+    useSharedBus = enabled;
+}
+
+void JuceMixPlayer::setBusGain(float gain) {
+    busGain = gain;
+}
+
 void JuceMixPlayer::notifyDeviceUpdates() {
     MixerDeviceList list;
 
@@ -839,8 +2064,8 @@ void JuceMixPlayer::notifyDeviceUpdates() {
         if (!(deviceList == list)) {
             deviceList = list;
             nlohmann::json j = list;
-            if (onDeviceUpdateCallback)
-                onDeviceUpdateCallback(this, returnCopyCharDelete(j.dump(4)));
+            if (auto callback = _holdCallback(onDeviceUpdateCallback))
+                callback(this, returnCopyChar(j.dump(4)));
         }
     });
 }
@@ -919,7 +2144,100 @@ const char* JuceMixPlayer::getDeviceLatencyInfo() {
     info.timeDiff = info.bufferLatency * 5.6;
 
     nlohmann::json j = info;
-    return returnCopyCharDelete(j.dump(4));
+    return returnCopyChar(j.dump(4));
+}
+
+// MARK: Buffering
+
+const char* JuceMixPlayer::getBufferedRanges() {
+    MixerBufferedRanges info;
+    {
+        const juce::ScopedLock sl (lock);
+        info.duration = playBuffer.getNumSamples() / sampleRate;
+        // neighbouring pages with the same state are one range
+        int previousPage = -2;
+        for (int page=0; page<playBuffer.getNumPages(); page++) {
+            MixerBufferState state;
+            switch (playBuffer.getPageState(page)) {
+                // stale pages play until they are rendered again
+                case PlayBuffer::PageState::RENDERED:
+                case PlayBuffer::PageState::STALE: state = MixerBufferState::RENDERED; break;
+                case PlayBuffer::PageState::LOADING: state = MixerBufferState::LOADING; break;
+                case PlayBuffer::PageState::EVICTED: state = MixerBufferState::EVICTED; break;
+                default: continue;
+            }
+            const juce::Range<int> range = playBuffer.getPageRange(page);
+            if (previousPage != page - 1 || info.ranges.back().state != state) {
+                MixerBufferedRange bufferedRange;
+                bufferedRange.start = range.getStart() / sampleRate;
+                bufferedRange.state = state;
+                info.ranges.push_back(bufferedRange);
+            }
+            info.ranges.back().end = range.getEnd() / sampleRate;
+            previousPage = page;
+        }
+    }
+    nlohmann::json j = info;
+    return returnCopyChar(j.dump(4));
+}
+
+// MARK: Levels
+
+int JuceMixPlayer::readLevels(float* output, int maxFrames) {
+    return levelStream.read(output, maxFrames);
+}
+
+const TransportState& JuceMixPlayer::getTransport() const {
+    return transport;
+}
+
+// MARK: Waveform
+
+int JuceMixPlayer::getWaveform(const char* path, float startTime, float endTime, int numPoints, float* output) {
+    {
+        // before asking, the build can finish before `getPeaks` returns
+        const juce::ScopedLock sl (readyRequestsLock);
+        waveformRequests.insert(path);
+    }
+    return waveforms.getPeaks(path, startTime, endTime, numPoints, output);
+}
+
+void JuceMixPlayer::setWaveformCacheDir(const char* path) {
+    waveforms.setCacheDirectory(juce::File(path));
+    loudness.setCacheDirectory(juce::File(path));
+}
+
+// MARK: Loudness
+
+static void writeLoudness(const MixerLoudness& value, float* output) {
+    output[0] = value.integrated;
+    output[1] = value.maxMomentary;
+    output[2] = value.maxShortTerm;
+    output[3] = value.loudnessRange;
+    output[4] = value.truePeak;
+}
+
+int JuceMixPlayer::getLoudness(const char* path, float* output) {
+    {
+        // before asking, the measurement can finish before `getLoudness` returns
+        const juce::ScopedLock sl (readyRequestsLock);
+        loudnessRequests.insert(path);
+    }
+    MixerLoudness value;
+    const int status = loudness.getLoudness(path, value);
+    if (status == 1) {
+        writeLoudness(value, output);
+    }
+    return status;
+}
+
+int JuceMixPlayer::getMixLoudness(float* output) {
+    const juce::ScopedLock sl (lock);
+    if (!hasMixLoudness) {
+        return 0;
+    }
+    writeLoudness(mixLoudness, output);
+    return 1;
 }
 
 // MARK: AudioIODeviceCallback
@@ -929,6 +2247,23 @@ void JuceMixPlayer::audioDeviceAboutToStart(juce::AudioIODevice *device) {
     }
     this->deviceSampleRate = device->getCurrentSampleRate();
     this->samplesPerBlockExpected = device->getCurrentBufferSizeSamples();
+    std::unique_ptr<SincResampler> newResampler = _createResampler(settings.resamplerQuality, sampleRate);
+    {
+        const juce::ScopedLock sl (lock);
+        _swapResampler(newResampler);
+    }
+    // the recorder reopens the device with inputs, possibly at a call rate such as 16k,
+    // the timeline stays at the rate of the output device it was chosen for
+    const bool outputChanged = device->getActiveInputChannels().countNumberOfSetBits() == 0
+    && (device->getName() != renderDeviceName || renderRateRequested.exchange(false));
+    if (attachToAudioDevice && outputChanged) {
+        renderDeviceName = device->getName();
+        // the callback resamples until the timeline is mixed at the device rate
+        const float rate = (float)deviceSampleRate;
+        taskQueue.async([this, rate] {
+            _setRenderRate(rate);
+        });
+    }
 
     PRINT("audioDeviceAboutToStart" <<
           ", bufferSizeSamples: " << samplesPerBlockExpected <<
@@ -942,6 +2277,15 @@ void JuceMixPlayer::audioDeviceIOCallbackWithContext(const float *const *inputCh
                                                      int numOutputChannels,
                                                      int numSamples,
                                                      const juce::AudioIODeviceCallbackContext &context) {
+    const bool audible = _processCallback(inputChannelData, numInputChannels, outputChannelData, numOutputChannels, numSamples);
+    _publishTransport(inputChannelData, numInputChannels, outputChannelData, numOutputChannels, numSamples, audible);
+}
+
+bool JuceMixPlayer::_processCallback(const float* const* inputChannelData,
+                                     int numInputChannels,
+                                     float* const* outputChannelData,
+                                     int numOutputChannels,
+                                     int numSamples) {
     if (deviceCallbackTime2 > 99999) {
         deviceCallbackTime2 = _getEpochTime() - deviceCallbackTime2;
     }
@@ -949,11 +2293,15 @@ void JuceMixPlayer::audioDeviceIOCallbackWithContext(const float *const *inputCh
     bool enterPlayerBlock = !_isSeeking && _isPlayingInternal && _isPlaying && numOutputChannels > 0;
 
     if (deviceSampleRate <= 0) {
-        return;
+        return false;
     }
 
     const juce::ScopedLock sl (lock);
 
+    // prepared off the audio thread whenever the rates or the quality change, it allocates.
+    // Silence in between, e.g. while a device restart is reported to the task queue.
+    enterPlayerBlock = enterPlayerBlock && resampler->isPrepared(settings.resamplerQuality, sampleRate/deviceSampleRate);
+
     if (_isRecording && numInputChannels > 0) {
         juce::AudioBuffer<float>& buff = recordBufferSelect == 0 ? recordBuffer1 : recordBuffer2;
         float* writer = buff.getWritePointer(0, recordHeadIndex);
@@ -962,10 +2310,7 @@ void JuceMixPlayer::audioDeviceIOCallbackWithContext(const float *const *inputCh
         recordTimerIndex += numSamples;
 
         if (recordHeadIndex > recordBufferDuration * deviceSampleRate) {
-            int sampleCount = recordHeadIndex;
-            recWriteTaskQueue.async([&, sampleCount]{
-                flushRecordBufferToFile(buff, sampleCount);
-            });
+            events.post({ EventChannel::Type::RECORD_BUFFER, recordHeadIndex, recordBufferSelect });
             recordHeadIndex = 0;
             recordBufferSelect = 1 - recordBufferSelect;
         }
@@ -974,56 +2319,159 @@ void JuceMixPlayer::audioDeviceIOCallbackWithContext(const float *const *inputCh
     if (enterPlayerBlock) {
         float speedRatio = sampleRate/deviceSampleRate;
         float readCount = (float)numSamples * speedRatio;
-
-        if (playHeadIndex + readCount > playBuffer.getNumSamples()) {
-            if (playBuffer.getNumSamples() == 0) {
-                _onStateUpdateNotify(JuceMixPlayerState::IDLE);
-            } else {
-                _onProgressNotify(1);
-                _onStateUpdateNotify(JuceMixPlayerState::COMPLETED);
-
-                if (_isRecording && settings.stopRecOnPlaybackComplete) {
-                    stopRecorder();
-                }
-            }
-
-            if (!_isRecording && settings.loop) {
-                _isPlaying = false;
-                playHeadIndex = 0;
-                play();
-            } else {
-                _pauseInternal(false);
-            }
-            return;
+        // looping wraps inside the callback at sample precision, the end of the loop never reaches the device
+        const juce::Range<int> loopRange = _getLoopRange(playHeadIndex);
+
+        // the timeline ends in this block, what is left of it is played and the rest is silence
+        const bool ended = loopRange.isEmpty() && playHeadIndex + readCount > playBuffer.getNumSamples();
+        const int outputCount = ended
+        ? juce::jlimit(0, numSamples, (int)(std::max(0, playBuffer.getNumSamples() - playHeadIndex) / speedRatio))
+        : numSamples;
+
+        // the resampler reads half its taps past `readCount`, pages that are not rendered read as silence
+        const int copyCount = resampler->getNumInputSamplesNeeded(outputCount);
+        if (callbackBuffer.getNumSamples() < copyCount) {
+            callbackBuffer.setSize(2, copyCount, false, false, true);
         }
-
-        for (int ch=0; ch<numOutputChannels; ch++) {
-            interpolator[ch].process(speedRatio,
-                                     playBuffer.getReadPointer(ch, playHeadIndex),
-                                     outputChannelData[ch],
-                                     numSamples);
+        _readCallbackBuffer(playHeadIndex, copyCount, loopRange);
+
+        // mono devices get the left channel, channels after the stereo pair repeat the right one
+        const int consumed = outputCount > 0 ? resampler->process(callbackBuffer.getArrayOfReadPointers(),
+                                                                 outputChannelData,
+                                                                 std::min(numOutputChannels, 2),
+                                                                 outputCount) : 0;
+        for (int ch=0; ch<std::min(numOutputChannels, 2); ch++) {
+            juce::FloatVectorOperations::clear(outputChannelData[ch] + outputCount, numSamples - outputCount);
+        }
+        for (int ch=2; ch<numOutputChannels; ch++) {
+            juce::FloatVectorOperations::copy(outputChannelData[ch], outputChannelData[1], numSamples);
         }
 
-        playHeadIndex += readCount;
+        // what the resampler consumed, its fractional position carries over so nothing drifts
+        playHeadIndex += consumed;
+        if (!loopRange.isEmpty() && playHeadIndex >= loopRange.getEnd()) {
+            playHeadIndex = loopRange.getStart() + (playHeadIndex - loopRange.getStart()) % loopRange.getLength();
+        }
 
-        // load next block in advance
-        _loadAudioBlockSafe((getCurrentTime()/blockDuration)+1, false, []{});
+        if (ended) {
+            // stops right here, the notifications and the rest of the pause run on `taskQueue`
+            playHeadIndex = std::min(playHeadIndex, playBuffer.getNumSamples());
+            _isPlaying = false;
+            _isPlayingInternal = false;
+            const JuceMixPlayerState state = playBuffer.getNumSamples() == 0 ? JuceMixPlayerState::IDLE : JuceMixPlayerState::COMPLETED;
+            events.post({ EventChannel::Type::ENDED, (juce::int32)state });
+        } else if (!prefetchQueued.exchange(true)) {
+            // keeps the look-ahead filled, sized by the measured render speed
+            events.post({ EventChannel::Type::PREFETCH });
+        }
     } else {
         for (int ch=0; ch<numOutputChannels; ch++) {
             juce::zeromem(outputChannelData[ch], (size_t) numSamples * sizeof (float));
         }
     }
 
-    if (_isRecording && numInputChannels > 0 && settings.enableMicMonitoring) {
+    const bool monitoring = _isRecording && numInputChannels > 0 && settings.enableMicMonitoring;
+    if (monitoring) {
         juce::AudioBuffer<float> outData(outputChannelData, numOutputChannels, numSamples);
         for (int ch=0; ch<numOutputChannels; ch++) {
             outData.addFrom(ch, 0, inputChannelData[0], numSamples);
         }
     }
 
+    levelStream.process(numInputChannels > 0 ? inputChannelData[0] : nullptr,
+                        outputChannelData,
+                        numOutputChannels,
+                        numSamples,
+                        (int)std::lround(settings.levelFrameDuration * deviceSampleRate));
+
     if (enterPlayerBlock && playBufferTime > 99999) {
         playBufferTime = _getEpochTime() - playBufferTime;
     }
+    return enterPlayerBlock || monitoring;
+}
+
+void JuceMixPlayer::_publishTransport(const float* const* input,
+                                      int numInputChannels,
+                                      const float* const* output,
+                                      int numOutputChannels,
+                                      int numSamples,
+                                      bool audible) {
+    auto peak = [numSamples](const float* samples) {
+        const juce::Range<float> range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+        return std::max(-range.getStart(), range.getEnd());
+    };
+    float outputLevel = 0;
+    for (int ch=0; audible && ch<std::min(numOutputChannels, 2); ch++) {
+        outputLevel = std::max(outputLevel, peak(output[ch]));
+    }
+    transport.inputLevel = input != nullptr && numInputChannels > 0 ? peak(input[0]) : 0.0f;
+    transport.outputLevel = outputLevel;
+    transport.playHead = playHeadIndex;
+    transport.duration = playBuffer.getNumSamples();
+    transport.sampleRate = sampleRate.load();
+    transport.recordedSamples = recordTimerIndex;
+    transport.recordSampleRate = deviceSampleRate;
+    transport.sequence++;
+}
+
+// MARK: MixBus::Source
+void JuceMixPlayer::busAboutToStart(juce::AudioIODevice* device) {
+    audioDeviceAboutToStart(device);
+}
+
+bool JuceMixPlayer::busProcess(const float* const* input,
+                               int numInputChannels,
+                               float* const* output,
+                               int numOutputChannels,
+                               int numSamples) {
+    // idle and paused players write nothing, the bus skips them without taking `lock`
+    const bool audible = (_isPlaying || _isRecording)
+    && _processCallback(input, numInputChannels, output, numOutputChannels, numSamples);
+    _publishTransport(input, numInputChannels, output, numOutputChannels, numSamples, audible);
+    return audible;
+}
+
+float JuceMixPlayer::getBusGain() const {
+    return busGain;
+}
+
+std::unique_ptr<SincResampler> JuceMixPlayer::_createResampler(int quality, float renderRate) {
+    auto newResampler = std::make_unique<SincResampler>();
+    if (deviceSampleRate > 0) {
+        newResampler->prepare(quality, renderRate / deviceSampleRate, 2, std::max(samplesPerBlockExpected, 1));
+    }
+    return newResampler;
+}
+
+void JuceMixPlayer::_swapResampler(std::unique_ptr<SincResampler>& newResampler) {
+    std::swap(resampler, newResampler);
+    if (deviceSampleRate > 0 && !resampler->isPrepared(settings.resamplerQuality, sampleRate / deviceSampleRate)) {
+        // the device restarted while it was built, rare enough to allocate under the lock
+        resampler->prepare(settings.resamplerQuality, sampleRate / deviceSampleRate, 2, std::max(samplesPerBlockExpected, 1));
+    }
+    callbackBuffer.setSize(2, resampler->getNumInputSamplesNeeded(std::max(samplesPerBlockExpected, 1)) + 1);
+}
+
+void JuceMixPlayer::_readCallbackBuffer(int startSample, int numSamples, juce::Range<int> loopRange) {
+    int position = 0;
+    int sample = startSample;
+    while (position < numSamples) {
+        const bool wraps = !loopRange.isEmpty() && sample < loopRange.getEnd();
+        const int count = wraps ? std::min(numSamples - position, loopRange.getEnd() - sample) : numSamples - position;
+        playBuffer.read(sample, callbackBuffer, position, count);
+        _addOneShots(sample, position, count);
+        position += count;
+        sample = wraps && sample + count == loopRange.getEnd() ? loopRange.getStart() : sample + count;
+    }
+}
+
+void JuceMixPlayer::_addOneShots(int startSample, int outputStart, int numSamples) {
+    // metronome clicks and other repeat tracks, sample accurate on the timeline. Headless players have them in the pages.
+    // They don't depend on the pages, so they are heard while the seek point is still loading too.
+    const int count = std::min(startSample + numSamples, playBuffer.getNumSamples()) - startSample;
+    if (attachToAudioDevice && count > 0) {
+        oneShots.render(callbackBuffer, outputStart, startSample, count);
+    }
 }
 
 void JuceMixPlayer::audioDeviceError(const juce::String &errorMessage) {
@@ -1036,21 +2484,90 @@ void JuceMixPlayer::audioDeviceStopped() {
 
 // MARK: juce::Timer
 void JuceMixPlayer::timerCallback() {
-    taskQueue.async([&]{
-        if (!_isSeeking && _isPlayingInternal && _isPlaying && playBuffer.getNumSamples() > 0) {
-            _onProgressNotify((float)playHeadIndex / (float)playBuffer.getNumSamples());
+    // delivered by the dispatcher, ticks it hasn't delivered yet are replaced
+    if (!_isSeeking && _isPlayingInternal && _isPlaying && playBuffer.getNumSamples() > 0) {
+        events.setLatest(EventChannel::Value::PROGRESS, (float)playHeadIndex / (float)playBuffer.getNumSamples());
+    }
+    if (_isRecording) {
+        events.setLatest(EventChannel::Value::REC_PROGRESS, (float)recordTimerIndex / (float)deviceSampleRate);
+        if (onRecLevelCallback) {
+            events.setLatest(EventChannel::Value::REC_LEVEL, juce::Decibels::gainToDecibels((float)inputLevelMeter->getCurrentLevel()));
         }
-        if (_isRecording) {
-            if (onRecProgressCallback) {
-                onRecProgressCallback(this, (float)recordTimerIndex / (float)deviceSampleRate);
-            }
-            if (onRecLevelCallback) {
-                const float level = inputLevelMeter->getCurrentLevel();
-                const float levelInDb = juce::Decibels::gainToDecibels(level);
-                onRecLevelCallback(this, levelInDb);
-            }
+    }
+}
+
+void JuceMixPlayer::_onEvent(const EventChannel::Event& event) {
+    switch (event.type) {
+        case EventChannel::Type::ENDED: {
+            const JuceMixPlayerState state = (JuceMixPlayerState)event.value;
+            taskQueue.async([&, state, owner = ownerIndex.load()]{
+                if (owner != ownerIndex) {
+                    return;
+                }
+                if (state == JuceMixPlayerState::COMPLETED) {
+                    _onProgressNotify(1);
+                }
+                _onStateUpdateNotify(state);
+                if (state == JuceMixPlayerState::COMPLETED && _isRecording && settings.stopRecOnPlaybackComplete) {
+                    stopRecorder();
+                }
+                // the rest of `_pauseInternal`, the callback already stopped playing
+                _stopProgressTimer();
+                _onStateUpdateNotify(JuceMixPlayerState::PAUSED);
+            });
+            break;
         }
-    });
+        case EventChannel::Type::RECORD_BUFFER: {
+            juce::AudioBuffer<float>& buff = event.index == 0 ? recordBuffer1 : recordBuffer2;
+            const int sampleCount = event.value;
+            recWriteTaskQueue.async([&, sampleCount]{
+                flushRecordBufferToFile(buff, sampleCount);
+            });
+            break;
+        }
+        case EventChannel::Type::PREFETCH:
+            // `prefetchQueued` was set by the callback
+            heavyTaskQueue.async([&] {
+                prefetchQueued = false;
+                _prefetch();
+            });
+            break;
+        case EventChannel::Type::WAVEFORM_READY: {
+            auto callback = _holdCallback(onWaveformReadyCallback);
+            if (callback && _takeReadyRequest(waveformRequests, event.text))
+                callback(this, returnCopyChar(event.text));
+            break;
+        }
+        case EventChannel::Type::LOUDNESS_READY: {
+            auto callback = _holdCallback(onLoudnessReadyCallback);
+            if (callback && _takeReadyRequest(loudnessRequests, event.text))
+                callback(this, returnCopyChar(event.text));
+            const std::string path = event.text;
+            taskQueue.async([this, path]{
+                _onLoudnessReady(path);
+            });
+            break;
+        }
+    }
+}
+
+bool JuceMixPlayer::_takeReadyRequest(std::set<std::string>& requests, const std::string& path) {
+    const juce::ScopedLock sl (readyRequestsLock);
+    return requests.erase(path) > 0;
+}
+
+void JuceMixPlayer::_onEventValue(EventChannel::Value value, float amount) {
+    switch (value) {
+        case EventChannel::Value::PROGRESS:
+            _onProgressNotify(amount);
+            break;
+        case EventChannel::Value::REC_PROGRESS:
+            if (auto callback = _holdCallback(onRecProgressCallback)) callback(this, amount);
+            break;
+        case EventChannel::Value::REC_LEVEL:
+            if (auto callback = _holdCallback(onRecLevelCallback)) callback(this, amount);
+            break;
+    }
 }
 
 void JuceMixPlayer::changeListenerCallback(juce::ChangeBroadcaster* source) {
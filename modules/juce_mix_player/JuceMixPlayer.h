@@ -5,18 +5,52 @@
 #include "TaskQueue.h"
 #include "Models.h"
 #include "Models.h"
+#include "PlayBuffer.h"
+#include "LoadPolicy.h"
+#include "WaveformCache.h"
+#include "LevelStream.h"
+#include "LoudnessCache.h"
+#include "OneShotSampler.h"
+#include "SincResampler.h"
+#include "ResamplingReader.h"
+#include "MixKernels.h"
+#include "BlockCodec.h"
+#include "MixBus.h"
+#include "TransportState.h"
+#include "EventChannel.h"
 #include <iostream>
 #include <tuple>
+#include <set>
 
-class JuceMixPlayer : private juce::Timer, public juce::AudioIODeviceCallback, public juce::ChangeListener
+class JuceMixPlayer : private juce::Timer, public juce::AudioIODeviceCallback, public juce::ChangeListener, private MixBus::Source
 {
 private:
 
-    inline static juce::AudioDeviceManager* deviceManager;
+    // benchmarks in tools/juce_mix_bench drive the internals directly
+    friend struct JuceMixPlayerBenchmark;
 
+    inline static juce::AudioDeviceManager* deviceManager;
+    // players created while `useSharedBus` is set play through `sharedBus` instead of a device callback of their own
+    inline static bool useSharedBus = false;
+    inline static MixBus* sharedBus;
+    bool onSharedBus = false;
+    std::atomic<float> busGain { 1 };
+    // released players reset for `acquire`, at most `poolSize`
+    inline static std::mutex poolMutex;
+    inline static std::vector<JuceMixPlayer*> pool;
+    inline static size_t poolSize = 0;
+
+    // false for headless players used by offline rendering
+    const bool attachToAudioDevice;
+
+    // held by the audio callback, guards `playBuffer`
     juce::CriticalSection lock;
+    // guards `mixerData` tracks between `taskQueue` and `heavyTaskQueue`
+    juce::CriticalSection mixerDataLock;
     TaskQueue heavyTaskQueue;
-    int taskQueueIndex = 0;
+    std::atomic<int> taskQueueIndex { 0 };
+    // bumped on every seek, cancels loads started for an older playhead
+    std::atomic<int> seekIndex { 0 };
     TaskQueue taskQueue;
     TaskQueue recWriteTaskQueue;
 
@@ -27,7 +61,6 @@ private:
     MixerSettings settings;
 
     juce::AudioFormatManager formatManager;
-    juce::LinearInterpolator interpolator[2];
 
     // MARK: Playing
     JuceMixPlayerState currentState = JuceMixPlayerState::IDLE;
@@ -38,8 +71,26 @@ private:
     bool _isSeeking = false;
     bool _isExporting = false;
     int playHeadIndex = 0;
-    juce::AudioBuffer<float> playBuffer;
-    std::unordered_map<std::string, std::shared_ptr<juce::AudioBuffer<float>>> repetedBufferCache;
+    // A–B loop in timeline seconds, empty loops the whole timeline with `settings.loop`. Guarded by `lock`.
+    juce::Range<float> loopRegion;
+    PlayBuffer playBuffer;
+    // encodes evicted pages, declared after `playBuffer` so its jobs finish before the pages go
+    TaskQueue compressTaskQueue;
+    // playBuffer samples for one callback, read before resampling
+    juce::AudioBuffer<float> callbackBuffer;
+    // player rate to device rate of both mix channels, guarded by `lock`. Replaced rather than re-prepared
+    // so the tables are built outside the lock
+    std::unique_ptr<SincResampler> resampler = std::make_unique<SincResampler>();
+    // decoded files of repeat tracks by path, `taskQueue` only
+    std::unordered_map<std::string, std::shared_ptr<const juce::AudioBuffer<float>>> repetedBufferCache;
+    // repeat tracks and the metronome, added by the audio callback instead of being rendered into `playBuffer`, guarded by `lock`
+    OneShotSampler oneShots;
+    // metronome clicks without custom samples
+    std::shared_ptr<const juce::AudioBuffer<float>> synthesizedClick;
+    std::shared_ptr<const juce::AudioBuffer<float>> synthesizedAccent;
+
+    // guards the three below, set by the host while the loaders copy them
+    juce::CriticalSection listenersLock;
 
     // external audio filter callbacks
     std::function<bool(std::string trackId,
@@ -49,6 +100,69 @@ private:
     std::function<bool(juce::AudioBuffer<float>& buffer,
                        int sampleRate)> mergeReadyListener;
 
+    // creates track readers instead of `formatManager` when set
+    std::function<juce::AudioFormatReader*(const juce::File& file)> readerFactory;
+
+    // notifications out of the audio callback and the caches, delivered by `_onEvent` and `_onEventValue`.
+    // Declared after the task queues, the handlers post to them, and before the caches, their workers post to it.
+    EventChannel events;
+    // bumped by `_clearCallbacks` and `_resetInPlace`, work queued for the previous owner is dropped
+    std::atomic<int> ownerIndex { 0 };
+
+    // app callbacks loaded and not called yet or still running, `_clearCallbacks` waits for them
+    std::atomic<int> callbacksInFlight { 0 };
+
+    /// An app callback loaded for one call, see `_holdCallback`
+    template <typename Callback>
+    class HeldCallback {
+    public:
+        HeldCallback(const std::atomic<Callback>& callback, std::atomic<int>& inFlight): inFlight(inFlight) {
+            // counted first, a clear after this load waits for the call
+            ++inFlight;
+            function = callback.load();
+        }
+
+        ~HeldCallback() {
+            --inFlight;
+        }
+
+        HeldCallback(const HeldCallback&) = delete;
+        HeldCallback& operator=(const HeldCallback&) = delete;
+
+        explicit operator bool() const {
+            return function != nullptr;
+        }
+
+        template <typename... Args>
+        void operator()(Args... args) const {
+            function(args...);
+        }
+
+    private:
+        std::atomic<int>& inFlight;
+        Callback function = nullptr;
+    };
+
+    /// `callback` for the calls in the scope of the result, `_clearCallbacks` returns after it
+    template <typename Callback>
+    HeldCallback<Callback> _holdCallback(const std::atomic<Callback>& callback) {
+        return { callback, callbacksInFlight };
+    }
+
+    // paths the owner asked for while they were building, only those are reported. `readyRequestsLock`
+    juce::CriticalSection readyRequestsLock;
+    std::set<std::string> waveformRequests;
+    std::set<std::string> loudnessRequests;
+
+    // peaks of track files, filled from the audio `_renderRange` decodes
+    WaveformCache waveforms;
+
+    // EBU R128 loudness of track files, measured like `waveforms`
+    LoudnessCache loudness;
+    // of the last export or offline render, guarded by `lock`
+    MixerLoudness mixLoudness;
+    bool hasMixLoudness = false;
+
     // MARK: Recording
 
     JuceMixPlayerRecState currentRecState = JuceMixPlayerRecState::IDLE;
@@ -66,11 +180,28 @@ private:
     std::string recordPath;
     juce::ReferenceCountedObjectPtr<juce::AudioDeviceManager::LevelMeter> inputLevelMeter;
 
+    // live input/output levels written by the audio callback, 10 seconds of 10ms frames
+    LevelStream levelStream { 1024 };
+
+    // read in place by the host, see `getTransport`
+    TransportState transport;
+
     // loading buffer into chunks
-    std::unordered_set<int> loadingBlocks;
-    std::unordered_set<int> loadedBlocks;
-    const float blockDuration = 5; // second
-    const float sampleRate = 48000;
+    const float pageDuration = 0.5; // second, buffer pages are mixed, cancelled and evicted in this length
+    const float maxBlockDuration = 5; // second, largest background load
+    const float seekSliceDuration = 0.1; // second, rendered first after a seek
+    // render rate of `playBuffer`, the rate of the output device so the callback only copies. `taskQueue` writes it,
+    // atomic for the readers on other threads, `lock` keeps it consistent with `playBuffer` and `playHeadIndex`
+    std::atomic<float> sampleRate { 48000 };
+    // output device `sampleRate` was last taken from, device thread only
+    juce::String renderDeviceName;
+    // `setSettings` asked for a device rate, the next output start sets `sampleRate` even on the same device
+    std::atomic<bool> renderRateRequested { false };
+    LoadPolicy loadPolicy { pageDuration, maxBlockDuration };
+    // a `_prefetch` is queued on `heavyTaskQueue`
+    std::atomic<bool> prefetchQueued { false };
+    // completion of the reset load in flight, `taskQueue` only
+    std::function<void()> resetCompletion;
 
     // latency related
     float deviceSampleRate = -1;
@@ -83,6 +214,50 @@ private:
 
     void _prepare();
 
+    /// stops the queues in order, the recorder writes finish, then deletes the player on the message thread
+    void _shutdown();
+
+    /// the app callbacks and the owner's work in flight, returns once no callback runs and their owner can free them.
+    /// Not from one of them.
+    void _clearCallbacks();
+
+    /// `taskQueue`, back to a new player's state keeping the device, caches and threads
+    void _resetInPlace();
+
+    /// what new mix data changes in the rendered pages
+    struct RenderChange {
+        enum Kind {
+            // nothing, or only what `oneShots` plays
+            NONE,
+            // gains, or where the tracks play. The pages of `spans` keep playing until they are rendered again,
+            // unless the timeline length changed.
+            TRACKS,
+            // other tracks, all pages are dropped
+            TIMELINE
+        };
+
+        Kind kind = NONE;
+        // seconds of the timeline where the changed tracks played and play now
+        std::vector<juce::Range<double>> spans;
+    };
+
+    /// loads in flight are cancelled unless it returns NONE
+    RenderChange _setMixerData(const MixerData& data);
+
+    static RenderChange _getRenderChange(const MixerData& from, const MixerData& to);
+
+    /// seconds of the timeline `track` can sound in, empty for repeat tracks and tracks without a reader
+    static juce::Range<double> _getTrackSpan(const MixerTrack& track);
+
+    /// `taskQueue`, after `_setMixerData` kept the readers: fits the timeline to the tracks and renders what changed
+    void _applyRenderChange(const RenderChange& change);
+
+    /// timeline of the current tracks, true when its length changed and the pages were dropped
+    bool _resizePlayBuffer();
+
+    /// `lock` held, drops the pages into `released` to be freed after the lock
+    void _setPlayBufferSize(float outputDuration, PlayBuffer::ReleasedPages& released);
+
     void _playInternal();
 
     void _pauseInternal(bool stop);
@@ -90,17 +265,96 @@ private:
     /// create reader for files
     void _createFileReadersAndTotalDuration();
 
-    void _loadRepeatedTrack(int block,
-                            int blockDuration,
-                            juce::AudioBuffer<float>& output,
-                            float offset,
-                            float repeatInterval,
-                            juce::AudioBuffer<float>* track);
+    /// `readerFactory` or a memory mapped reader when the format has one, otherwise `formatManager`'s
+    juce::AudioFormatReader* _createFileReader(const juce::File& file);
+
+    /// reader of `path` at `sampleRate`, converting files of other rates, nullptr when it can't be read
+    juce::AudioFormatReader* _createReader(const std::string& path);
+
+    /// renders at `rate` from now on: converts tracks and samples to it and renders the timeline again from the playhead
+    void _setRenderRate(float rate);
+
+    /// decoded file of a repeat track, cached by path
+    std::shared_ptr<const juce::AudioBuffer<float>> _loadOneShotSample(const std::string& path);
+
+    /// any thread, `_loadOneShotSample` without the cache
+    std::shared_ptr<const juce::AudioBuffer<float>> _decodeOneShotSample(const std::string& path);
+
+    /// Sets the cached samples of repeat tracks without one. The others are decoded on `heavyTaskQueue`
+    /// and set on the current tracks afterwards, they are silent until then.
+    void _loadRepeatSamples(MixerData& data);
+
+    /// sets the click samples of an enabled `metronome`
+    void _loadMetronomeSamples(MixerMetronome& metronome);
+
+    /// hit patterns of the enabled repeat tracks in `tracks` and of `metronome`
+    OneShotSampler _createOneShots(const std::vector<MixerTrack>& tracks, const MixerMetronome& metronome);
+
+    /// drops the buffered audio and loads from `startSample` ahead of queued work, then `completion` on `taskQueue`
+    void _loadAudioBlockSafe(int startSample, std::function<void()> completion);
+
+    /// loads the pages after `startSample` ahead of queued prefetches, rendering from `startSample` first.
+    /// `completion` runs on `taskQueue` once the first slice is audible, unless a newer seek replaced this one.
+    void _loadSeekBlock(int startSample, int seekIndex, std::function<void()> completion);
+
+    /// queues one `_prefetch` on `heavyTaskQueue`, safe from any thread including the audio callback
+    void _requestPrefetch();
+
+    /// loads the first missing pages in the look-ahead window after the playhead, sized by `loadPolicy`.
+    /// With a full look-ahead and `settings.backgroundFill` it loads one missing page elsewhere while under the memory budget.
+    /// Then evicts and requests the next prefetch.
+    void _prefetch();
+
+    /// frees the pages farthest from the playhead while more than `settings.maxBufferedDuration` is in memory
+    void _evictPages();
+
+    /// drops the compressed pages farthest from the playhead while they take more than `settings.compressedCacheSize`. `lock` held.
+    void _trimCompressedPages();
+
+    /// loads `numPages` buffer pages from `firstPage`, skipping rendered and loading pages. Evicted pages with a compressed copy are decoded instead of mixed.
+    /// Slices are rendered from `firstSample` when it is inside the first page, `firstSliceLoaded` runs after the first one.
+    /// `seekIndex` -1 loads can't be cancelled by seeks.
+    void _loadAudioBlock(int firstPage,
+                         int numPages,
+                         int taskQueueIndex,
+                         int seekIndex = -1,
+                         int firstSample = -1,
+                         std::function<void()> firstSliceLoaded = nullptr);
+
+    /// number of pages for `duration` seconds, at least one
+    int _getPageCount(float duration);
+
+    /// timeline samples the callback plays in a loop from `playHead`, empty when not looping. `lock` held.
+    juce::Range<int> _getLoopRange(int playHead);
+
+    /// a resampler from `renderRate` to the device rate at `quality`, allocates, needs no lock.
+    std::unique_ptr<SincResampler> _createResampler(int quality, float renderRate);
+    /// replaces `resampler` with `newResampler`, which gets the old one to free after unlocking. `lock` held.
+    void _swapResampler(std::unique_ptr<SincResampler>& newResampler);
+
+    /// fills `callbackBuffer` with `numSamples` of the timeline from `startSample`, continuing from the start of
+    /// `loopRange` at its end. `lock` held.
+    void _readCallbackBuffer(int startSample, int numSamples, juce::Range<int> loopRange);
+
+    /// adds `oneShots` for `numSamples` of the timeline from `startSample` to `callbackBuffer` at `outputStart`,
+    /// whatever state the pages are in. `lock` held.
+    void _addOneShots(int startSample, int outputStart, int numSamples);
+
+    /// seconds to keep rendered after the playhead
+    float _getLookAhead();
 
-    void _loadAudioBlockSafe(int block, bool reset, std::function<void()> completion);
+    /// mixes `tracks` and `oneShots` for `numSamples` from timeline sample `startSample` into `output`, false when cancelled.
+    /// Repeat tracks are only heard through `oneShots`.
+    bool _renderRange(std::vector<MixerTrack>& tracks,
+                      const OneShotSampler& oneShots,
+                      int startSample,
+                      int numSamples,
+                      juce::AudioBuffer<float>& output,
+                      juce::AudioBuffer<float>& trackBuffer,
+                      int taskQueueIndex,
+                      int seekIndex);
 
-    /// loads audio block for `blockDuration` and `block` number. Blocks are chunks of the audio file.
-    void _loadAudioBlock(int block, int taskQueueIndex);
+    bool _isLoadCancelled(int taskQueueIndex, int seekIndex);
 
     void _onProgressNotify(float progress);
 
@@ -108,7 +362,26 @@ private:
 
     void _onErrorNotify(std::string error);
 
-    std::optional<std::tuple<float, float, float>> _calculateBlockToRead(float block, MixerTrack& track);
+    /// the audio callback, false when `outputChannelData` holds nothing audible
+    bool _processCallback(const float* const* inputChannelData,
+                          int numInputChannels,
+                          float* const* outputChannelData,
+                          int numOutputChannels,
+                          int numSamples);
+
+    // MARK: MixBus::Source
+    void busAboutToStart(juce::AudioIODevice* device) override;
+
+    bool busProcess(const float* const* input,
+                    int numInputChannels,
+                    float* const* output,
+                    int numOutputChannels,
+                    int numSamples) override;
+
+    float getBusGain() const override;
+
+    /// dest start, sample count and reader start of `track` for `numSamples` from timeline sample `startSample`
+    std::optional<std::tuple<int, int, juce::int64>> _calculateRangeToRead(int startSample, int numSamples, MixerTrack& track);
 
     void _createWriterForRecorder();
 
@@ -120,6 +393,17 @@ private:
 
     void _resetRecorder();
 
+    /// dispatcher thread, hands the audio thread's notifications to the queues and the host
+    void _onEvent(const EventChannel::Event& event);
+
+    void _onEventValue(EventChannel::Value value, float amount);
+
+    /// whether the owner asked for `path` since it was last reported, forgets it
+    bool _takeReadyRequest(std::set<std::string>& requests, const std::string& path);
+
+    /// audio thread, after each callback. `audible` false leaves the output level at 0.
+    void _publishTransport(const float* const* input, int numInputChannels, const float* const* output, int numOutputChannels, int numSamples, bool audible);
+
     void _startProgressTimer();
 
     void _stopProgressTimer();
@@ -130,30 +414,59 @@ private:
 
     void _resetPlayBufferBlocks();
 
+    /// the pages of `spans` (seconds) keep playing while they are rendered again from the playhead
+    void _refreshPlayBufferBlocks(const std::vector<juce::Range<double>>& spans);
+
     void _copyReaders(const MixerData& from, MixerData& to);
 
+    /// gain that brings `path` to `settings.loudnessTarget`, 1 when loudness matching is off or the file is not measured.
+    /// `analyse` measures missing parts on the calling thread instead.
+    float _getLoudnessGain(const std::string& path, bool analyse);
+
+    /// re-renders with the new gains when loudness matching uses `path`
+    void _onLoudnessReady(const std::string& path);
+
     // returns epoch time in millis
     long _getEpochTime();
     
 public:
 
-    JuceMixPlayerCallbackFloat onProgressCallback = nullptr;
-    JuceMixPlayerCallbackString onStateUpdateCallback = nullptr;
-    JuceMixPlayerCallbackString onErrorCallback = nullptr;
+    // set by the host on any thread, each call site holds one with `_holdCallback` so a concurrent clear can't leave it
+    // calling null, or the host freeing it while it's called
+    std::atomic<JuceMixPlayerCallbackFloat> onProgressCallback { nullptr };
+    std::atomic<JuceMixPlayerCallbackString> onStateUpdateCallback { nullptr };
+    std::atomic<JuceMixPlayerCallbackString> onErrorCallback { nullptr };
+
+    std::atomic<JuceMixPlayerCallbackFloat> onRecLevelCallback { nullptr };
+    std::atomic<JuceMixPlayerCallbackFloat> onRecProgressCallback { nullptr };
+    std::atomic<JuceMixPlayerCallbackString> onRecStateUpdateCallback { nullptr };
+    std::atomic<JuceMixPlayerCallbackString> onRecErrorCallback { nullptr };
 
-    JuceMixPlayerCallbackFloat onRecLevelCallback = nullptr;
-    JuceMixPlayerCallbackFloat onRecProgressCallback = nullptr;
-    JuceMixPlayerCallbackString onRecStateUpdateCallback = nullptr;
-    JuceMixPlayerCallbackString onRecErrorCallback = nullptr;
+    std::atomic<JuceMixPlayerCallbackString> onDeviceUpdateCallback { nullptr };
 
-    JuceMixPlayerCallbackString onDeviceUpdateCallback = nullptr;
+    std::atomic<JuceMixPlayerCallbackString> onWaveformReadyCallback { nullptr };
 
-    JuceMixPlayer();
+    std::atomic<JuceMixPlayerCallbackString> onLoudnessReadyCallback { nullptr };
+
+    /// `attachToAudioDevice` false creates a headless player, no MessageManager or audio device is used.
+    JuceMixPlayer(bool attachToAudioDevice = true);
 
     ~JuceMixPlayer();
 
+    /// Detaches from the device and deletes the player once its queues have stopped, loads in flight are cancelled.
     void dispose();
 
+    /// Keeps up to `size` released players for `acquire`, creating them now so they are ready. Extra ones are disposed.
+    static void setPoolSize(int size);
+
+    /// a pooled player, or a new one when the pool is empty
+    static JuceMixPlayer* acquire();
+
+    /// Returns the player to the pool when it has room, otherwise disposes it. Playback stops and the mix data,
+    /// settings, callbacks, recorder state, unread levels and undelivered notifications are dropped before the next
+    /// owner gets it, players with a prepared recorder are always disposed.
+    void release();
+
     void play();
 
     void pause();
@@ -164,11 +477,19 @@ public:
 
     void setJson(const char* json);
 
+    /// Changes track fields without json or comparing compositions. All of `updates` are heard together,
+    /// an invalid one drops the whole batch with an error. Indices are those of the last `setJson`.
+    void updateTracks(std::vector<MixerTrackUpdate> updates);
+
     void setSettings(const char* json);
 
     /// value range 0 to 1
     void seek(float value);
 
+    /// Loops timeline seconds `start` to `end` while the playhead is before `end`, `end <= start` clears it.
+    /// Nothing is re-rendered, only the pages of the region are loaded and kept around the wrap.
+    void setLoopRegion(float start, float end);
+
     // get curent time in seconds
     float getCurrentTime();
 
@@ -181,6 +502,13 @@ public:
 
     void exportToFile(const char* outputFile, std::function<void(const char*)> completion);
 
+    // MARK: Offline rendering
+
+    /// Parses `json` and renders every block on the calling thread through the regular block loader.
+    /// Writes the result to `outputPath` (wav/flac) when not null. Throws on invalid json.
+    /// Meant for headless players, the player must not be playing.
+    MixerRenderStats renderOffline(const char* json, const char* outputPath = nullptr);
+
     // MARK: Recorder
     void prepareRecorder(const char* file);
 
@@ -198,11 +526,59 @@ public:
 
     void resetPlayBuffer();
 
+    /// Replaces `formatManager` for opening track files, e.g. to wrap readers with extra decode latency.
+    void setReaderFactory(std::function<juce::AudioFormatReader*(const juce::File& file)> closure);
+
+    /// Players created after this call use `manager` instead of the default device manager.
+    /// Allows driving players with custom `juce::AudioIODeviceType`s, the caller keeps ownership.
+    static void setAudioDeviceManager(juce::AudioDeviceManager* manager);
+
+    /// Players created after this call share one device callback that sums them, instead of registering one each.
+    static void setSharedOutputBus(bool enabled);
+
+    /// linear gain of this player on the shared output bus, ramped over one callback
+    void setBusGain(float gain);
+
     // MARK: device management
     void setUpdatedDevices(const char* json);
 
+    /// json owned by the caller, freed with `freeCopyChar`
     const char* getDeviceLatencyInfo();
 
+    // MARK: Buffering
+
+    /// json `MixerBufferedRanges`, time ranges of the timeline that are rendered, loading or evicted.
+    /// Owned by the caller, freed with `freeCopyChar`.
+    const char* getBufferedRanges();
+
+    // MARK: Levels
+
+    /// Copies up to `maxFrames` live level frames into `output`, `LevelStream::floatsPerFrame` floats each, oldest first.
+    /// Returns the number of frames. Call from one thread only.
+    int readLevels(float* output, int maxFrames);
+
+    /// Playhead, state, recording time and levels, updated by the player and read by the host without calls.
+    /// Valid while this player is, also across `release` and `acquire`.
+    const TransportState& getTransport() const;
+
+    // MARK: Waveform
+
+    /// Writes `numPoints` frames of min, max and rms (3 floats, -1 to 1) for `startTime` to `endTime` seconds of file `path` to `output`.
+    /// Returns `numPoints`, -1 while the peaks are being built (`onWaveformReadyCallback` follows) or 0 if the file can't be read.
+    int getWaveform(const char* path, float startTime, float endTime, int numPoints, float* output);
+
+    /// directory for the waveform peak and loudness sidecar files
+    void setWaveformCacheDir(const char* path);
+
+    // MARK: Loudness
+
+    /// Writes integrated, max momentary, max short-term loudness (LUFS), loudness range (LU) and true peak (dBTP) of file `path` to `output`.
+    /// Returns 1, -1 while it is measured (`onLoudnessReadyCallback` follows) or 0 if the file can't be read.
+    int getLoudness(const char* path, float* output);
+
+    /// Like `getLoudness` for the mix of the last export or offline render, returns 0 when there was none.
+    int getMixLoudness(float* output);
+
     // MARK: juce::AudioIODeviceCallback
     void audioDeviceAboutToStart(juce::AudioIODevice *device) override;
 
@@ -0,0 +1,122 @@
+#include "LevelStream.h"
+#include <cmath>
+#include <limits>
+
+LevelStream::LevelStream(int capacity): fifo(capacity + 1), frames((size_t)capacity + 1) {
+}
+
+void LevelStream::process(const float* input,
+                          const float* const* output,
+                          int numOutputChannels,
+                          int numSamples,
+                          int samplesPerFrame) {
+    if (samplesPerFrame <= 0) {
+        return;
+    }
+    if (restartRequested.exchange(false) || samplesPerFrame != currentSamplesPerFrame || numOutputChannels != currentOutputChannels) {
+        currentSamplesPerFrame = samplesPerFrame;
+        currentOutputChannels = numOutputChannels;
+        _resetCurrent();
+    }
+
+    int position = 0;
+    while (position < numSamples) {
+        const int count = std::min(numSamples - position, samplesPerFrame - currentSamples);
+
+        if (input != nullptr) {
+            currentHasInput = true;
+            const juce::Range<float> range = juce::FloatVectorOperations::findMinAndMax(input + position, count);
+            current.inputMin = std::min(current.inputMin, range.getStart());
+            current.inputMax = std::max(current.inputMax, range.getEnd());
+            inputSumSquares += _sumOfSquares(input + position, count);
+        }
+        for (int ch=0; ch<numOutputChannels; ch++) {
+            const juce::Range<float> range = juce::FloatVectorOperations::findMinAndMax(output[ch] + position, count);
+            current.outputMin = std::min(current.outputMin, range.getStart());
+            current.outputMax = std::max(current.outputMax, range.getEnd());
+            outputSumSquares += _sumOfSquares(output[ch] + position, count);
+        }
+
+        currentSamples += count;
+        position += count;
+        if (currentSamples == samplesPerFrame) {
+            if (!currentHasInput) {
+                current.inputMin = current.inputMax = 0;
+            }
+            if (numOutputChannels == 0) {
+                current.outputMin = current.outputMax = 0;
+            }
+            current.inputRms = (float)std::sqrt(inputSumSquares / samplesPerFrame);
+            current.outputRms = (float)std::sqrt(outputSumSquares / ((double)samplesPerFrame * std::max(1, numOutputChannels)));
+            _push();
+            _resetCurrent();
+        }
+    }
+}
+
+int LevelStream::read(float* output, int maxFrames) {
+    if (output == nullptr || maxFrames <= 0) {
+        return 0;
+    }
+    if (discardRequested.exchange(false)) {
+        fifo.finishedRead(fifo.getNumReady());
+    }
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(maxFrames, start1, size1, start2, size2);
+    if (size1 > 0) {
+        memcpy(output, frames.data() + start1, (size_t)size1 * sizeof(Frame));
+    }
+    if (size2 > 0) {
+        memcpy(output + size1 * floatsPerFrame, frames.data() + start2, (size_t)size2 * sizeof(Frame));
+    }
+    fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+int LevelStream::getNumDropped() const {
+    return numDropped;
+}
+
+void LevelStream::reset() {
+    discardRequested = true;
+    restartRequested = true;
+    numDropped = 0;
+}
+
+void LevelStream::_push() {
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 == 0) {
+        // nobody is reading, keep the oldest unread frames
+        numDropped++;
+        return;
+    }
+    frames[(size_t)start1] = current;
+    fifo.finishedWrite(1);
+}
+
+void LevelStream::_resetCurrent() {
+    current = Frame();
+    current.inputMin = current.outputMin = std::numeric_limits<float>::max();
+    current.inputMax = current.outputMax = std::numeric_limits<float>::lowest();
+    currentHasInput = false;
+    inputSumSquares = 0;
+    outputSumSquares = 0;
+    currentSamples = 0;
+}
+
+float LevelStream::_sumOfSquares(const float* samples, int numSamples) {
+    // independent accumulators let the compiler vectorise the loop without fast-math
+    float sums[4] = { 0, 0, 0, 0 };
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        sums[0] += samples[i] * samples[i];
+        sums[1] += samples[i + 1] * samples[i + 1];
+        sums[2] += samples[i + 2] * samples[i + 2];
+        sums[3] += samples[i + 3] * samples[i + 3];
+    }
+    for (; i < numSamples; i++) {
+        sums[0] += samples[i] * samples[i];
+    }
+    return sums[0] + sums[1] + sums[2] + sums[3];
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/// Downsampled peak/RMS frames of the device input and output, for live scrolling waveforms and meters.
+/// The audio callback writes frames into a lock-free FIFO, one consumer drains them in batches.
+class LevelStream {
+public:
+
+    struct Frame {
+        float inputMin = 0;
+        float inputMax = 0;
+        float inputRms = 0;
+        float outputMin = 0;
+        float outputMax = 0;
+        float outputRms = 0;
+    };
+
+    static constexpr int floatsPerFrame = sizeof(Frame) / sizeof(float);
+
+    /// keeps up to `capacity` unread frames, newer frames are dropped while it is full
+    LevelStream(int capacity);
+
+    /// Audio thread. Adds `numSamples` of `input` (may be null) and `output` to the current frame,
+    /// pushing a frame every `samplesPerFrame` samples. 0 or less disables the stream.
+    void process(const float* input,
+                 const float* const* output,
+                 int numOutputChannels,
+                 int numSamples,
+                 int samplesPerFrame);
+
+    /// Copies up to `maxFrames` frames (`floatsPerFrame` floats each) into `output`, oldest first. Returns the frame count.
+    /// Only one thread may read at a time.
+    int read(float* output, int maxFrames);
+
+    /// frames dropped because the FIFO was full
+    int getNumDropped() const;
+
+    /// Any thread. The next `read` skips the frames written so far and the next `process` starts a new frame.
+    void reset();
+
+private:
+
+    juce::AbstractFifo fifo;
+    std::vector<Frame> frames;
+    std::atomic<int> numDropped { 0 };
+    // requested by `reset`, taken by the reader and the writer
+    std::atomic<bool> discardRequested { false };
+    std::atomic<bool> restartRequested { false };
+
+    // frame being accumulated, audio thread only
+    Frame current;
+    double inputSumSquares = 0;
+    double outputSumSquares = 0;
+    int currentSamples = 0;
+    int currentSamplesPerFrame = 0;
+    int currentOutputChannels = 0;
+    bool currentHasInput = false;
+
+    void _push();
+
+    void _resetCurrent();
+
+    static float _sumOfSquares(const float* samples, int numSamples);
+};
@@ -0,0 +1,43 @@
+#include "LoadPolicy.h"
+#include <algorithm>
+#include <cmath>
+
+LoadPolicy::LoadPolicy(float pageDuration, float maxBlockDuration): pageDuration(pageDuration), maxBlockDuration(maxBlockDuration) {
+}
+
+void LoadPolicy::addMeasurement(float audioDuration, double wallTimeMillis) {
+    if (audioDuration <= 0) {
+        return;
+    }
+    // sub millisecond jobs would report absurd speeds
+    const float speed = audioDuration * 1000 / (float)std::max(wallTimeMillis, 1.0);
+    const float current = renderSpeed;
+    renderSpeed = current == 0 ? speed : current + (speed - current) * smoothing;
+}
+
+float LoadPolicy::getRenderSpeed() const {
+    return renderSpeed;
+}
+
+float LoadPolicy::getBlockDuration(float bufferedAhead) const {
+    const float speed = renderSpeed;
+    // the job has to finish well before playback uses up what is buffered
+    const float duration = speed * bufferedAhead * 0.5f;
+    const float pages = std::floor(std::min(duration, maxBlockDuration) / pageDuration);
+    return std::max(1.0f, pages) * pageDuration;
+}
+
+float LoadPolicy::getLookAhead(float maxLookAhead) const {
+    const float speed = renderSpeed;
+    if (speed == 0) {
+        // not measured yet, two full blocks
+        return std::min(maxLookAhead, maxBlockDuration * 2);
+    }
+    if (speed <= 1) {
+        // slower than real time, render as far ahead as allowed
+        return maxLookAhead;
+    }
+    // covers a stall plus refilling it while playback keeps consuming, grows without bound as speed nears 1x
+    const float lookAhead = maxBlockDuration + stallTolerance * speed / (speed - 1);
+    return std::min(maxLookAhead, lookAhead);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+
+/// Decides how much audio the background loader mixes per job and how far ahead of the playhead it renders.
+/// Both follow the measured render speed (seconds of audio mixed per second of wall time), so a fast device
+/// keeps a short look-ahead and a slow one with many compressed tracks buffers further ahead.
+class LoadPolicy {
+public:
+
+    /// `pageDuration` is the smallest job, `maxBlockDuration` the largest (seconds)
+    LoadPolicy(float pageDuration, float maxBlockDuration);
+
+    /// adds a finished job, `audioDuration` seconds mixed in `wallTimeMillis`
+    void addMeasurement(float audioDuration, double wallTimeMillis);
+
+    /// render speed in x real time, 0 until the first measurement
+    float getRenderSpeed() const;
+
+    /// seconds to mix in the next job when `bufferedAhead` seconds are already rendered after the playhead.
+    /// Small near the playhead, so the first page is audible quickly, growing with the buffer.
+    float getBlockDuration(float bufferedAhead) const;
+
+    /// seconds to keep rendered after the playhead, at most `maxLookAhead`
+    float getLookAhead(float maxLookAhead) const;
+
+private:
+
+    const float pageDuration;
+    const float maxBlockDuration;
+
+    // wall time (seconds) playback must survive without the loader making progress
+    const float stallTolerance = 1;
+    // weight of the newest measurement
+    const float smoothing = 0.3;
+
+    std::atomic<float> renderSpeed { 0 };
+};
@@ -4,9 +4,12 @@
 
 extern bool enableLogsValue;
 
-const char* returnCopyCharDelete(std::string str);
+/// malloc copy for the other side of the C API, which owns it and hands it back to `freeCopyChar`
+const char* returnCopyChar(const std::string& str);
 
-const char* returnCopyCharDelete(const char* string);
+const char* returnCopyChar(const char* string);
+
+void freeCopyChar(const char* string);
 
 bool setContains(std::unordered_set<int>& set, int val);
 
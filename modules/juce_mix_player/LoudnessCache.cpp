@@ -0,0 +1,370 @@
+#include "LoudnessCache.h"
+
+namespace {
+
+const int loudnessSidecarVersion = 1;
+
+// segments decoded per read when filling gaps
+const int segmentsPerRead = 50;
+
+}
+
+LoudnessCache::LoudnessCache() {
+    cacheDirectory = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("juce_mix_waveforms");
+}
+
+LoudnessCache::~LoudnessCache() {
+    cancelled = true;
+    std::vector<std::unique_ptr<TaskQueue>> stoppedWorkers;
+    {
+        const juce::ScopedLock sl (entriesLock);
+        stoppedWorkers.swap(workers);
+    }
+    // joins the worker threads, running builds stop at their next read
+    stoppedWorkers.clear();
+}
+
+void LoudnessCache::setCacheDirectory(const juce::File& directory) {
+    const juce::ScopedLock sl (entriesLock);
+    cacheDirectory = directory;
+}
+
+int LoudnessCache::getLoudness(const std::string& path, MixerLoudness& output) {
+    return _lookup(path, output, true);
+}
+
+int LoudnessCache::analyse(const std::string& path, MixerLoudness& output) {
+    const int status = _lookup(path, output, false);
+    if (status != -1) {
+        return status;
+    }
+    // a worker may be measuring the same file, both only fill what is still missing
+    _build(path);
+    return _lookup(path, output, false);
+}
+
+int LoudnessCache::_lookup(const std::string& path, MixerLoudness& output, bool schedule) {
+    std::shared_ptr<Entry> entry = _getEntry(path);
+    const juce::ScopedLock sl (entry->lock);
+
+    const juce::File file(path);
+    const juce::int64 fileSize = file.getSize();
+    const juce::int64 modificationTime = file.getLastModificationTime().toMilliseconds();
+    if (entry->complete && (fileSize != entry->fileSize || modificationTime != entry->modificationTime)) {
+        // the file was replaced since it was measured
+        entry->complete = false;
+        entry->segments.clear();
+        entry->present.clear();
+        entry->numPresent = 0;
+        entry->generation++;
+    }
+    if (!entry->complete && !entry->failed && !entry->building && entry->numPresent == 0) {
+        // measured in an earlier session
+        entry->fileSize = fileSize;
+        entry->modificationTime = modificationTime;
+        entry->complete = _loadSidecar(*entry, path);
+    }
+    if (entry->complete) {
+        output = entry->result;
+        return 1;
+    }
+    if (entry->failed) {
+        return 0;
+    }
+    if (schedule && !entry->building) {
+        entry->building = true;
+        _async([this, path]{
+            _build(path);
+        });
+    }
+    return -1;
+}
+
+void LoudnessCache::addDecodedAudio(const std::string& path,
+                                    const juce::AudioFormatReader& reader,
+                                    const juce::AudioBuffer<float>& buffer,
+                                    int startSample,
+                                    int numSamples,
+                                    juce::int64 fileStartSample) {
+    if (numSamples <= 0 || fileStartSample < 0) {
+        return;
+    }
+    std::shared_ptr<Entry> entry = _getEntry(path);
+    const juce::ScopedLock sl (entry->lock);
+    if (entry->complete || entry->failed) {
+        return;
+    }
+    if (entry->segments.empty() || entry->lengthInSamples != reader.lengthInSamples || entry->sampleRate != reader.sampleRate) {
+        _prepareEntry(*entry, juce::File(path), reader);
+    }
+
+    // segments that start after the filters settled and end inside the decoded audio
+    const juce::int64 segmentSize = entry->segmentSize;
+    const juce::int64 fileEndSample = std::min(fileStartSample + numSamples, entry->lengthInSamples);
+    const juce::int64 warmUp = fileStartSample == 0 ? 0 : entry->warmUpSize;
+    juce::int64 firstSegment = (fileStartSample + warmUp + segmentSize - 1) / segmentSize;
+    juce::int64 endSegment = fileEndSample == entry->lengthInSamples ? (juce::int64)entry->present.size() : fileEndSample / segmentSize;
+    while (firstSegment < endSegment && entry->present[firstSegment]) {
+        firstSegment++;
+    }
+    while (endSegment > firstSegment && entry->present[endSegment - 1]) {
+        endSegment--;
+    }
+    if (firstSegment >= endSegment) {
+        return;
+    }
+
+    // measured on a worker, the loader only pays for the copy
+    const juce::int64 copyStart = std::max(fileStartSample, firstSegment * segmentSize - warmUp);
+    const juce::int64 copyEnd = std::min(fileEndSample, endSegment * segmentSize);
+    const int numChannels = std::min(entry->numChannels, buffer.getNumChannels());
+    auto copy = std::make_shared<juce::AudioBuffer<float>>(numChannels, (int)(copyEnd - copyStart));
+    for (int ch=0; ch<numChannels; ch++) {
+        copy->copyFrom(ch, 0, buffer, ch, startSample + (int)(copyStart - fileStartSample), (int)(copyEnd - copyStart));
+    }
+    const int generation = entry->generation;
+    _async([this, path, entry, generation, copy, copyStart, firstSegment, endSegment]{
+        _measure(path, *entry, generation, *copy, copyStart, firstSegment, endSegment);
+        bool finished = false;
+        {
+            const juce::ScopedLock sl (entry->lock);
+            // playback decoded the whole file
+            if (entry->generation == generation && !entry->complete && entry->numPresent == entry->present.size()) {
+                _finish(path, *entry);
+                finished = true;
+            }
+        }
+        if (finished) {
+            auto callback = onReady;
+            if (callback) {
+                callback(path);
+            }
+        }
+    });
+}
+
+std::shared_ptr<LoudnessCache::Entry> LoudnessCache::_getEntry(const std::string& path) {
+    const juce::ScopedLock sl (entriesLock);
+    std::shared_ptr<Entry>& entry = entries[path];
+    if (!entry) {
+        entry = std::make_shared<Entry>();
+    }
+    return entry;
+}
+
+void LoudnessCache::_async(TaskQueueItem task) {
+    const juce::ScopedLock sl (entriesLock);
+    if (cancelled) {
+        return;
+    }
+    if (workers.empty()) {
+        const size_t count = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+        for (size_t i=0; i<count; i++) {
+            workers.emplace_back(new TaskQueue());
+            workers.back()->name = "loudnessQueue";
+        }
+    }
+    workers[nextWorker++ % workers.size()]->async(std::move(task));
+}
+
+void LoudnessCache::_build(const std::string& path) {
+    std::shared_ptr<Entry> entry = _getEntry(path);
+    const juce::File file(path);
+
+    auto notify = [&]{
+        auto callback = onReady;
+        if (callback) {
+            callback(path);
+        }
+    };
+
+    std::unique_ptr<juce::AudioFormatReader> reader(createReader ? createReader(file) : nullptr);
+    if (!reader || reader->lengthInSamples <= 0) {
+        {
+            const juce::ScopedLock sl (entry->lock);
+            entry->failed = true;
+            entry->building = false;
+        }
+        notify();
+        return;
+    }
+
+    int generation;
+    {
+        const juce::ScopedLock sl (entry->lock);
+        if (entry->complete) {
+            entry->building = false;
+            return;
+        }
+        _prepareEntry(*entry, file, *reader);
+        generation = entry->generation;
+    }
+
+    // decode only the segments playback has not decoded yet, with the filters primed before each run
+    juce::AudioBuffer<float> buffer;
+    juce::int64 segment = 0;
+    while (true) {
+        if (cancelled) return;
+
+        juce::int64 numSegments = 0;
+        juce::int64 segmentSize;
+        juce::int64 warmUp;
+        {
+            const juce::ScopedLock sl (entry->lock);
+            if (entry->generation != generation) {
+                break;
+            }
+            const juce::int64 totalSegments = (juce::int64)entry->present.size();
+            while (segment < totalSegments && entry->present[segment]) {
+                segment++;
+            }
+            if (segment >= totalSegments) {
+                break;
+            }
+            while (numSegments < segmentsPerRead && segment + numSegments < totalSegments && !entry->present[segment + numSegments]) {
+                numSegments++;
+            }
+            segmentSize = entry->segmentSize;
+            warmUp = entry->warmUpSize;
+        }
+
+        const juce::int64 readStart = std::max<juce::int64>(0, segment * segmentSize - warmUp);
+        const juce::int64 readEnd = std::min(reader->lengthInSamples, (segment + numSegments) * segmentSize);
+        buffer.setSize(juce::jlimit(1, 2, (int)reader->numChannels), (int)(readEnd - readStart), false, false, true);
+        buffer.clear();
+        reader->read(&buffer, 0, (int)(readEnd - readStart), readStart, true, true);
+        _measure(path, *entry, generation, buffer, readStart, segment, segment + numSegments);
+        segment += numSegments;
+    }
+
+    bool finished = false;
+    {
+        const juce::ScopedLock sl (entry->lock);
+        entry->building = false;
+        if (!entry->complete && entry->numPresent == entry->present.size() && !entry->present.empty()) {
+            _finish(path, *entry);
+            finished = true;
+        }
+    }
+    if (finished) {
+        notify();
+    }
+}
+
+void LoudnessCache::_prepareEntry(Entry& entry, const juce::File& file, const juce::AudioFormatReader& reader) {
+    const juce::int64 fileSize = file.getSize();
+    const juce::int64 modificationTime = file.getLastModificationTime().toMilliseconds();
+    if (!entry.segments.empty()
+        && entry.fileSize == fileSize
+        && entry.modificationTime == modificationTime
+        && entry.lengthInSamples == reader.lengthInSamples
+        && entry.sampleRate == reader.sampleRate) {
+        return;
+    }
+    // mono files are read into both channels, they are measured once
+    const LoudnessMeter meter(reader.sampleRate, (int)reader.numChannels);
+    entry.fileSize = fileSize;
+    entry.modificationTime = modificationTime;
+    entry.lengthInSamples = reader.lengthInSamples;
+    entry.sampleRate = reader.sampleRate;
+    entry.numChannels = juce::jlimit(1, 2, (int)reader.numChannels);
+    entry.segmentSize = meter.getSegmentSize();
+    entry.warmUpSize = meter.getWarmUpSize();
+    entry.generation++;
+    const size_t numSegments = (size_t)((reader.lengthInSamples + entry.segmentSize - 1) / entry.segmentSize);
+    entry.segments.assign(numSegments, {});
+    entry.present.assign(numSegments, false);
+    entry.numPresent = 0;
+    entry.complete = false;
+    entry.failed = false;
+}
+
+void LoudnessCache::_measure(const std::string& path,
+                             Entry& entry,
+                             int generation,
+                             const juce::AudioBuffer<float>& buffer,
+                             juce::int64 bufferFileStart,
+                             juce::int64 firstSegment,
+                             juce::int64 endSegment) {
+    double sampleRate;
+    int numChannels;
+    juce::int64 segmentSize;
+    juce::int64 lengthInSamples;
+    {
+        const juce::ScopedLock sl (entry.lock);
+        if (entry.generation != generation) {
+            return;
+        }
+        sampleRate = entry.sampleRate;
+        numChannels = entry.numChannels;
+        segmentSize = entry.segmentSize;
+        lengthInSamples = entry.lengthInSamples;
+    }
+
+    LoudnessMeter meter(sampleRate, numChannels);
+    const int measureStart = (int)(firstSegment * segmentSize - bufferFileStart);
+    const int measureEnd = (int)(std::min(lengthInSamples, endSegment * segmentSize) - bufferFileStart);
+    meter.prime(buffer, 0, measureStart);
+    meter.process(buffer, measureStart, measureEnd - measureStart);
+    // the last segment of the file is shorter
+    meter.flush();
+
+    const juce::ScopedLock sl (entry.lock);
+    if (entry.generation != generation) {
+        return;
+    }
+    const std::vector<LoudnessMeter::Segment>& segments = meter.getSegments();
+    for (size_t i=0; i<segments.size(); i++) {
+        const size_t segment = (size_t)firstSegment + i;
+        if (segment < entry.present.size() && !entry.present[segment]) {
+            entry.segments[segment] = segments[i];
+            entry.present[segment] = true;
+            entry.numPresent++;
+        }
+    }
+}
+
+void LoudnessCache::_finish(const std::string& path, Entry& entry) {
+    entry.result = LoudnessMeter::getLoudness(entry.segments);
+    entry.complete = true;
+    _saveSidecar(entry, path);
+}
+
+juce::File LoudnessCache::_getSidecarFile(const std::string& path) {
+    const juce::ScopedLock sl (entriesLock);
+    return cacheDirectory.getChildFile(juce::String::toHexString(juce::String(path).hashCode64()) + ".loudness");
+}
+
+bool LoudnessCache::_loadSidecar(Entry& entry, const std::string& path) {
+    const juce::File file = _getSidecarFile(path);
+    juce::MemoryBlock data;
+    if (!file.existsAsFile() || !file.loadFileAsData(data)) {
+        return false;
+    }
+    try {
+        const nlohmann::json j = nlohmann::json::parse(std::string((const char*)data.getData(), data.getSize()));
+        if (j.at("version").get<int>() != loudnessSidecarVersion
+            || j.at("fileSize").get<juce::int64>() != entry.fileSize
+            || j.at("modificationTime").get<juce::int64>() != entry.modificationTime) {
+            return false;
+        }
+        entry.result = j.at("loudness").get<MixerLoudness>();
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
+
+void LoudnessCache::_saveSidecar(Entry& entry, const std::string& path) {
+    nlohmann::json j;
+    j["version"] = loudnessSidecarVersion;
+    j["fileSize"] = entry.fileSize;
+    j["modificationTime"] = entry.modificationTime;
+    j["loudness"] = entry.result;
+    const std::string text = j.dump();
+    const juce::File file = _getSidecarFile(path);
+    // a missing sidecar only costs a measurement next time
+    if (file.getParentDirectory().createDirectory()) {
+        file.replaceWithData(text.data(), text.size());
+    }
+}
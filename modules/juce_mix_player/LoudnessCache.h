@@ -0,0 +1,103 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TaskQueue.h"
+#include "LoudnessMeter.h"
+
+/// EBU R128 loudness of audio files.
+/// Measured from the audio the player decodes anyway where possible, worker threads decode the rest.
+/// Results are saved as small json sidecars in the cache directory and reused until the file changes.
+class LoudnessCache {
+public:
+
+    LoudnessCache();
+
+    ~LoudnessCache();
+
+    /// opens files for decoding, required
+    std::function<juce::AudioFormatReader*(const juce::File& file)> createReader;
+
+    /// called on a worker thread with the path once its loudness is known, or failed to measure
+    std::function<void(const std::string& path)> onReady;
+
+    /// sidecar directory, defaults to `juce_mix_waveforms` in the temp directory
+    void setCacheDirectory(const juce::File& directory);
+
+    /// Writes the loudness of `path` to `output`. Returns 1, -1 while it is measured in the background (`onReady` follows)
+    /// or 0 if the file can't be read.
+    int getLoudness(const std::string& path, MixerLoudness& output);
+
+    /// Like `getLoudness` but measures the missing parts on the calling thread instead of returning -1.
+    int analyse(const std::string& path, MixerLoudness& output);
+
+    /// Queues `numSamples` of `buffer` starting at `startSample`, which `reader` decoded from `fileStartSample` of `path`,
+    /// for measuring on a worker. Only segments with enough audio before them to settle the filters are used.
+    void addDecodedAudio(const std::string& path,
+                         const juce::AudioFormatReader& reader,
+                         const juce::AudioBuffer<float>& buffer,
+                         int startSample,
+                         int numSamples,
+                         juce::int64 fileStartSample);
+
+private:
+
+    struct Entry {
+        juce::CriticalSection lock;
+        juce::int64 fileSize = 0;
+        juce::int64 modificationTime = 0;
+        juce::int64 lengthInSamples = 0;
+        double sampleRate = 0;
+        int numChannels = 0;
+        int segmentSize = 0;
+        int warmUpSize = 0;
+        // bumped when the file changed, measurements of the old file are dropped
+        int generation = 0;
+        std::vector<LoudnessMeter::Segment> segments;
+        std::vector<bool> present;
+        size_t numPresent = 0;
+        MixerLoudness result;
+        bool complete = false;
+        bool failed = false;
+        bool building = false;
+    };
+
+    juce::CriticalSection entriesLock;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+    juce::File cacheDirectory;
+
+    std::vector<std::unique_ptr<TaskQueue>> workers;
+    size_t nextWorker = 0;
+    // set on destruction, stops running builds
+    std::atomic<bool> cancelled { false };
+
+    std::shared_ptr<Entry> _getEntry(const std::string& path);
+
+    /// `getLoudness`, `schedule` false leaves measuring the missing parts to the caller
+    int _lookup(const std::string& path, MixerLoudness& output, bool schedule);
+
+    void _async(TaskQueueItem task);
+
+    /// decodes and measures the missing segments, then finishes the entry
+    void _build(const std::string& path);
+
+    /// sizes `entry` for `reader`, drops existing segments when the file changed
+    void _prepareEntry(Entry& entry, const juce::File& file, const juce::AudioFormatReader& reader);
+
+    /// measures segments `firstSegment` to `endSegment` of `buffer`, which holds the file from `bufferFileStart`
+    void _measure(const std::string& path,
+                  Entry& entry,
+                  int generation,
+                  const juce::AudioBuffer<float>& buffer,
+                  juce::int64 bufferFileStart,
+                  juce::int64 firstSegment,
+                  juce::int64 endSegment);
+
+    /// computes and saves the result when every segment is present, entry lock held
+    void _finish(const std::string& path, Entry& entry);
+
+    juce::File _getSidecarFile(const std::string& path);
+
+    bool _loadSidecar(Entry& entry, const std::string& path);
+
+    void _saveSidecar(Entry& entry, const std::string& path);
+};
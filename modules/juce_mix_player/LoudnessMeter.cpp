@@ -0,0 +1,242 @@
+#include "LoudnessMeter.h"
+#include <cmath>
+
+namespace {
+
+const double segmentDuration = 0.1; // seconds, gating blocks overlap by 75%
+const int segmentsPerMomentary = 4; // 400ms
+const int segmentsPerShortTerm = 30; // 3s
+const float loudnessFloor = -70;
+
+double energyToLoudness(double energy) {
+    return energy > 0 ? -0.691 + 10 * std::log10(energy) : -HUGE_VAL;
+}
+
+float floorLoudness(double loudness) {
+    return (float)std::max<double>(loudness, loudnessFloor);
+}
+
+}
+
+LoudnessMeter::LoudnessMeter(double sampleRate, int numChannels):
+numChannels(juce::jlimit(1, 2, numChannels)),
+segmentSize(std::max(1, (int)std::lround(sampleRate * segmentDuration))),
+warmUpSize(std::max(1, (int)std::lround(sampleRate * 0.05))) {
+    // K-weighting pre-filter and RLB high pass for any sample rate, BS.1770-4 values at 48kHz
+    {
+        const double f0 = 1681.974450955533;
+        const double gain = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double vh = std::pow(10.0, gain / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        shelf.b1 = 2.0 * (k * k - vh) / a0;
+        shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        shelf.a2 = (1.0 - k / q + k * k) / a0;
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(juce::MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+        highPass.b0 = 1.0;
+        highPass.b1 = -2.0;
+        highPass.b2 = 1.0;
+        highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        highPass.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    // windowed sinc interpolator, each phase normalised to unity gain
+    const int numTaps = oversampling * tapsPerPhase;
+    interpolationTaps.resize((size_t)numTaps);
+    const double centre = (numTaps - 1) / 2.0;
+    for (int n=0; n<numTaps; n++) {
+        const double x = (n - centre) / oversampling;
+        const double sinc = x == 0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+        const double window = 0.42 - 0.5 * std::cos(2 * juce::MathConstants<double>::pi * n / (numTaps - 1))
+                                   + 0.08 * std::cos(4 * juce::MathConstants<double>::pi * n / (numTaps - 1));
+        interpolationTaps[(size_t)n] = (float)(sinc * window);
+    }
+    for (int phase=0; phase<oversampling; phase++) {
+        double sum = 0;
+        for (int k=0; k<tapsPerPhase; k++) {
+            sum += interpolationTaps[(size_t)(phase + k * oversampling)];
+        }
+        for (int k=0; k<tapsPerPhase; k++) {
+            interpolationTaps[(size_t)(phase + k * oversampling)] /= (float)sum;
+        }
+    }
+}
+
+int LoudnessMeter::getSegmentSize() const {
+    return segmentSize;
+}
+
+int LoudnessMeter::getWarmUpSize() const {
+    return warmUpSize;
+}
+
+void LoudnessMeter::reset() {
+    std::memset(state, 0, sizeof(state));
+    std::memset(history, 0, sizeof(history));
+    currentEnergy = 0;
+    currentPeak = 0;
+    currentSamples = 0;
+    segments.clear();
+}
+
+void LoudnessMeter::prime(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+    _run(buffer, startSample, numSamples, false);
+}
+
+void LoudnessMeter::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) {
+    _run(buffer, startSample, numSamples, true);
+}
+
+void LoudnessMeter::flush() {
+    if (currentSamples == 0) {
+        return;
+    }
+    segments.push_back({ (float)(currentEnergy / currentSamples), currentPeak });
+    currentEnergy = 0;
+    currentPeak = 0;
+    currentSamples = 0;
+}
+
+const std::vector<LoudnessMeter::Segment>& LoudnessMeter::getSegments() const {
+    return segments;
+}
+
+void LoudnessMeter::clearSegments() {
+    segments.clear();
+}
+
+void LoudnessMeter::_run(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples, bool measure) {
+    const int channels = std::min(numChannels, buffer.getNumChannels());
+    const float* data[2] = {};
+    for (int ch=0; ch<channels; ch++) {
+        data[ch] = buffer.getReadPointer(ch, startSample);
+    }
+    for (int i=0; i<numSamples; i++) {
+        for (int ch=0; ch<channels; ch++) {
+            const float x = data[ch][i];
+
+            // circular, newest sample at `historyIndex`
+            float* h = history[ch];
+            h[historyIndex] = x;
+
+            // K-weighting, transposed direct form II
+            double* s = state[ch];
+            const double y1 = shelf.b0 * x + s[0];
+            s[0] = shelf.b1 * x - shelf.a1 * y1 + s[1];
+            s[1] = shelf.b2 * x - shelf.a2 * y1;
+            const double y2 = highPass.b0 * y1 + s[2];
+            s[2] = highPass.b1 * y1 - highPass.a1 * y2 + s[3];
+            s[3] = highPass.b2 * y1 - highPass.a2 * y2;
+
+            if (!measure) {
+                continue;
+            }
+            currentEnergy += y2 * y2;
+
+            float peak = std::abs(x);
+            for (int phase=0; phase<oversampling; phase++) {
+                float y = 0;
+                for (int k=0; k<tapsPerPhase; k++) {
+                    y += interpolationTaps[(size_t)(phase + k * oversampling)] * h[(historyIndex - k + tapsPerPhase) % tapsPerPhase];
+                }
+                peak = std::max(peak, std::abs(y));
+            }
+            currentPeak = std::max(currentPeak, peak);
+        }
+        historyIndex = (historyIndex + 1) % tapsPerPhase;
+
+        if (measure && ++currentSamples == segmentSize) {
+            segments.push_back({ (float)(currentEnergy / segmentSize), currentPeak });
+            currentEnergy = 0;
+            currentPeak = 0;
+            currentSamples = 0;
+        }
+    }
+}
+
+MixerLoudness LoudnessMeter::getLoudness(const std::vector<Segment>& segments) {
+    MixerLoudness loudness;
+    const size_t count = segments.size();
+
+    float truePeak = 0;
+    std::vector<double> prefix(count + 1, 0);
+    for (size_t i=0; i<count; i++) {
+        prefix[i + 1] = prefix[i] + segments[i].energy;
+        truePeak = std::max(truePeak, segments[i].truePeak);
+    }
+    loudness.truePeak = floorLoudness(truePeak > 0 ? 20 * std::log10(truePeak) : -HUGE_VAL);
+
+    auto windowEnergies = [&](size_t length) {
+        std::vector<double> energies;
+        for (size_t i=0; i + length <= count; i++) {
+            energies.push_back((prefix[i + length] - prefix[i]) / length);
+        }
+        return energies;
+    };
+
+    // integrated, absolute gate then relative gate 10 LU below the absolute gated loudness
+    const std::vector<double> blocks = windowEnergies(segmentsPerMomentary);
+    double sum = 0;
+    size_t gated = 0;
+    double maxMomentary = 0;
+    for (double energy: blocks) {
+        maxMomentary = std::max(maxMomentary, energy);
+        if (energyToLoudness(energy) > loudnessFloor) {
+            sum += energy;
+            gated++;
+        }
+    }
+    loudness.maxMomentary = floorLoudness(energyToLoudness(maxMomentary));
+    if (gated > 0) {
+        const double relativeGate = energyToLoudness(sum / gated) - 10;
+        sum = 0;
+        gated = 0;
+        for (double energy: blocks) {
+            if (energyToLoudness(energy) > relativeGate) {
+                sum += energy;
+                gated++;
+            }
+        }
+        loudness.integrated = floorLoudness(gated > 0 ? energyToLoudness(sum / gated) : -HUGE_VAL);
+    }
+
+    // loudness range, 10th to 95th percentile of short-term loudness gated 20 LU below its mean
+    const std::vector<double> shortTerm = windowEnergies(segmentsPerShortTerm);
+    double maxShortTerm = 0;
+    std::vector<double> values;
+    sum = 0;
+    for (double energy: shortTerm) {
+        maxShortTerm = std::max(maxShortTerm, energy);
+        if (energyToLoudness(energy) > loudnessFloor) {
+            sum += energy;
+            values.push_back(energy);
+        }
+    }
+    loudness.maxShortTerm = floorLoudness(energyToLoudness(maxShortTerm));
+    if (!values.empty()) {
+        const double relativeGate = energyToLoudness(sum / values.size()) - 20;
+        std::vector<double> ranged;
+        for (double energy: values) {
+            const double value = energyToLoudness(energy);
+            if (value > relativeGate) {
+                ranged.push_back(value);
+            }
+        }
+        if (!ranged.empty()) {
+            std::sort(ranged.begin(), ranged.end());
+            const double low = ranged[(size_t)std::lround(0.10 * (ranged.size() - 1))];
+            const double high = ranged[(size_t)std::lround(0.95 * (ranged.size() - 1))];
+            loudness.loudnessRange = (float)(high - low);
+        }
+    }
+    return loudness;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Models.h"
+
+/// ITU-R BS.1770-4 / EBU R128 measurement of consecutive audio.
+/// Audio is K-weighted and reduced to 100ms segments of mean square energy and true peak, which can be
+/// stored and later combined into gated loudness with `getLoudness`.
+class LoudnessMeter {
+public:
+
+    struct Segment {
+        // sum over channels of the K-weighted mean square
+        float energy = 0;
+        // linear, 4x oversampled
+        float truePeak = 0;
+    };
+
+    /// measures the first `numChannels` channels (at most 2) of the audio passed in
+    LoudnessMeter(double sampleRate, int numChannels);
+
+    /// samples per segment
+    int getSegmentSize() const;
+
+    /// samples to `prime` before a segment boundary when starting in the middle of a signal
+    int getWarmUpSize() const;
+
+    /// clears filter state and segments
+    void reset();
+
+    /// runs the filters over audio that precedes the next `process` call without measuring it
+    void prime(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /// measures consecutive audio, adding a segment every `getSegmentSize` samples
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /// adds the partial segment at the end of the signal, if any
+    void flush();
+
+    /// segments since the last `reset` or `clearSegments`
+    const std::vector<Segment>& getSegments() const;
+
+    void clearSegments();
+
+    /// gated integrated, momentary, short-term loudness, loudness range and true peak of consecutive segments
+    static MixerLoudness getLoudness(const std::vector<Segment>& segments);
+
+private:
+
+    struct Biquad {
+        double b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    };
+
+    // 4 phases of 12 taps
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+
+    const int numChannels;
+    const int segmentSize;
+    const int warmUpSize;
+    Biquad shelf;
+    Biquad highPass;
+    std::vector<float> interpolationTaps;
+
+    // per channel filter state and true peak history
+    double state[2][4] = {};
+    float history[2][tapsPerPhase] = {};
+    int historyIndex = 0;
+
+    // segment being measured
+    double currentEnergy = 0;
+    float currentPeak = 0;
+    int currentSamples = 0;
+    std::vector<Segment> segments;
+
+    void _run(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples, bool measure);
+};
@@ -0,0 +1,141 @@
+#include "MixBus.h"
+
+void MixBus::attach(juce::AudioDeviceManager& manager) {
+    juce::AudioDeviceManager* previous;
+    {
+        std::lock_guard<std::mutex> guard(registryMutex);
+        if (this->manager == &manager) {
+            return;
+        }
+        previous = this->manager;
+        this->manager = &manager;
+    }
+    // starts the bus when the device is running, which takes `registryMutex`
+    if (previous != nullptr) {
+        previous->removeAudioCallback(this);
+    }
+    manager.addAudioCallback(this);
+}
+
+bool MixBus::add(Source* source) {
+    std::lock_guard<std::mutex> guard(registryMutex);
+    for (auto& slot: sources) {
+        if (slot.load() == source) {
+            return true;
+        }
+    }
+    for (auto& slot: sources) {
+        if (slot.load() == nullptr) {
+            if (juce::AudioIODevice* running = device.load()) {
+                source->busAboutToStart(running);
+            }
+            slot.store(source);
+            return true;
+        }
+    }
+    return false;
+}
+
+void MixBus::remove(Source* source) {
+    std::lock_guard<std::mutex> guard(registryMutex);
+    for (auto& slot: sources) {
+        if (slot.load() == source) {
+            slot.store(nullptr);
+        }
+    }
+    // a callback that started before the store may still use it, odd while one runs
+    const juce::uint32 sequence = callbackSequence.load();
+    if ((sequence & 1) != 0) {
+        while (callbackSequence.load() == sequence) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+int MixBus::getNumSources() const {
+    int count = 0;
+    for (auto& slot: sources) {
+        if (slot.load() != nullptr) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// MARK: juce::AudioIODeviceCallback
+void MixBus::audioDeviceAboutToStart(juce::AudioIODevice* device) {
+    std::lock_guard<std::mutex> guard(registryMutex);
+    const int numChannels = juce::jlimit(1, maxChannels, device->getActiveOutputChannels().countNumberOfSetBits());
+    sourceBuffer.setSize(numChannels, std::max(1, device->getCurrentBufferSizeSamples()));
+    lastSources.fill(nullptr);
+    lastGains.fill(0);
+    for (auto& slot: sources) {
+        if (Source* source = slot.load()) {
+            source->busAboutToStart(device);
+        }
+    }
+    this->device = device;
+}
+
+void MixBus::audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                              int numInputChannels,
+                                              float* const* outputChannelData,
+                                              int numOutputChannels,
+                                              int numSamples,
+                                              const juce::AudioIODeviceCallbackContext& context) {
+    callbackSequence++;
+    for (int ch=0; ch<numOutputChannels; ch++) {
+        juce::FloatVectorOperations::clear(outputChannelData[ch], numSamples);
+    }
+    numInputChannels = inputChannelData != nullptr ? std::min(numInputChannels, maxChannels) : 0;
+    numOutputChannels = std::min(numOutputChannels, maxChannels);
+
+    // devices may deliver more than the buffer size they announced, sources get at most that
+    std::array<const float*, maxChannels> input;
+    std::array<float*, maxChannels> output;
+    const int chunkSize = sourceBuffer.getNumSamples();
+    for (int start = 0; start < numSamples && chunkSize > 0; start += chunkSize) {
+        for (int ch=0; ch<numInputChannels; ch++) {
+            input[ch] = inputChannelData[ch] + start;
+        }
+        for (int ch=0; ch<numOutputChannels; ch++) {
+            output[ch] = outputChannelData[ch] + start;
+        }
+        _process(input.data(), numInputChannels, output.data(), numOutputChannels, std::min(chunkSize, numSamples - start));
+    }
+    callbackSequence++;
+}
+
+void MixBus::audioDeviceStopped() {
+    device = nullptr;
+}
+
+void MixBus::_process(const float* const* input, int numInputChannels, float* const* output, int numOutputChannels, int numSamples) {
+    // channels past the ones the bus was started with stay silent
+    const int numChannels = std::min(numOutputChannels, sourceBuffer.getNumChannels());
+    juce::AudioBuffer<float> outputBuffer(output, numChannels, numSamples);
+
+    for (int i=0; i<maxSources; i++) {
+        Source* source = sources[i].load();
+        if (source != lastSources[i]) {
+            // a new source starts at its gain instead of ramping from the previous one
+            lastSources[i] = source;
+            lastGains[i] = source != nullptr ? source->getBusGain() : 0;
+        }
+        if (source == nullptr) {
+            continue;
+        }
+        const float gain = source->getBusGain();
+        const bool audible = source->busProcess(input, numInputChannels, sourceBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+        if (audible && (gain != 0 || lastGains[i] != 0)) {
+            for (int ch=0; ch<numChannels; ch++) {
+                if (gain == lastGains[i]) {
+                    juce::FloatVectorOperations::addWithMultiply(output[ch], sourceBuffer.getReadPointer(ch), gain, numSamples);
+                } else {
+                    outputBuffer.addFromWithRamp(ch, 0, sourceBuffer.getReadPointer(ch), numSamples, lastGains[i], gain);
+                }
+            }
+        }
+        lastGains[i] = gain;
+    }
+}
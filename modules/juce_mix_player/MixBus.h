@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <mutex>
+
+/// One device callback for many players. Sources are kept in a fixed table of atomic slots, so the callback
+/// walks it without a lock while players are added and removed, and adds each source with its own gain.
+/// Each playing source still reads and resamples its own mix into its own buffer, only the device callback is
+/// shared. Sources that report silence are not added, idle and paused players return before taking their lock.
+class MixBus : public juce::AudioIODeviceCallback {
+public:
+
+    class Source {
+    public:
+
+        virtual ~Source() = default;
+
+        /// device start, on the thread that opens the device or the one adding the source to a running bus
+        virtual void busAboutToStart(juce::AudioIODevice* device) = 0;
+
+        /// Audio thread. Writes `numSamples` to every channel of `output`, returns false when it wrote nothing audible
+        /// and the bus can skip it. `output` may hold garbage afterwards then.
+        virtual bool busProcess(const float* const* input,
+                                int numInputChannels,
+                                float* const* output,
+                                int numOutputChannels,
+                                int numSamples) = 0;
+
+        /// linear, read once per callback and ramped from the previous one
+        virtual float getBusGain() const = 0;
+    };
+
+    static constexpr int maxSources = 32;
+    static constexpr int maxChannels = 32;
+
+    /// registers the bus on `manager` once, later calls with the same manager do nothing
+    void attach(juce::AudioDeviceManager& manager);
+
+    /// false when all slots are taken. Starts `source` first when the device is running.
+    bool add(Source* source);
+
+    /// After it returns the callback no longer uses `source`, waits for a callback in progress.
+    void remove(Source* source);
+
+    int getNumSources() const;
+
+    // MARK: juce::AudioIODeviceCallback
+    void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
+
+    void audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                          int numInputChannels,
+                                          float* const* outputChannelData,
+                                          int numOutputChannels,
+                                          int numSamples,
+                                          const juce::AudioIODeviceCallbackContext& context) override;
+
+    void audioDeviceStopped() override;
+
+private:
+
+    juce::AudioDeviceManager* manager = nullptr;
+    std::array<std::atomic<Source*>, maxSources> sources {};
+    // `add`, `remove` and device starts, never the audio callback
+    std::mutex registryMutex;
+    // incremented when a callback starts and when it ends
+    std::atomic<juce::uint32> callbackSequence { 0 };
+    std::atomic<juce::AudioIODevice*> device { nullptr };
+
+    // audio thread only: the source each slot had in the last callback and the gain it ended with
+    std::array<Source*, maxSources> lastSources {};
+    std::array<float, maxSources> lastGains {};
+    // one device buffer per source, sized when the device starts
+    juce::AudioBuffer<float> sourceBuffer;
+
+    void _process(const float* const* input, int numInputChannels, float* const* output, int numOutputChannels, int numSamples);
+};
@@ -0,0 +1,56 @@
+#include "MixKernels.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON || defined (__ARM_NEON)
+ #define JUCE_MIX_PLAYER_MIX_KERNELS_NEON 1
+ #include <arm_neon.h>
+#endif
+
+void MixKernels::addMonoToStereo(float* left, float* right, const float* source, float gain, int numSamples) {
+    int i = 0;
+#if JUCE_USE_SSE_INTRINSICS
+    const __m128 gainVector = _mm_set1_ps(gain);
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(source + i), gainVector);
+        _mm_storeu_ps(left + i, _mm_add_ps(_mm_loadu_ps(left + i), x));
+        _mm_storeu_ps(right + i, _mm_add_ps(_mm_loadu_ps(right + i), x));
+    }
+#elif JUCE_MIX_PLAYER_MIX_KERNELS_NEON
+    for (; i + 4 <= numSamples; i += 4) {
+        const float32x4_t x = vmulq_n_f32(vld1q_f32(source + i), gain);
+        vst1q_f32(left + i, vaddq_f32(vld1q_f32(left + i), x));
+        vst1q_f32(right + i, vaddq_f32(vld1q_f32(right + i), x));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        const float x = source[i] * gain;
+        left[i] += x;
+        right[i] += x;
+    }
+}
+
+void MixKernels::addChannels(juce::AudioBuffer<float>& output,
+                             int outputStart,
+                             const juce::AudioBuffer<float>& source,
+                             int numSourceChannels,
+                             int sourceStart,
+                             int numSamples,
+                             float gain) {
+    const int numOutputChannels = output.getNumChannels();
+    if (numSamples <= 0 || numSourceChannels <= 0 || gain == 0) {
+        return;
+    }
+    int ch = 0;
+    if (numSourceChannels == 1 && numOutputChannels >= 2) {
+        addMonoToStereo(output.getWritePointer(0, outputStart),
+                        output.getWritePointer(1, outputStart),
+                        source.getReadPointer(0, sourceStart),
+                        gain,
+                        numSamples);
+        ch = 2;
+    }
+    for (; ch<numOutputChannels; ch++) {
+        output.addFrom(ch, outputStart, source, ch < numSourceChannels ? ch : 0, sourceStart, numSamples, gain);
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/// Inner loops of the mixer for sources at their own channel count. A mono source is added to both
+/// sides in one pass, so it's decoded, stored and read once instead of being copied to a second channel.
+class MixKernels {
+public:
+
+    /// `left` and `right` += `gain` x `source`
+    static void addMonoToStereo(float* left, float* right, const float* source, float gain, int numSamples);
+
+    /// Adds `numSamples` of the first `numSourceChannels` of `source` from `sourceStart` to `output` from `outputStart`.
+    /// Output channels past the source's get its first channel. Doesn't allocate, safe on the audio thread.
+    static void addChannels(juce::AudioBuffer<float>& output,
+                            int outputStart,
+                            const juce::AudioBuffer<float>& source,
+                            int numSourceChannels,
+                            int sourceStart,
+                            int numSamples,
+                            float gain);
+};
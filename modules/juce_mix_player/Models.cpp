@@ -27,6 +27,87 @@ void MixerModel::isValid(MixerSettings& settings) {
     if (settings.sampleRate <= 0) {
         throw std::runtime_error("sampleRate < 0");
     }
+    if (settings.maxLookAhead <= 0) {
+        throw std::runtime_error("maxLookAhead < 0");
+    }
+    if (settings.maxBufferedDuration <= 0) {
+        throw std::runtime_error("maxBufferedDuration < 0");
+    }
+    if (settings.startMargin < 0) {
+        throw std::runtime_error("startMargin < 0");
+    }
+    if (settings.levelFrameDuration < 0) {
+        throw std::runtime_error("levelFrameDuration < 0");
+    }
+    if (settings.loudnessTarget > 0) {
+        throw std::runtime_error("loudnessTarget > 0");
+    }
+    if (settings.resamplerQuality < 0 || settings.resamplerQuality > 2) {
+        throw std::runtime_error("resamplerQuality not in 0...2");
+    }
+    if (settings.compressedCacheSize < 0) {
+        throw std::runtime_error("compressedCacheSize < 0");
+    }
+}
+
+void MixerModel::apply(MixerData& mixerData, const std::vector<MixerTrackUpdate>& updates) {
+    std::vector<MixerTrack> tracks = mixerData.tracks;
+    for (const MixerTrackUpdate& update: updates) {
+        int index = update.index;
+        if (!update.id.empty()) {
+            auto it = std::find_if(tracks.begin(), tracks.end(), [&](const MixerTrack& track) {
+                return track.id_ == update.id;
+            });
+            if (it == tracks.end()) {
+                throw std::runtime_error("unknown track id " + update.id);
+            }
+            index = (int)(it - tracks.begin());
+        } else if (index < 0 || index >= (int)tracks.size()) {
+            throw std::runtime_error("track index " + std::to_string(index) + " out of range");
+        }
+        if (!std::isfinite(update.value)) {
+            throw std::runtime_error("track value not finite");
+        }
+        MixerTrack& track = tracks[(size_t)index];
+        switch (update.param) {
+            case MixerTrackParam::VOLUME:
+                track.volume = update.value;
+                break;
+            case MixerTrackParam::OFFSET:
+                if (update.value < 0) {
+                    throw std::runtime_error("`offset` < 0");
+                }
+                track.offset = update.value;
+                break;
+            case MixerTrackParam::FROM_TIME:
+                if (update.value < 0) {
+                    throw std::runtime_error("`fromTime` < 0");
+                }
+                track.fromTime = update.value;
+                break;
+            case MixerTrackParam::DURATION:
+                if (update.value < 0) {
+                    throw std::runtime_error("`duration` < 0");
+                }
+                track.duration = update.value;
+                break;
+            case MixerTrackParam::ENABLED:
+                track.enabled = update.value != 0;
+                break;
+            case MixerTrackParam::REPEAT:
+                track.repeat = update.value != 0;
+                break;
+            case MixerTrackParam::REPEAT_INTERVAL:
+                if (update.value < 0) {
+                    throw std::runtime_error("`repeatInterval` < 0");
+                }
+                track.repeatInterval = update.value;
+                break;
+            default:
+                throw std::runtime_error("unknown track param " + std::to_string((int)update.param));
+        }
+    }
+    mixerData.tracks.swap(tracks);
 }
 
 void MixerModel::isValid(MixerData& mixerData) {
@@ -52,6 +133,26 @@ void MixerModel::isValid(MixerData& mixerData) {
         }
         set.insert(track.id_);
     }
+    const MixerMetronome& metronome = mixerData.metronome;
+    if (metronome.enabled) {
+        if (metronome.bpm <= 0) {
+            throw std::runtime_error("metronome `bpm` <= 0");
+        }
+        if (metronome.beatsPerBar < 1) {
+            throw std::runtime_error("metronome `beatsPerBar` < 1");
+        }
+        if (metronome.beatUnit < 1) {
+            throw std::runtime_error("metronome `beatUnit` < 1");
+        }
+        if (metronome.offset < 0) {
+            throw std::runtime_error("metronome `offset` < 0");
+        }
+        for (int accent: metronome.accents) {
+            if (accent < 0 || accent > 2) {
+                throw std::runtime_error("metronome `accents` must be 0, 1 or 2");
+            }
+        }
+    }
 }
 
 float MixerModel::getTotalDuration(MixerData& mixerData) {
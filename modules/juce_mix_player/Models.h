@@ -3,6 +3,7 @@
 #include "nlohmann/json.hpp"
 
 typedef void (*JuceMixPlayerCallbackFloat)(void*, float);
+/// the string belongs to the callee, which frees it with `freeCopyChar` once read
 typedef void (*JuceMixPlayerCallbackString)(void*, const char*);
 
 enum class JuceMixPlayerState {
@@ -35,6 +36,16 @@ NLOHMANN_JSON_SERIALIZE_ENUM(JuceMixPlayerState,{
 
 std::string JuceMixPlayerState_toString(JuceMixPlayerState state);
 
+enum class MixerBufferState {
+    RENDERED, LOADING, EVICTED
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(MixerBufferState,{
+    {MixerBufferState::RENDERED, "RENDERED"},
+    {MixerBufferState::LOADING, "LOADING"},
+    {MixerBufferState::EVICTED, "EVICTED"},
+});
+
 struct MixerDevice {
     std::string name = "";
     bool isInput = false;
@@ -90,6 +101,8 @@ struct MixerDeviceList {
 struct MixerSettings {
     // seconds
     float progressUpdateInterval = 0.05;
+    // progress, recording time and level callbacks every `progressUpdateInterval`, off for hosts that poll the transport
+    bool progressCallbacks = true;
     // player and recorder sample rate
     int sampleRate = 48000;
     // stop record on playback ends
@@ -102,15 +115,47 @@ struct MixerSettings {
     bool enableMicMonitoring = false;
     // disallow bluetooth mic
     bool dissallowBluetoothMic = false; // iOS only, default false
+    // seconds, upper limit for how far ahead of the playhead audio is rendered
+    float maxLookAhead = 30;
+    // seconds, rendered audio kept in memory, pages farthest from the playhead are evicted first
+    float maxBufferedDuration = 120;
+    // seconds, rendered from the start before READY is sent
+    float startMargin = 0.5;
+    // render the rest of the timeline in the background when the look-ahead is full, within `maxBufferedDuration`
+    bool backgroundFill = true;
+    // seconds, each live level frame covers this much device audio, 0 disables the level stream
+    float levelFrameDuration = 0.01;
+    // scale each track to `loudnessTarget` integrated loudness once it is analysed, limited to -1 dBTP
+    bool loudnessMatch = false;
+    // LUFS
+    float loudnessTarget = -16;
+    // when the device rate isn't `sampleRate`: 0 linear, 1 windowed sinc 16 taps, 2 windowed sinc 32 taps (2x CPU of 1)
+    int resamplerQuality = 1;
+    // keep rendered pages as 16 bit integers, half the memory for the same `maxBufferedDuration`, clips beyond 0 dBFS
+    bool compactBuffer = false;
+    // MB of evicted `compactBuffer` pages kept losslessly compressed and restored without mixing again, 0 disables.
+    // Float pages aren't cached, they would come back as 16 bit.
+    float compressedCacheSize = 0;
 
     NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(MixerSettings,
                                                 progressUpdateInterval,
+                                                progressCallbacks,
                                                 sampleRate,
                                                 loop,
                                                 recBgPlayback,
                                                 stopRecOnPlaybackComplete,
                                                 enableMicMonitoring,
-                                                dissallowBluetoothMic);
+                                                dissallowBluetoothMic,
+                                                maxLookAhead,
+                                                maxBufferedDuration,
+                                                startMargin,
+                                                backgroundFill,
+                                                levelFrameDuration,
+                                                loudnessMatch,
+                                                loudnessTarget,
+                                                resamplerQuality,
+                                                compactBuffer,
+                                                compressedCacheSize);
 };
 
 struct MixerTrack {
@@ -167,6 +212,53 @@ struct MixerTrack {
     }
 
     std::shared_ptr<juce::AudioFormatReader> reader;
+
+    // whole file of repeat tracks, played by `OneShotSampler`
+    std::shared_ptr<const juce::AudioBuffer<float>> sample;
+
+    // applied with `volume`, from `MixerSettings.loudnessMatch`
+    float loudnessGain = 1;
+};
+
+struct MixerMetronome {
+
+    // default value `false`
+    bool enabled = false;
+
+    // quarter notes per minute
+    float bpm = 120;
+
+    // time signature, clicks per bar
+    int beatsPerBar = 4;
+
+    // time signature, note value of one click, e.g. 8 clicks eighth notes
+    int beatUnit = 4;
+
+    // per beat of the bar: 0 silent, 1 click, 2 accent. Empty accents the first beat.
+    std::vector<int> accents = {};
+
+    // delay of the first bar in seconds
+    float offset = 0;
+
+    float volume = 1;
+
+    // optional audio files for the clicks, empty uses synthesised clicks
+    std::string clickPath = "";
+    std::string accentPath = "";
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(MixerMetronome,
+                                                enabled,
+                                                bpm,
+                                                beatsPerBar,
+                                                beatUnit,
+                                                accents,
+                                                offset,
+                                                volume,
+                                                clickPath,
+                                                accentPath);
+
+    std::shared_ptr<const juce::AudioBuffer<float>> clickSample;
+    std::shared_ptr<const juce::AudioBuffer<float>> accentSample;
 };
 
 struct MixerData {
@@ -179,10 +271,14 @@ struct MixerData {
     // strict output duration in seconds, else default value `0` means dynamic.
     float outputDuration = 0;
 
+    // click track over the whole output, played like repeat tracks
+    MixerMetronome metronome;
+
     NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(MixerData,
                                                 tracks,
                                                 outputDuration,
-                                                output);
+                                                output,
+                                                metronome);
 
     bool operator==(const MixerData& other) const {
         return
@@ -192,6 +288,26 @@ struct MixerData {
 
 };
 
+/// field of a `MixerTrack`, the values are part of the C API
+enum class MixerTrackParam {
+    VOLUME = 0,
+    OFFSET = 1,
+    FROM_TIME = 2,
+    DURATION = 3,
+    ENABLED = 4,
+    REPEAT = 5,
+    REPEAT_INTERVAL = 6
+};
+
+/// one field of the track with `id`, or at `index` in `MixerData.tracks` when `id` is empty.
+/// Booleans are `value != 0`.
+struct MixerTrackUpdate {
+    int index = 0;
+    MixerTrackParam param = MixerTrackParam::VOLUME;
+    float value = 0;
+    std::string id;
+};
+
 class MixerModel {
 public:
     static MixerData parse(const char* json);
@@ -202,6 +318,9 @@ public:
 
     static void isValid(MixerSettings& settings);
 
+    /// Applies all of `updates` or throws on the first invalid one, `mixerData` is unchanged then.
+    static void apply(MixerData& mixerData, const std::vector<MixerTrackUpdate>& updates);
+
     /// Returns total duration in seconds. Requires reader for each track.
     static float getTotalDuration(MixerData& mixerData);
 };
@@ -230,3 +349,89 @@ struct DeviceLaencyInfo {
                                                 timeDiff,
                                                 sampleRate);
 };
+
+/// EBU R128 measurements, loudness values are floored at -70 LUFS (silence)
+struct MixerLoudness {
+
+    // LUFS
+    float integrated = -70;
+    float maxMomentary = -70;
+    float maxShortTerm = -70;
+
+    // LU
+    float loudnessRange = 0;
+
+    // dBTP, floored at -70
+    float truePeak = -70;
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(MixerLoudness,
+                                                integrated,
+                                                maxMomentary,
+                                                maxShortTerm,
+                                                loudnessRange,
+                                                truePeak);
+};
+
+struct MixerRenderStats {
+
+    // rendered output
+    float duration = 0; // seconds
+    int sampleRate = 0;
+    int blocks = 0;
+
+    // millis
+    double parseTime = 0;
+    double openReadersTime = 0;
+    double renderTime = 0;
+    double writeTime = 0;
+    double blockTimeMin = 0;
+    double blockTimeMax = 0;
+    double blockTimeAvg = 0;
+
+    // rendered seconds per wall clock second
+    double realtimeFactor = 0;
+
+    // of the rendered mix
+    MixerLoudness loudness;
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(MixerRenderStats,
+                                                duration,
+                                                sampleRate,
+                                                blocks,
+                                                parseTime,
+                                                openReadersTime,
+                                                renderTime,
+                                                writeTime,
+                                                blockTimeMin,
+                                                blockTimeMax,
+                                                blockTimeAvg,
+                                                realtimeFactor,
+                                                loudness);
+};
+
+struct MixerBufferedRange {
+
+    // seconds
+    float start = 0;
+    float end = 0;
+
+    MixerBufferState state = MixerBufferState::RENDERED;
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(MixerBufferedRange,
+                                                start,
+                                                end,
+                                                state);
+};
+
+struct MixerBufferedRanges {
+
+    // seconds
+    float duration = 0;
+
+    // ordered by `start`, time not listed is not buffered
+    std::vector<MixerBufferedRange> ranges = {};
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(MixerBufferedRanges,
+                                                duration,
+                                                ranges);
+};
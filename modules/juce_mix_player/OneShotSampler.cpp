@@ -0,0 +1,57 @@
+#include "OneShotSampler.h"
+#include <cmath>
+
+void OneShotSampler::add(Pattern pattern) {
+    if (pattern.sample && pattern.sample->getNumSamples() > 0) {
+        patterns.push_back(std::move(pattern));
+    }
+}
+
+bool OneShotSampler::isEmpty() const {
+    return patterns.empty();
+}
+
+void OneShotSampler::render(juce::AudioBuffer<float>& output, int outputStart, juce::int64 timelineStart, int numSamples) const {
+    const juce::int64 timelineEnd = timelineStart + numSamples;
+
+    for (const Pattern& pattern: patterns) {
+        const juce::AudioBuffer<float>& sample = *pattern.sample;
+        const juce::int64 length = sample.getNumSamples();
+
+        // hits starting before the range ends and ending after it starts, one extra on both ends for the rounding
+        juce::int64 first = 0;
+        juce::int64 last = 0;
+        if (pattern.interval > 0) {
+            first = std::max<juce::int64>(0, (juce::int64)std::floor((timelineStart - length - pattern.offset) / pattern.interval));
+            last = (juce::int64)std::floor((timelineEnd - pattern.offset) / pattern.interval);
+        }
+
+        for (juce::int64 hit = first; hit <= last; hit++) {
+            // from the first hit every time, no error accumulates
+            const juce::int64 hitStart = std::llround(pattern.offset + hit * pattern.interval);
+            if (hitStart >= timelineEnd) {
+                break;
+            }
+            if (hitStart + length <= timelineStart) {
+                continue;
+            }
+            const int writePos = (int)std::max<juce::int64>(hitStart - timelineStart, 0);
+            const int readPos = (int)std::max<juce::int64>(timelineStart - hitStart, 0);
+            const int count = std::min((int)length - readPos, numSamples - writePos);
+            MixKernels::addChannels(output, outputStart + writePos, sample, sample.getNumChannels(), readPos, count, pattern.gain);
+        }
+    }
+}
+
+std::shared_ptr<const juce::AudioBuffer<float>> OneShotSampler::synthesizeClick(double sampleRate, double frequency, float level) {
+    // 30ms, fast exponential decay and a linear fade so it ends at zero
+    const int length = std::max(1, (int)(0.03 * sampleRate));
+    auto click = std::make_shared<juce::AudioBuffer<float>>(1, length);
+    float* data = click->getWritePointer(0);
+    for (int i=0; i<length; i++) {
+        const double time = i / sampleRate;
+        const double envelope = std::exp(-time / 0.006) * (1.0 - (double)i / length);
+        data[i] = (float)(level * envelope * std::sin(juce::MathConstants<double>::twoPi * frequency * time));
+    }
+    return click;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MixKernels.h"
+
+/// Plays cached one-shot samples at `offset + n * interval` of the timeline, e.g. the metronome clicks of repeat tracks.
+/// The hits around a position are computed from it directly, so nothing is pre-rendered and any range can be
+/// rendered in constant time, including from the audio callback.
+class OneShotSampler {
+public:
+
+    struct Pattern {
+        std::shared_ptr<const juce::AudioBuffer<float>> sample;
+        // timeline samples of the first hit, fractional positions are rounded per hit and never drift
+        double offset = 0;
+        // timeline samples between hits, 0 plays the sample once
+        double interval = 0;
+        float gain = 1;
+    };
+
+    void add(Pattern pattern);
+
+    bool isEmpty() const;
+
+    /// Adds the hits that overlap `numSamples` from timeline sample `timelineStart` to `output` from `outputStart`.
+    /// Doesn't allocate, safe on the audio thread.
+    void render(juce::AudioBuffer<float>& output, int outputStart, juce::int64 timelineStart, int numSamples) const;
+
+    /// mono metronome click, a decaying sine burst of `frequency`
+    static std::shared_ptr<const juce::AudioBuffer<float>> synthesizeClick(double sampleRate, double frequency, float level);
+
+private:
+
+    std::vector<Pattern> patterns;
+};
@@ -0,0 +1,345 @@
+#include "PlayBuffer.h"
+#include <cmath>
+#include <cstring>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON || defined (__ARM_NEON)
+ #define JUCE_MIX_PLAYER_PLAY_BUFFER_NEON 1
+ #include <arm_neon.h>
+#endif
+
+namespace {
+
+// full scale of INT16 pages
+constexpr float int16Scale = 32767.0f;
+
+/// clips to +-1 and rounds to the nearest step, ties to even like the vector conversions
+void narrowToInt16(const float* source, juce::int16* dest, int numSamples) {
+    int i = 0;
+#if JUCE_USE_SSE_INTRINSICS
+    const __m128 scale = _mm_set1_ps(int16Scale);
+    const __m128 low = _mm_set1_ps(-1.0f);
+    const __m128 high = _mm_set1_ps(1.0f);
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i), low), high), scale);
+        const __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4), low), high), scale);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#elif JUCE_MIX_PLAYER_PLAY_BUFFER_NEON && defined (__aarch64__)
+    const float32x4_t low = vdupq_n_f32(-1.0f);
+    const float32x4_t high = vdupq_n_f32(1.0f);
+    for (; i + 8 <= numSamples; i += 8) {
+        const float32x4_t a = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(source + i), low), high), int16Scale);
+        const float32x4_t b = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(source + i + 4), low), high), int16Scale);
+        vst1q_s16(dest + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)), vqmovn_s32(vcvtnq_s32_f32(b))));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        dest[i] = (juce::int16)std::lrint(juce::jlimit(-1.0f, 1.0f, source[i]) * int16Scale);
+    }
+}
+
+void expandFromInt16(const juce::int16* source, float* dest, int numSamples) {
+    const float scale = 1.0f / int16Scale;
+    int i = 0;
+#if JUCE_USE_SSE_INTRINSICS
+    const __m128 scaleVector = _mm_set1_ps(scale);
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        // sign extends each sample from the high half of a 32 bit lane
+        const __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(a), scaleVector));
+        _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), scaleVector));
+    }
+#elif JUCE_MIX_PLAYER_PLAY_BUFFER_NEON
+    for (; i + 8 <= numSamples; i += 8) {
+        const int16x8_t x = vld1q_s16(source + i);
+        vst1q_f32(dest + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+        vst1q_f32(dest + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+    }
+#endif
+    for (; i < numSamples; i++) {
+        dest[i] = source[i] * scale;
+    }
+}
+
+}
+
+PlayBuffer::PageAudio::PageAudio(SampleFormat format, int numChannels, int pageSize)
+: format(format), numChannels(numChannels), pageSize(pageSize) {
+    if (format == SampleFormat::INT16) {
+        // value initialised, silence
+        compactAudio.reset(new juce::int16[(size_t)numChannels * (size_t)pageSize]());
+    } else {
+        audio.reset(new juce::AudioBuffer<float>(numChannels, pageSize));
+        audio->clear();
+    }
+}
+
+size_t PlayBuffer::PageAudio::getNumBytes() const {
+    return (size_t)numChannels * (size_t)pageSize * (format == SampleFormat::INT16 ? sizeof(juce::int16) : sizeof(float));
+}
+
+void PlayBuffer::PageAudio::read(juce::int16* dest) const {
+    if (compactAudio != nullptr) {
+        std::memcpy(dest, compactAudio.get(), (size_t)numChannels * (size_t)pageSize * sizeof(juce::int16));
+    } else {
+        for (int ch=0; ch<numChannels; ch++) {
+            narrowToInt16(audio->getReadPointer(ch), dest + ch * pageSize, pageSize);
+        }
+    }
+}
+
+void PlayBuffer::setSize(int numChannels, int numSamples, int pageSize, ReleasedPages* released) {
+    for (Page& page: pages) {
+        release(page, released);
+    }
+    this->numChannels = std::max(0, numChannels);
+    this->numSamples = std::max(0, numSamples);
+    this->pageSize = std::max(1, pageSize);
+    pages.clear();
+    pages.resize((this->numSamples + this->pageSize - 1) / this->pageSize);
+    numAllocatedPages = 0;
+    numAllocatedBytes = 0;
+    numCompressedBytes = 0;
+    generation++;
+}
+
+void PlayBuffer::clear(ReleasedPages* released) {
+    for (Page& page: pages) {
+        page.state = PageState::EMPTY;
+        release(page, released);
+        page.compressed.reset();
+    }
+    numCompressedBytes = 0;
+    generation++;
+}
+
+void PlayBuffer::markStale() {
+    markStale({ 0, numSamples });
+}
+
+void PlayBuffer::markStale(juce::Range<int> range) {
+    range = range.getIntersectionWith({ 0, numSamples });
+    if (!range.isEmpty()) {
+        for (int i = getPageForSample(range.getStart()); i <= getPageForSample(range.getEnd() - 1); i++) {
+            Page& page = pages[i];
+            if (page.state == PageState::RENDERED) {
+                page.state = PageState::STALE;
+            } else if (page.state == PageState::EVICTED) {
+                page.state = PageState::EMPTY;
+            }
+            setCompressedPage(i, nullptr);
+        }
+    }
+    // copies in flight can be of the marked pages
+    generation++;
+}
+
+int PlayBuffer::getNumChannels() const {
+    return numChannels;
+}
+
+int PlayBuffer::getNumSamples() const {
+    return numSamples;
+}
+
+int PlayBuffer::getPageSize() const {
+    return pageSize;
+}
+
+int PlayBuffer::getNumPages() const {
+    return (int)pages.size();
+}
+
+int PlayBuffer::getPageForSample(int sample) const {
+    return sample / pageSize;
+}
+
+juce::Range<int> PlayBuffer::getPageRange(int page) const {
+    const int start = page * pageSize;
+    return { start, std::min(numSamples, start + pageSize) };
+}
+
+PlayBuffer::PageState PlayBuffer::getPageState(int page) const {
+    if (page < 0 || page >= (int)pages.size()) {
+        return PageState::EMPTY;
+    }
+    return pages[page].state;
+}
+
+void PlayBuffer::setPageState(int page, PageState state) {
+    if (page >= 0 && page < (int)pages.size()) {
+        pages[page].state = state;
+    }
+}
+
+bool PlayBuffer::isPageAllocated(int page) const {
+    return page >= 0 && page < (int)pages.size() && pages[page].audio != nullptr;
+}
+
+int PlayBuffer::getNumAllocatedPages() const {
+    return numAllocatedPages;
+}
+
+size_t PlayBuffer::getNumAllocatedBytes() const {
+    return numAllocatedBytes;
+}
+
+void PlayBuffer::setSampleFormat(SampleFormat format) {
+    sampleFormat = format;
+}
+
+PlayBuffer::SampleFormat PlayBuffer::getSampleFormat() const {
+    return sampleFormat;
+}
+
+std::shared_ptr<PlayBuffer::PageAudio> PlayBuffer::attachPageAudio(int page, std::shared_ptr<PageAudio> audio) {
+    if (page < 0 || page >= (int)pages.size() || audio == nullptr || pages[page].audio != nullptr
+        || audio->format != sampleFormat || audio->numChannels != numChannels || audio->pageSize != pageSize) {
+        return audio;
+    }
+    numAllocatedBytes += audio->getNumBytes();
+    numAllocatedPages++;
+    pages[page].audio = std::move(audio);
+    return nullptr;
+}
+
+void PlayBuffer::write(int startSample, const juce::AudioBuffer<float>& source, int sourceStartSample, int numSamples) {
+    const int end = std::min(this->numSamples, startSample + numSamples);
+    int position = std::max(0, startSample);
+    while (position < end) {
+        Page& page = pages[position / pageSize];
+        const int offset = position % pageSize;
+        const int count = std::min(end - position, pageSize - offset);
+        allocate(page);
+        for (int ch=0; ch<numChannels; ch++) {
+            const int sourceChannel = std::min(ch, source.getNumChannels() - 1);
+            const int sourcePosition = sourceStartSample + position - startSample;
+            if (page.audio->compactAudio != nullptr) {
+                narrowToInt16(source.getReadPointer(sourceChannel, sourcePosition), page.audio->compactAudio.get() + ch * pageSize + offset, count);
+            } else {
+                page.audio->audio->copyFrom(ch, offset, source, sourceChannel, sourcePosition, count);
+            }
+        }
+        position += count;
+    }
+}
+
+bool PlayBuffer::read(int startSample, juce::AudioBuffer<float>& dest, int destStartSample, int numSamples) const {
+    bool complete = true;
+    const int channels = std::min(numChannels, dest.getNumChannels());
+    int position = startSample;
+    const int end = startSample + numSamples;
+    while (position < end) {
+        const int destPosition = destStartSample + position - startSample;
+        if (position < 0 || position >= this->numSamples) {
+            // outside the timeline, silence up to the next valid sample
+            const int count = position < 0 ? std::min(end, 0) - position : end - position;
+            dest.clear(destPosition, count);
+            position += count;
+            complete = false;
+            continue;
+        }
+        const Page& page = pages[position / pageSize];
+        const int offset = position % pageSize;
+        const int count = std::min(end - position, pageSize - offset);
+        if (page.audio == nullptr) {
+            dest.clear(destPosition, count);
+            complete = false;
+        } else if (page.audio->compactAudio != nullptr) {
+            for (int ch=0; ch<channels; ch++) {
+                expandFromInt16(page.audio->compactAudio.get() + ch * pageSize + offset, dest.getWritePointer(ch, destPosition), count);
+            }
+        } else {
+            for (int ch=0; ch<channels; ch++) {
+                dest.copyFrom(ch, destPosition, *page.audio->audio, ch, offset, count);
+            }
+        }
+        position += count;
+    }
+    return complete;
+}
+
+void PlayBuffer::evict(int page, ReleasedPages* released) {
+    if (page < 0 || page >= (int)pages.size()) {
+        return;
+    }
+    Page& p = pages[page];
+    release(p, released);
+    p.state = p.state == PageState::RENDERED ? PageState::EVICTED : PageState::EMPTY;
+}
+
+std::shared_ptr<const PlayBuffer::PageAudio> PlayBuffer::getPageAudio(int page) const {
+    if (page < 0 || page >= (int)pages.size()) {
+        return nullptr;
+    }
+    return pages[page].audio;
+}
+
+void PlayBuffer::writePage(int page, const juce::int16* source) {
+    if (page < 0 || page >= (int)pages.size()) {
+        return;
+    }
+    Page& p = pages[page];
+    allocate(p);
+    if (p.audio->compactAudio != nullptr) {
+        std::memcpy(p.audio->compactAudio.get(), source, (size_t)numChannels * (size_t)pageSize * sizeof(juce::int16));
+    } else {
+        for (int ch=0; ch<numChannels; ch++) {
+            expandFromInt16(source + ch * pageSize, p.audio->audio->getWritePointer(ch), pageSize);
+        }
+    }
+}
+
+void PlayBuffer::setCompressedPage(int page, std::shared_ptr<const std::vector<juce::uint8>> data) {
+    if (page < 0 || page >= (int)pages.size()) {
+        return;
+    }
+    Page& p = pages[page];
+    if (p.compressed != nullptr) {
+        numCompressedBytes -= p.compressed->size();
+    }
+    p.compressed = std::move(data);
+    if (p.compressed != nullptr) {
+        numCompressedBytes += p.compressed->size();
+    }
+}
+
+std::shared_ptr<const std::vector<juce::uint8>> PlayBuffer::getCompressedPage(int page) const {
+    if (page < 0 || page >= (int)pages.size()) {
+        return nullptr;
+    }
+    return pages[page].compressed;
+}
+
+size_t PlayBuffer::getNumCompressedBytes() const {
+    return numCompressedBytes;
+}
+
+int PlayBuffer::getGeneration() const {
+    return generation;
+}
+
+void PlayBuffer::allocate(Page& page) {
+    if (page.audio != nullptr) {
+        return;
+    }
+    page.audio = std::make_shared<PageAudio>(sampleFormat, numChannels, pageSize);
+    numAllocatedBytes += page.audio->getNumBytes();
+    numAllocatedPages++;
+}
+
+void PlayBuffer::release(Page& page, ReleasedPages* released) {
+    if (page.audio == nullptr) {
+        return;
+    }
+    numAllocatedBytes -= page.audio->getNumBytes();
+    numAllocatedPages--;
+    if (released != nullptr) {
+        released->push_back(std::move(page.audio));
+    }
+    page.audio.reset();
+}
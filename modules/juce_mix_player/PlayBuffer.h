@@ -0,0 +1,141 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/// Rendered timeline split into fixed size pages. A page gets its memory when it is first written and
+/// releases it on eviction, so memory follows what is buffered rather than the timeline length.
+/// Pages are float or, to halve their memory, 16 bit integers converted when written and read.
+/// Not thread safe, `JuceMixPlayer` guards it with the audio callback lock. Page memory can be allocated before
+/// that lock is taken and freed after it is released, see `attachPageAudio` and `ReleasedPages`.
+class PlayBuffer {
+public:
+
+    enum class PageState {
+        // STALE pages hold an older mix of the same timeline, played until they are rendered again
+        EMPTY, LOADING, RENDERED, EVICTED, STALE
+    };
+
+    enum class SampleFormat {
+        FLOAT32, INT16
+    };
+
+    /// memory of one page, `numChannels` runs of `pageSize` samples, silence when allocated
+    struct PageAudio {
+        PageAudio(SampleFormat format, int numChannels, int pageSize);
+
+        const SampleFormat format;
+        const int numChannels;
+        const int pageSize;
+        // one of them is allocated
+        std::unique_ptr<juce::AudioBuffer<float>> audio;
+        // `pageSize` samples per channel, one channel after the other
+        std::unique_ptr<juce::int16[]> compactAudio;
+
+        size_t getNumBytes() const;
+
+        /// as 16 bit, `numChannels` runs of `pageSize` samples into `dest`
+        void read(juce::int16* dest) const;
+    };
+
+    /// page memory dropped by `setSize`, `clear` or `evict`, freed when this goes out of scope after the lock
+    using ReleasedPages = std::vector<std::shared_ptr<PageAudio>>;
+
+    /// drops all pages, their memory goes to `released` when given
+    void setSize(int numChannels, int numSamples, int pageSize, ReleasedPages* released = nullptr);
+
+    /// drops all pages, keeps the size
+    void clear(ReleasedPages* released = nullptr);
+
+    /// Rendered pages become STALE and keep their audio, evicted ones EMPTY. Drops the compressed pages.
+    void markStale();
+
+    /// `markStale` for the pages that intersect `range` of the timeline
+    void markStale(juce::Range<int> range);
+
+    int getNumChannels() const;
+
+    int getNumSamples() const;
+
+    int getPageSize() const;
+
+    int getNumPages() const;
+
+    int getPageForSample(int sample) const;
+
+    /// timeline samples covered by `page`, the last page can be shorter
+    juce::Range<int> getPageRange(int page) const;
+
+    PageState getPageState(int page) const;
+
+    void setPageState(int page, PageState state);
+
+    bool isPageAllocated(int page) const;
+
+    int getNumAllocatedPages() const;
+
+    /// memory of the allocated pages
+    size_t getNumAllocatedBytes() const;
+
+    /// format of the pages allocated from now on, allocated pages keep theirs until they are evicted.
+    /// INT16 clips samples beyond +-1.
+    void setSampleFormat(SampleFormat format);
+
+    SampleFormat getSampleFormat() const;
+
+    /// Gives `page` memory allocated without the lock, unless it has memory. Returns `audio` when it isn't used,
+    /// e.g. the format or size changed meanwhile.
+    std::shared_ptr<PageAudio> attachPageAudio(int page, std::shared_ptr<PageAudio> audio);
+
+    /// copies `numSamples` of `source` to the timeline at `startSample`, allocating pages that have no memory
+    void write(int startSample, const juce::AudioBuffer<float>& source, int sourceStartSample, int numSamples);
+
+    /// copies `numSamples` from the timeline at `startSample` into `dest`.
+    /// Missing pages and samples past the end read as silence, returns false if any were hit.
+    bool read(int startSample, juce::AudioBuffer<float>& dest, int destStartSample, int numSamples) const;
+
+    /// drops the page memory, state becomes EVICTED when it was rendered
+    void evict(int page, ReleasedPages* released = nullptr);
+
+    /// The memory of `page`, nullptr when it has none. Read it after the lock is released only once it is evicted,
+    /// writes to the page change it otherwise.
+    std::shared_ptr<const PageAudio> getPageAudio(int page) const;
+
+    /// writes all of `page` from `numChannels` runs of `pageSize` 16 bit samples, allocating it
+    void writePage(int page, const juce::int16* source);
+
+    /// Keeps an encoded copy of `page` for when it's evicted, see `BlockCodec`. They are dropped with the pages
+    /// on `setSize` and `clear`, nullptr drops it now.
+    void setCompressedPage(int page, std::shared_ptr<const std::vector<juce::uint8>> data);
+
+    std::shared_ptr<const std::vector<juce::uint8>> getCompressedPage(int page) const;
+
+    size_t getNumCompressedBytes() const;
+
+    /// changes with every `setSize`, `clear` and `markStale`, a page copied before belongs to an outdated mix
+    int getGeneration() const;
+
+private:
+
+    struct Page {
+        PageState state = PageState::EMPTY;
+        std::shared_ptr<PageAudio> audio;
+        // of the same mix, independent of the state
+        std::shared_ptr<const std::vector<juce::uint8>> compressed;
+    };
+
+    int numChannels = 0;
+    int numSamples = 0;
+    int pageSize = 1;
+    int numAllocatedPages = 0;
+    size_t numAllocatedBytes = 0;
+    size_t numCompressedBytes = 0;
+    int generation = 0;
+    SampleFormat sampleFormat = SampleFormat::FLOAT32;
+    std::vector<Page> pages;
+
+    /// allocates silence in `sampleFormat` unless the page has memory
+    void allocate(Page& page);
+
+    /// drops the page memory into `released`, or frees it, keeps the state
+    void release(Page& page, ReleasedPages* released);
+};
@@ -0,0 +1,60 @@
+#include "ResamplingReader.h"
+
+ResamplingReader::ResamplingReader(juce::AudioFormatReader* source, double sampleRate)
+: juce::AudioFormatReader(nullptr, source->getFormatName()),
+  source(source),
+  ratio(source->sampleRate / sampleRate) {
+    this->sampleRate = sampleRate;
+    bitsPerSample = 32;
+    lengthInSamples = (juce::int64)(source->lengthInSamples / ratio);
+    numChannels = source->numChannels;
+    usesFloatingPointData = true;
+    metadataValues = source->metadataValues;
+    // off the audio thread, the best quality
+    resampler.prepare(2, ratio, (int)std::max(1u, numChannels), 0);
+}
+
+bool ResamplingReader::readSamples(int* const* destChannels,
+                                   int numDestChannels,
+                                   int startOffsetInDestBuffer,
+                                   juce::int64 startSampleInFile,
+                                   int numSamples) {
+    if (numSamples <= 0) {
+        return true;
+    }
+    // the resampler starts `historySize` samples before the first tap, the source is read from there
+    const double sourcePosition = startSampleInFile * ratio;
+    const juce::int64 sourceBase = (juce::int64)sourcePosition;
+    const int historySize = SincResampler::getNumTaps(2) / 2 - 1;
+    resampler.reset(historySize + (sourcePosition - sourceBase));
+    const int numSourceSamples = resampler.getNumInputSamplesNeeded(numSamples);
+    const juce::int64 sourceStart = sourceBase - historySize;
+
+    const int numSourceChannels = (int)std::max(1u, numChannels);
+    sourceBuffer.setSize(numSourceChannels, numSourceSamples, false, false, true);
+    sourceBuffer.clear();
+    // before the start of the source is silence
+    const int silence = (int)std::min<juce::int64>(numSourceSamples, std::max<juce::int64>(0, -sourceStart));
+    const int count = numSourceSamples - silence;
+    if (count > 0) {
+        if (!source->read(&sourceBuffer, silence, count, sourceStart + silence, true, true)) {
+            return false;
+        }
+        const int decoded = (int)std::min<juce::int64>(count, source->lengthInSamples - (sourceStart + silence));
+        if (onSourceDecoded && decoded > 0) {
+            onSourceDecoded(*source, sourceBuffer, silence, decoded, sourceStart + silence);
+        }
+    }
+
+    // destination channels can be null when not wanted
+    std::vector<const float*> input;
+    std::vector<float*> output;
+    for (int ch=0; ch<std::min(numDestChannels, numSourceChannels); ch++) {
+        if (destChannels[ch] != nullptr) {
+            input.push_back(sourceBuffer.getReadPointer(ch));
+            output.push_back(reinterpret_cast<float*>(destChannels[ch]) + startOffsetInDestBuffer);
+        }
+    }
+    resampler.process(input.data(), output.data(), (int)output.size(), numSamples);
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SincResampler.h"
+
+/// Reads `source` at another sample rate. Each read decodes the source range around it and converts it with
+/// a 32 tap windowed sinc, so tracks are converted once when their pages are mixed instead of in every callback.
+/// Reads are independent of each other, any position can be read like from the source.
+class ResamplingReader : public juce::AudioFormatReader {
+public:
+
+    ResamplingReader(juce::AudioFormatReader* source, double sampleRate);
+
+    bool readSamples(int* const* destChannels,
+                     int numDestChannels,
+                     int startOffsetInDestBuffer,
+                     juce::int64 startSampleInFile,
+                     int numSamples) override;
+
+    /// called with the decoded source audio of every read, at the source rate
+    std::function<void(const juce::AudioFormatReader& source,
+                       const juce::AudioBuffer<float>& buffer,
+                       int startSample,
+                       int numSamples,
+                       juce::int64 fileStartSample)> onSourceDecoded;
+
+private:
+
+    std::unique_ptr<juce::AudioFormatReader> source;
+    // source samples per output sample
+    double ratio;
+    SincResampler resampler;
+    juce::AudioBuffer<float> sourceBuffer;
+};
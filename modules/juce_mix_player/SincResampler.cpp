@@ -0,0 +1,155 @@
+#include "SincResampler.h"
+#include <cmath>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON || defined (__ARM_NEON)
+ #define JUCE_MIX_PLAYER_RESAMPLER_NEON 1
+ #include <arm_neon.h>
+#endif
+
+namespace {
+
+/// sum of `x[k] * (coefficients[k] + t * deltas[k])`, `numTaps` is a multiple of 4
+inline float resamplerDot(const float* coefficients, const float* deltas, float t, const float* x, int numTaps) {
+#if JUCE_USE_SSE_INTRINSICS
+    const __m128 fraction = _mm_set1_ps(t);
+    __m128 sum = _mm_setzero_ps();
+    for (int k=0; k<numTaps; k+=4) {
+        const __m128 c = _mm_add_ps(_mm_loadu_ps(coefficients + k), _mm_mul_ps(_mm_loadu_ps(deltas + k), fraction));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c, _mm_loadu_ps(x + k)));
+    }
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#elif JUCE_MIX_PLAYER_RESAMPLER_NEON
+    float32x4_t sum = vdupq_n_f32(0);
+    for (int k=0; k<numTaps; k+=4) {
+        const float32x4_t c = vmlaq_n_f32(vld1q_f32(coefficients + k), vld1q_f32(deltas + k), t);
+        sum = vmlaq_f32(sum, c, vld1q_f32(x + k));
+    }
+    const float32x2_t half = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    return vget_lane_f32(vpadd_f32(half, half), 0);
+#else
+    float sum = 0;
+    for (int k=0; k<numTaps; k++) {
+        sum += x[k] * (coefficients[k] + t * deltas[k]);
+    }
+    return sum;
+#endif
+}
+
+}
+
+int SincResampler::getNumTaps(int quality) {
+    return quality <= 0 ? 4 : quality == 1 ? 16 : 32;
+}
+
+void SincResampler::prepare(int quality, double ratio, int numChannels, int maxOutputSamples) {
+    this->quality = quality;
+    this->ratio = ratio;
+    numTaps = getNumTaps(quality);
+    historySize = numTaps / 2 - 1;
+
+    // tap k of a phase reads input `k - numTaps / 2 + 1` from the output position
+    const int half = numTaps / 2;
+    // below the output Nyquist when decimating, with room for the transition band
+    const double cutoff = ratio > 1 ? 0.95 / ratio : 1.0;
+    std::vector<double> kernel((size_t)((numPhases + 1) * numTaps));
+    for (int phase=0; phase<=numPhases; phase++) {
+        double* row = kernel.data() + phase * numTaps;
+        double sum = 0;
+        for (int k=0; k<numTaps; k++) {
+            const double x = k - half + 1 - (double)phase / numPhases;
+            if (quality <= 0) {
+                row[k] = std::max(0.0, 1.0 - std::abs(x));
+            } else if (std::abs(x) >= half) {
+                row[k] = 0;
+            } else {
+                const double arg = juce::MathConstants<double>::pi * cutoff * x;
+                const double sinc = x == 0 ? 1.0 : std::sin(arg) / arg;
+                const double window = 0.42 + 0.5 * std::cos(juce::MathConstants<double>::pi * x / half)
+                                           + 0.08 * std::cos(2 * juce::MathConstants<double>::pi * x / half);
+                row[k] = sinc * window;
+            }
+            sum += row[k];
+        }
+        // unity gain at every phase
+        for (int k=0; k<numTaps; k++) {
+            row[k] /= sum;
+        }
+    }
+    coefficients.resize((size_t)(numPhases * numTaps * 2));
+    for (int phase=0; phase<numPhases; phase++) {
+        const double* row = kernel.data() + phase * numTaps;
+        float* coefficientRow = coefficients.data() + phase * numTaps * 2;
+        for (int k=0; k<numTaps; k++) {
+            coefficientRow[k] = (float)row[k];
+            coefficientRow[numTaps + k] = (float)(row[numTaps + k] - row[k]);
+        }
+    }
+
+    position = 0;
+    work.setSize(numChannels, historySize + getNumInputSamplesNeeded(maxOutputSamples));
+    work.clear();
+}
+
+bool SincResampler::isPrepared(int quality, double ratio) const {
+    return this->quality == quality && this->ratio == ratio;
+}
+
+void SincResampler::reset(double position) {
+    this->position = position;
+    work.clear();
+}
+
+int SincResampler::getNumInputSamplesConsumed(int numOutputSamples) const {
+    return (int)(position + numOutputSamples * ratio);
+}
+
+int SincResampler::getNumInputSamplesNeeded(int numOutputSamples) const {
+    if (numOutputSamples <= 0) {
+        return 0;
+    }
+    const int lastTap = (int)(position + (numOutputSamples - 1) * ratio) + numTaps / 2 + 1;
+    return std::max(lastTap, getNumInputSamplesConsumed(numOutputSamples));
+}
+
+int SincResampler::process(const float* const* input, float* const* output, int numChannels, int numOutputSamples) {
+    const int numInputSamples = getNumInputSamplesNeeded(numOutputSamples);
+    if (work.getNumChannels() < numChannels || work.getNumSamples() < historySize + numInputSamples) {
+        // larger than prepared for
+        work.setSize(std::max(numChannels, work.getNumChannels()), historySize + numInputSamples, true, true, true);
+    }
+    for (int ch=0; ch<numChannels; ch++) {
+        work.copyFrom(ch, historySize, input[ch], numInputSamples);
+    }
+
+    if (ratio == 1 && position == 0) {
+        // same rate, exact copy
+        for (int ch=0; ch<numChannels; ch++) {
+            juce::FloatVectorOperations::copy(output[ch], work.getReadPointer(ch, historySize), numOutputSamples);
+        }
+    } else {
+        for (int i=0; i<numOutputSamples; i++) {
+            const double inputPosition = position + i * ratio;
+            const int base = (int)inputPosition;
+            const float phasePosition = (float)((inputPosition - base) * numPhases);
+            const int phase = std::min(numPhases - 1, (int)phasePosition);
+            const float* row = coefficients.data() + phase * numTaps * 2;
+            for (int ch=0; ch<numChannels; ch++) {
+                // the first tap is `historySize` before `base` in the input, where `work` starts
+                output[ch][i] = resamplerDot(row, row + numTaps, phasePosition - phase, work.getReadPointer(ch, base), numTaps);
+            }
+        }
+    }
+
+    const int consumed = getNumInputSamplesConsumed(numOutputSamples);
+    position += numOutputSamples * ratio - consumed;
+    // the input before the next call's first sample becomes the history
+    for (int ch=0; ch<numChannels; ch++) {
+        float* data = work.getWritePointer(ch);
+        std::memmove(data, data + consumed, (size_t)historySize * sizeof(float));
+    }
+    return consumed;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/// Converts between sample rates, the player rate to the device rate in the output callback and files to the player rate.
+/// Polyphase: the kernel is precomputed for `numPhases` fractional positions and each output sample is a dot
+/// product of `numTaps` input samples with the kernel of its position, interpolated between the two nearest phases.
+/// An output sample costs 2 x `numTaps` multiply-adds per channel whatever the ratio, e.g. a 256 sample callback
+/// at quality 1 is 8192 per channel. Input is read ahead of the playhead instead of delayed, so there is no latency.
+class SincResampler {
+public:
+
+    /// taps of `MixerSettings::resamplerQuality`: 0 linear (4, two of them zero), 1 sinc 16, 2 sinc 32
+    static int getNumTaps(int quality);
+
+    /// Builds the coefficient table, allocates. `ratio` is input samples per output sample.
+    void prepare(int quality, double ratio, int numChannels, int maxOutputSamples);
+
+    bool isPrepared(int quality, double ratio) const;
+
+    /// Forgets the previous input, e.g. after a device restart. The first output is at `position` of the next input,
+    /// which starts `numTaps / 2 - 1` samples before it when there's no silence to assume.
+    void reset(double position = 0);
+
+    /// input samples `process` reads for `numOutputSamples`, from the first one not consumed yet
+    int getNumInputSamplesNeeded(int numOutputSamples) const;
+
+    /// Writes `numOutputSamples` of the first `numChannels` channels from `input`, which holds
+    /// `getNumInputSamplesNeeded` samples. Returns the input samples consumed, the next call starts after them.
+    /// Doesn't allocate within the prepared sizes, safe on the audio thread.
+    int process(const float* const* input, float* const* output, int numChannels, int numOutputSamples);
+
+private:
+
+    static constexpr int numPhases = 256;
+
+    int quality = -1;
+    double ratio = 0;
+    int numTaps = 0;
+    // past input the first taps read, `numTaps / 2 - 1` samples
+    int historySize = 0;
+    // per phase `numTaps` coefficients followed by their difference to the next phase
+    std::vector<float> coefficients;
+    // fractional input position of the next output sample
+    double position = 0;
+    // history followed by the input of one call, per channel
+    juce::AudioBuffer<float> work;
+
+    int getNumInputSamplesConsumed(int numOutputSamples) const;
+};
@@ -3,29 +3,69 @@
 TaskQueue TaskQueue::shared;
 
 TaskQueue::TaskQueue() {
-    workerThread = std::thread([this] { this->worker(); });
 }
 
 TaskQueue::~TaskQueue() {
     stopQueue();
-    if (workerThread.joinable()) {
-        workerThread.join();
-    }
+    join();
 }
 
 void TaskQueue::async(TaskQueueItem task) {
     {
         std::lock_guard<std::mutex> lock(mtx);
+        if (stop) {
+            return;
+        }
         taskList.push_back(std::move(task));
+        startWorker();
+    }
+    cv.notify_one();
+}
+
+void TaskQueue::asyncPriority(TaskQueueItem task) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stop) {
+            return;
+        }
+        taskList.insert(taskList.begin() + priorityCount, std::move(task));
+        priorityCount++;
+        startWorker();
+    }
+    cv.notify_one();
+}
+
+void TaskQueue::finishQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
     }
     cv.notify_one();
 }
 
+void TaskQueue::join() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        thread = std::move(workerThread);
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void TaskQueue::startWorker() {
+    if (!workerThread.joinable()) {
+        workerThread = std::thread([this] { this->worker(); });
+    }
+}
+
 void TaskQueue::stopQueue() {
     {
         std::lock_guard<std::mutex> lock(mtx);
         stop = true;
         taskList.clear();
+        priorityCount = 0;
     }
     cv.notify_one(); // wake up worker so it can exit
 }
@@ -43,6 +83,9 @@ void TaskQueue::worker() {
 
             task = std::move(taskList.front());
             taskList.pop_front();
+            if (priorityCount > 0) {
+                priorityCount--;
+            }
         }
 
         if (task) {
@@ -9,6 +9,7 @@
 
 using TaskQueueItem = std::function<void()>;
 
+/// Serial queue. Its thread starts with the first task, so queues that are never used cost no thread.
 class TaskQueue {
 public:
     static TaskQueue shared;
@@ -17,13 +18,25 @@ public:
     TaskQueue();
     ~TaskQueue();
 
+    /// ignored once the queue is stopped
     void async(TaskQueueItem task);
+    /// runs `task` before queued `async` tasks, priority tasks keep their order
+    void asyncPriority(TaskQueueItem task);
+    /// drops the queued tasks, the running one finishes
     void stopQueue();
+    /// runs the queued tasks and stops, new ones are ignored
+    void finishQueue();
+    /// waits for a stopped queue to exit its thread, not from a task of the queue itself
+    void join();
 
 private:
     void worker();
+    /// `mtx` held
+    void startWorker();
 
     std::deque<TaskQueueItem> taskList;
+    // number of priority tasks at the front of `taskList`
+    size_t priorityCount = 0;
     std::mutex mtx;
     std::condition_variable cv;
     std::atomic<bool> stop{ false };
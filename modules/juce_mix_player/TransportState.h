@@ -0,0 +1,27 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/// Transport of one player in one cache line the host reads in place, e.g. once per display frame, instead of
+/// progress callbacks. Fields are written one by one by the audio callback and the task queue, `sequence` is
+/// bumped after every update so a reader can skip frames where nothing changed. Mirrors `JuceMixPlayerTransport`.
+struct alignas(64) TransportState {
+    std::atomic<juce::uint32> sequence { 0 };
+    // `JuceMixPlayerState` and `JuceMixPlayerRecState`
+    std::atomic<juce::int32> state { 0 };
+    std::atomic<juce::int32> recState { 0 };
+    // rate of `playHead` and `duration`
+    std::atomic<float> sampleRate { 0 };
+    std::atomic<juce::int64> playHead { 0 };
+    std::atomic<juce::int64> duration { 0 };
+    // recorded so far at `recordSampleRate`, the device rate
+    std::atomic<juce::int64> recordedSamples { 0 };
+    std::atomic<float> recordSampleRate { 0 };
+    // linear peaks of the last device callback
+    std::atomic<float> inputLevel { 0 };
+    std::atomic<float> outputLevel { 0 };
+};
+
+static_assert(sizeof(TransportState) == 64, "TransportState is one cache line");
+static_assert(offsetof(TransportState, playHead) == 16, "layout of JuceMixPlayerTransport");
+static_assert(offsetof(TransportState, outputLevel) == 48, "layout of JuceMixPlayerTransport");
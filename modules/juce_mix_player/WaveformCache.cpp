@@ -0,0 +1,413 @@
+#include "WaveformCache.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const char sidecarMagic[4] = { 'J', 'M', 'W', 'F' };
+const juce::int32 sidecarVersion = 1;
+
+// fixed size, written raw, all supported platforms are little endian
+struct SidecarHeader {
+    char magic[4];
+    juce::int32 version;
+    juce::int64 fileSize;
+    juce::int64 modificationTime;
+    juce::int64 lengthInSamples;
+    double sampleRate;
+    juce::int32 baseSamplesPerPeak;
+    juce::int32 levelFactor;
+    juce::int32 numLevels;
+    juce::int32 reserved;
+};
+
+// base peaks decoded per read when filling gaps
+const int peaksPerRead = 256;
+
+int16_t toInt16(float value) {
+    return (int16_t)juce::jlimit(-32767, 32767, (int)std::lround(value * 32767.0f));
+}
+
+}
+
+WaveformCache::WaveformCache() {
+    cacheDirectory = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("juce_mix_waveforms");
+}
+
+WaveformCache::~WaveformCache() {
+    cancelled = true;
+    std::vector<std::unique_ptr<TaskQueue>> stoppedWorkers;
+    {
+        const juce::ScopedLock sl (entriesLock);
+        stoppedWorkers.swap(workers);
+    }
+    // joins the worker threads, running builds stop at their next read
+    stoppedWorkers.clear();
+}
+
+void WaveformCache::setCacheDirectory(const juce::File& directory) {
+    const juce::ScopedLock sl (entriesLock);
+    cacheDirectory = directory;
+}
+
+int WaveformCache::getPeaks(const std::string& path, double startTime, double endTime, int numPoints, float* output) {
+    if (numPoints <= 0 || output == nullptr || endTime <= startTime) {
+        return 0;
+    }
+    std::shared_ptr<Entry> entry = _getEntry(path);
+    const juce::ScopedLock sl (entry->lock);
+
+    if (entry->complete) {
+        // the file was replaced since the peaks were built
+        const juce::File file(path);
+        if (file.getSize() != entry->fileSize || file.getLastModificationTime().toMilliseconds() != entry->modificationTime) {
+            entry->complete = false;
+            entry->levels.clear();
+        }
+    }
+    if (entry->failed) {
+        return 0;
+    }
+    if (!entry->complete) {
+        if (!entry->building) {
+            entry->building = true;
+            _scheduleBuild(path);
+        }
+        return -1;
+    }
+
+    const double samplesPerPoint = (endTime - startTime) * entry->sampleRate / numPoints;
+
+    // coarsest level that still has at least one peak per point
+    int level = 0;
+    while (level + 1 < (int)entry->levels.size() && _getSamplesPerPeak(level + 1) <= samplesPerPoint) {
+        level++;
+    }
+    const std::vector<Peak>& peaks = entry->levels[level];
+    const double samplesPerPeak = (double)_getSamplesPerPeak(level);
+    const double firstSample = startTime * entry->sampleRate;
+
+    for (int i=0; i<numPoints; i++) {
+        float* frame = output + i * 3;
+        const double start = firstSample + i * samplesPerPoint;
+        const juce::int64 first = (juce::int64)std::floor(start / samplesPerPeak);
+        const juce::int64 last = std::max(first + 1, (juce::int64)std::ceil((start + samplesPerPoint) / samplesPerPeak));
+        const juce::int64 from = std::max<juce::int64>(first, 0);
+        const juce::int64 to = std::min<juce::int64>(last, (juce::int64)peaks.size());
+        if (from >= to) {
+            // before the start or after the end of the file
+            frame[0] = frame[1] = frame[2] = 0;
+            continue;
+        }
+        int min = peaks[from].min;
+        int max = peaks[from].max;
+        double sumSquares = 0;
+        for (juce::int64 p=from; p<to; p++) {
+            min = std::min(min, (int)peaks[p].min);
+            max = std::max(max, (int)peaks[p].max);
+            sumSquares += (double)peaks[p].rms * peaks[p].rms;
+        }
+        frame[0] = min / 32767.0f;
+        frame[1] = max / 32767.0f;
+        frame[2] = (float)(std::sqrt(sumSquares / (double)(to - from)) / 32767.0);
+    }
+    return numPoints;
+}
+
+void WaveformCache::addDecodedAudio(const std::string& path,
+                                    const juce::AudioFormatReader& reader,
+                                    const juce::AudioBuffer<float>& buffer,
+                                    int startSample,
+                                    int numSamples,
+                                    juce::int64 fileStartSample) {
+    if (numSamples <= 0 || fileStartSample < 0) {
+        return;
+    }
+    std::shared_ptr<Entry> entry = _getEntry(path);
+    const juce::ScopedLock sl (entry->lock);
+    if (entry->complete || entry->failed) {
+        return;
+    }
+    if (entry->levels.empty() || entry->lengthInSamples != reader.lengthInSamples || entry->sampleRate != reader.sampleRate) {
+        _prepareEntry(*entry, juce::File(path), reader.lengthInSamples, reader.sampleRate);
+    }
+
+    std::vector<Peak>& peaks = entry->levels[0];
+    // the buffer can have more channels than the file, e.g. a mono track in the stereo mix buffers
+    const int numChannels = std::min(buffer.getNumChannels(), juce::jlimit(1, 2, (int)reader.numChannels));
+    const juce::int64 fileEndSample = std::min(fileStartSample + numSamples, entry->lengthInSamples);
+    for (juce::int64 window = (fileStartSample + baseSamplesPerPeak - 1) / baseSamplesPerPeak;
+         window < (juce::int64)peaks.size();
+         window++) {
+        const juce::int64 windowStart = window * baseSamplesPerPeak;
+        const juce::int64 windowEnd = std::min(windowStart + baseSamplesPerPeak, entry->lengthInSamples);
+        if (windowEnd > fileEndSample) {
+            break;
+        }
+        if (entry->present[window]) {
+            continue;
+        }
+        peaks[window] = _computePeak(buffer, numChannels, startSample + (int)(windowStart - fileStartSample), (int)(windowEnd - windowStart));
+        entry->present[window] = true;
+        entry->numPresent++;
+    }
+
+    // playback decoded the whole file, only the levels are left to build
+    if (entry->numPresent == entry->present.size() && !entry->building) {
+        entry->building = true;
+        _scheduleBuild(path);
+    }
+}
+
+std::shared_ptr<WaveformCache::Entry> WaveformCache::_getEntry(const std::string& path) {
+    const juce::ScopedLock sl (entriesLock);
+    std::shared_ptr<Entry>& entry = entries[path];
+    if (!entry) {
+        entry = std::make_shared<Entry>();
+    }
+    return entry;
+}
+
+void WaveformCache::_scheduleBuild(const std::string& path) {
+    const juce::ScopedLock sl (entriesLock);
+    if (cancelled) {
+        return;
+    }
+    if (workers.empty()) {
+        const size_t count = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+        for (size_t i=0; i<count; i++) {
+            workers.emplace_back(new TaskQueue());
+            workers.back()->name = "waveformQueue";
+        }
+    }
+    // files build in parallel, one per worker
+    workers[nextWorker++ % workers.size()]->async([this, path]{
+        _build(path);
+    });
+}
+
+void WaveformCache::_build(const std::string& path) {
+    std::shared_ptr<Entry> entry = _getEntry(path);
+    const juce::File file(path);
+
+    auto notify = [&]{
+        auto callback = onReady;
+        if (callback) {
+            callback(path);
+        }
+    };
+
+    std::unique_ptr<juce::AudioFormatReader> reader(createReader ? createReader(file) : nullptr);
+    if (!reader || reader->lengthInSamples <= 0) {
+        {
+            const juce::ScopedLock sl (entry->lock);
+            entry->failed = true;
+            entry->building = false;
+        }
+        notify();
+        return;
+    }
+
+    bool loaded = false;
+    {
+        const juce::ScopedLock sl (entry->lock);
+        _prepareEntry(*entry, file, reader->lengthInSamples, reader->sampleRate);
+        if (entry->numPresent == 0 && _loadSidecar(*entry, _getSidecarFile(path))) {
+            entry->building = false;
+            entry->complete = true;
+            loaded = true;
+        }
+    }
+    if (loaded) {
+        notify();
+        return;
+    }
+
+    // decode only the windows playback has not decoded yet
+    juce::AudioBuffer<float> buffer(juce::jlimit(1, 2, (int)reader->numChannels), peaksPerRead * baseSamplesPerPeak);
+    juce::int64 window = 0;
+    while (true) {
+        if (cancelled) return;
+
+        juce::int64 numWindows = 0;
+        {
+            const juce::ScopedLock sl (entry->lock);
+            const juce::int64 totalWindows = (juce::int64)entry->present.size();
+            while (window < totalWindows && entry->present[window]) {
+                window++;
+            }
+            if (window >= totalWindows) {
+                break;
+            }
+            while (numWindows < peaksPerRead && window + numWindows < totalWindows && !entry->present[window + numWindows]) {
+                numWindows++;
+            }
+        }
+
+        const juce::int64 startSample = window * baseSamplesPerPeak;
+        const int numSamples = (int)std::min<juce::int64>(numWindows * baseSamplesPerPeak, reader->lengthInSamples - startSample);
+        buffer.clear();
+        reader->read(&buffer, 0, numSamples, startSample, true, true);
+        addDecodedAudio(path, *reader, buffer, 0, numSamples, startSample);
+        window += numWindows;
+    }
+
+    {
+        const juce::ScopedLock sl (entry->lock);
+        if (entry->numPresent != entry->present.size()) {
+            // the file changed while decoding, start over
+            _scheduleBuild(path);
+            return;
+        }
+        _buildLevels(*entry);
+        entry->complete = true;
+        entry->building = false;
+        _saveSidecar(*entry, _getSidecarFile(path));
+    }
+    notify();
+}
+
+void WaveformCache::_prepareEntry(Entry& entry, const juce::File& file, juce::int64 lengthInSamples, double sampleRate) {
+    const juce::int64 fileSize = file.getSize();
+    const juce::int64 modificationTime = file.getLastModificationTime().toMilliseconds();
+    if (!entry.levels.empty()
+        && entry.fileSize == fileSize
+        && entry.modificationTime == modificationTime
+        && entry.lengthInSamples == lengthInSamples
+        && entry.sampleRate == sampleRate) {
+        return;
+    }
+    entry.fileSize = fileSize;
+    entry.modificationTime = modificationTime;
+    entry.lengthInSamples = lengthInSamples;
+    entry.sampleRate = sampleRate;
+    const size_t numPeaks = (size_t)((lengthInSamples + baseSamplesPerPeak - 1) / baseSamplesPerPeak);
+    entry.levels.assign(1, std::vector<Peak>(numPeaks));
+    entry.present.assign(numPeaks, false);
+    entry.numPresent = 0;
+    entry.complete = false;
+    entry.failed = false;
+}
+
+void WaveformCache::_buildLevels(Entry& entry) {
+    entry.levels.resize(1);
+    while ((int)entry.levels.size() < maxLevels && entry.levels.back().size() > 1) {
+        const std::vector<Peak>& below = entry.levels.back();
+        std::vector<Peak> level((below.size() + levelFactor - 1) / levelFactor);
+        for (size_t i=0; i<level.size(); i++) {
+            const size_t from = i * levelFactor;
+            const size_t to = std::min(from + levelFactor, below.size());
+            Peak peak = below[from];
+            double sumSquares = 0;
+            for (size_t j=from; j<to; j++) {
+                peak.min = std::min(peak.min, below[j].min);
+                peak.max = std::max(peak.max, below[j].max);
+                sumSquares += (double)below[j].rms * below[j].rms;
+            }
+            peak.rms = (int16_t)std::lround(std::sqrt(sumSquares / (double)(to - from)));
+            level[i] = peak;
+        }
+        entry.levels.push_back(std::move(level));
+    }
+}
+
+juce::File WaveformCache::_getSidecarFile(const std::string& path) {
+    const juce::ScopedLock sl (entriesLock);
+    return cacheDirectory.getChildFile(juce::String::toHexString(juce::String(path).hashCode64()) + ".peaks");
+}
+
+bool WaveformCache::_loadSidecar(Entry& entry, const juce::File& file) {
+    juce::MemoryBlock data;
+    if (!file.existsAsFile() || !file.loadFileAsData(data) || data.getSize() < sizeof(SidecarHeader)) {
+        return false;
+    }
+    SidecarHeader header;
+    std::memcpy(&header, data.getData(), sizeof(SidecarHeader));
+    if (std::memcmp(header.magic, sidecarMagic, sizeof(sidecarMagic)) != 0
+        || header.version != sidecarVersion
+        || header.fileSize != entry.fileSize
+        || header.modificationTime != entry.modificationTime
+        || header.lengthInSamples != entry.lengthInSamples
+        || header.sampleRate != entry.sampleRate
+        || header.baseSamplesPerPeak != baseSamplesPerPeak
+        || header.levelFactor != levelFactor
+        || header.numLevels < 1
+        || header.numLevels > maxLevels) {
+        return false;
+    }
+
+    std::vector<std::vector<Peak>> levels;
+    size_t numPeaks = entry.levels[0].size();
+    size_t offset = sizeof(SidecarHeader);
+    for (int i=0; i<header.numLevels; i++) {
+        const size_t numBytes = numPeaks * sizeof(Peak);
+        if (offset + numBytes > data.getSize()) {
+            return false;
+        }
+        std::vector<Peak> level(numPeaks);
+        std::memcpy(level.data(), (const char*)data.getData() + offset, numBytes);
+        levels.push_back(std::move(level));
+        offset += numBytes;
+        numPeaks = (numPeaks + levelFactor - 1) / levelFactor;
+    }
+
+    entry.levels = std::move(levels);
+    entry.present.assign(entry.present.size(), true);
+    entry.numPresent = entry.present.size();
+    return true;
+}
+
+void WaveformCache::_saveSidecar(Entry& entry, const juce::File& file) {
+    SidecarHeader header {};
+    std::memcpy(header.magic, sidecarMagic, sizeof(sidecarMagic));
+    header.version = sidecarVersion;
+    header.fileSize = entry.fileSize;
+    header.modificationTime = entry.modificationTime;
+    header.lengthInSamples = entry.lengthInSamples;
+    header.sampleRate = entry.sampleRate;
+    header.baseSamplesPerPeak = baseSamplesPerPeak;
+    header.levelFactor = levelFactor;
+    header.numLevels = (juce::int32)entry.levels.size();
+
+    juce::MemoryBlock data;
+    data.append(&header, sizeof(SidecarHeader));
+    for (const std::vector<Peak>& level: entry.levels) {
+        data.append(level.data(), level.size() * sizeof(Peak));
+    }
+    // a missing sidecar only costs a decode next time
+    if (file.getParentDirectory().createDirectory()) {
+        file.replaceWithData(data.getData(), data.getSize());
+    }
+}
+
+WaveformCache::Peak WaveformCache::_computePeak(const juce::AudioBuffer<float>& buffer, int numChannels, int startSample, int numSamples) {
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+    double sumSquares = 0;
+    // channels are merged, a peak covers all of them
+    for (int ch=0; ch<numChannels; ch++) {
+        const float* samples = buffer.getReadPointer(ch, startSample);
+        for (int i=0; i<numSamples; i++) {
+            min = std::min(min, samples[i]);
+            max = std::max(max, samples[i]);
+            sumSquares += (double)samples[i] * samples[i];
+        }
+    }
+    Peak peak;
+    if (numSamples <= 0 || numChannels <= 0) {
+        return peak;
+    }
+    peak.min = toInt16(min);
+    peak.max = toInt16(max);
+    peak.rms = toInt16((float)std::sqrt(sumSquares / std::max(1, numSamples * numChannels)));
+    return peak;
+}
+
+juce::int64 WaveformCache::_getSamplesPerPeak(int level) {
+    juce::int64 samples = baseSamplesPerPeak;
+    for (int i=0; i<level; i++) {
+        samples *= levelFactor;
+    }
+    return samples;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "TaskQueue.h"
+
+/// Min/max/RMS peaks of audio files at several zoom levels, for drawing waveforms.
+/// Peaks are taken from audio the player decodes anyway where possible, the rest is decoded on worker threads.
+/// Finished files are saved as binary sidecars in the cache directory and loaded from there next time.
+class WaveformCache {
+public:
+
+    struct Peak {
+        int16_t min = 0;
+        int16_t max = 0;
+        int16_t rms = 0;
+    };
+
+    // samples per peak of the finest level
+    static constexpr int baseSamplesPerPeak = 256;
+    // each level has this many times fewer peaks than the one below
+    static constexpr int levelFactor = 4;
+    static constexpr int maxLevels = 6;
+
+    WaveformCache();
+
+    ~WaveformCache();
+
+    /// opens files for decoding, required
+    std::function<juce::AudioFormatReader*(const juce::File& file)> createReader;
+
+    /// called on a worker thread with the path once its peaks are ready, or failed to build
+    std::function<void(const std::string& path)> onReady;
+
+    /// sidecar directory, defaults to `juce_mix_waveforms` in the temp directory
+    void setCacheDirectory(const juce::File& directory);
+
+    /// Writes `numPoints` frames of min, max and rms (3 floats each) for `startTime` to `endTime` seconds of `path` to `output`.
+    /// Returns `numPoints`, -1 while the peaks are built in the background (`onReady` follows) or 0 if the file can't be read.
+    int getPeaks(const std::string& path, double startTime, double endTime, int numPoints, float* output);
+
+    /// Adds peaks from `numSamples` of `buffer` starting at `startSample`, which `reader` decoded from `fileStartSample` of `path`.
+    /// Only peak windows that are fully inside are used.
+    void addDecodedAudio(const std::string& path,
+                         const juce::AudioFormatReader& reader,
+                         const juce::AudioBuffer<float>& buffer,
+                         int startSample,
+                         int numSamples,
+                         juce::int64 fileStartSample);
+
+private:
+
+    struct Entry {
+        juce::CriticalSection lock;
+        juce::int64 fileSize = 0;
+        juce::int64 modificationTime = 0;
+        juce::int64 lengthInSamples = 0;
+        double sampleRate = 0;
+        // levels[0] is filled while decoding, the others when it is complete
+        std::vector<std::vector<Peak>> levels;
+        std::vector<bool> present;
+        size_t numPresent = 0;
+        bool complete = false;
+        bool failed = false;
+        bool building = false;
+    };
+
+    juce::CriticalSection entriesLock;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+    juce::File cacheDirectory;
+
+    std::vector<std::unique_ptr<TaskQueue>> workers;
+    size_t nextWorker = 0;
+    // set on destruction, stops running builds
+    std::atomic<bool> cancelled { false };
+
+    std::shared_ptr<Entry> _getEntry(const std::string& path);
+
+    /// starts `_build` on the next worker, `entry.building` must be set
+    void _scheduleBuild(const std::string& path);
+
+    /// loads the sidecar or decodes the missing base peaks, then completes the levels
+    void _build(const std::string& path);
+
+    /// sizes `entry` for `reader`, drops existing peaks when the file changed
+    void _prepareEntry(Entry& entry, const juce::File& file, juce::int64 lengthInSamples, double sampleRate);
+
+    void _buildLevels(Entry& entry);
+
+    juce::File _getSidecarFile(const std::string& path);
+
+    bool _loadSidecar(Entry& entry, const juce::File& file);
+
+    void _saveSidecar(Entry& entry, const juce::File& file);
+
+    static Peak _computePeak(const juce::AudioBuffer<float>& buffer, int numChannels, int startSample, int numSamples);
+
+    static juce::int64 _getSamplesPerPeak(int level);
+};
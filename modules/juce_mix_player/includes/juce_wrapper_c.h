@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 #define EXPORT_C_FUNC extern "C" __attribute__((visibility("default"))) __attribute__((used))
 #else
@@ -10,7 +12,20 @@ EXPORT_C_FUNC void juce_init();
 EXPORT_C_FUNC void Java_com_rmsl_juce_Native_juceMessageManagerInit();
 EXPORT_C_FUNC void juce_enableLogs(int enable);
 
+/// Strings handed out by this API, returned or passed to a callback, belong to the receiver and stay valid
+/// until they are given back here.
+EXPORT_C_FUNC void JuceMixPlayer_freeString(const char* string);
+
+/// players created after this call with 1 share one device callback, 0 gives each its own
+EXPORT_C_FUNC void juce_setSharedOutputBus(int enable);
+
+/// players released by `JuceMixPlayer_deinit` are kept for `JuceMixPlayer_init`, up to `size` of them created ahead
+EXPORT_C_FUNC void juce_setPlayerPoolSize(int size);
+
+/// a pooled player or a new one
 EXPORT_C_FUNC void* JuceMixPlayer_init();
+/// Back to the pool, or disposed. Callbacks, an export's completion included, are dropped and the calls in progress
+/// finish before it returns, they can be freed then. Not from one of them.
 EXPORT_C_FUNC void JuceMixPlayer_deinit(void* ptr);
 
 EXPORT_C_FUNC void JuceMixPlayer_play(void* ptr);
@@ -21,6 +36,31 @@ EXPORT_C_FUNC void JuceMixPlayer_set(void* ptr, const char* json);
 
 EXPORT_C_FUNC void JuceMixPlayer_setSettings(void* ptr, const char* json);
 
+// MARK: Tracks
+// `track` is the `id` of a track of the last `JuceMixPlayer_set`. No json is involved, the buffered mix is
+// only rendered again when the change is audible in it, and keeps playing meanwhile when only a gain changed.
+
+EXPORT_C_FUNC void JuceMixPlayer_setTrackVolume(void* ptr, const char* track, float volume);
+
+/// seconds
+EXPORT_C_FUNC void JuceMixPlayer_setTrackOffset(void* ptr, const char* track, float offset);
+
+EXPORT_C_FUNC void JuceMixPlayer_setTrackEnabled(void* ptr, const char* track, int enabled);
+
+/// seconds of the file from `fromTime`, `duration` 0 plays to its end
+EXPORT_C_FUNC void JuceMixPlayer_setTrackTrim(void* ptr, const char* track, float fromTime, float duration);
+
+/// `interval` in seconds
+EXPORT_C_FUNC void JuceMixPlayer_setTrackRepeat(void* ptr, const char* track, int repeat, float interval);
+
+/// `count` updates heard together, `params[i]` of the track at index `tracks[i]` in `tracks` set to `values[i]`,
+/// booleans as 0 or 1. params: 0 volume, 1 offset, 2 fromTime, 3 duration, 4 enabled, 5 repeat, 6 repeatInterval.
+/// One invalid update drops all of them and reports an error.
+EXPORT_C_FUNC void JuceMixPlayer_updateTracks(void* ptr, const int* tracks, const int* params, const float* values, int count);
+
+/// `JuceMixPlayer_updateTracks` with track ids
+EXPORT_C_FUNC void JuceMixPlayer_updateTracksById(void* ptr, const char* const* tracks, const int* params, const float* values, int count);
+
 EXPORT_C_FUNC void JuceMixPlayer_onStateUpdate(void* ptr, void (*JuceMixPlayerCallbackString)(void*, const char*));
 
 /// callback with progress value range 0 to 1
@@ -37,6 +77,34 @@ EXPORT_C_FUNC int JuceMixPlayer_isPlaying(void *ptr);
 /// value range 0 to 1
 EXPORT_C_FUNC void JuceMixPlayer_seek(void* ptr, float value);
 
+/// loops `start` to `end` in seconds while the playhead is before `end`, `end <= start` clears it
+EXPORT_C_FUNC void JuceMixPlayer_setLoopRegion(void* ptr, float start, float end);
+
+/// linear gain of the player on the shared output bus
+EXPORT_C_FUNC void JuceMixPlayer_setBusGain(void* ptr, float gain);
+
+// MARK: Transport
+
+/// One 64 byte aligned block per player that the host reads in place, e.g. once per display frame, instead of
+/// progress callbacks (`progressCallbacks` false in the settings turns those off). Fields are updated one by one,
+/// `sequence` changes after every update so unchanged frames can be skipped. Read each field with one aligned load.
+typedef struct JuceMixPlayerTransport {
+    uint32_t sequence;
+    int32_t state;            // IDLE, READY, PLAYING, PAUSED, STOPPED, ERROR, COMPLETED from 0
+    int32_t recState;         // IDLE, READY, RECORDING, STOPPED, ERROR from 0
+    float sampleRate;         // of `playHead` and `duration`
+    int64_t playHead;         // samples
+    int64_t duration;         // samples
+    int64_t recordedSamples;  // at `recordSampleRate`
+    float recordSampleRate;
+    float inputLevel;         // linear peak of the last device callback
+    float outputLevel;
+    uint32_t reserved[3];
+} JuceMixPlayerTransport;
+
+/// valid until `JuceMixPlayer_deinit`
+EXPORT_C_FUNC const JuceMixPlayerTransport* JuceMixPlayer_getTransport(void* ptr);
+
 // MARK: Recorder
 
 EXPORT_C_FUNC void JuceMixPlayer_prepareRecorder(void* ptr, const char* file);
@@ -59,6 +127,34 @@ EXPORT_C_FUNC void JuceMixPlayer_setUpdatedDevices(void* ptr, const char* json);
 
 EXPORT_C_FUNC const char* JuceMixPlayer_getDeviceLatencyInfo(void *ptr);
 
+/// json of rendered, loading and evicted time ranges
+EXPORT_C_FUNC const char* JuceMixPlayer_getBufferedRanges(void *ptr);
+
+/// copies up to `maxFrames` live level frames (input min, max, rms, output min, max, rms) into `output`, returns the frame count
+EXPORT_C_FUNC int JuceMixPlayer_readLevels(void* ptr, float* output, int maxFrames);
+
+// MARK: Waveform
+
+/// fills `output` with `numPoints` min, max, rms float triplets of `path` between `startTime` and `endTime` seconds.
+/// returns `numPoints`, -1 while building (`onWaveformReady` follows) or 0 when the file can't be read
+EXPORT_C_FUNC int JuceMixPlayer_getWaveform(void* ptr, const char* path, float startTime, float endTime, int numPoints, float* output);
+
+EXPORT_C_FUNC void JuceMixPlayer_onWaveformReady(void* ptr, void (*onReady)(void* ptr, const char* path));
+
+EXPORT_C_FUNC void JuceMixPlayer_setWaveformCacheDir(void* ptr, const char* path);
+
+// MARK: Loudness
+
+/// fills `output` with 5 floats: integrated, max momentary, max short-term loudness (LUFS), loudness range (LU), true peak (dBTP).
+/// returns 1, -1 while measuring (`onLoudnessReady` follows) or 0 when the file can't be read
+EXPORT_C_FUNC int JuceMixPlayer_getLoudness(void* ptr, const char* path, float* output);
+
+/// loudness of the last exported mix, returns 0 when nothing was exported
+EXPORT_C_FUNC int JuceMixPlayer_getMixLoudness(void* ptr, float* output);
+
+EXPORT_C_FUNC void JuceMixPlayer_onLoudnessReady(void* ptr, void (*onReady)(void* ptr, const char* path));
+
+/// `completion` gets an empty string on success, else the error
 EXPORT_C_FUNC void JuceMixPlayer_export(void* ptr,
                                         const char *outputPath,
                                         void (*completion)(const char*));
@@ -3,3 +3,16 @@
 #include "Models.cpp"
 #include "Logger.cpp"
 #include "TaskQueue.cpp"
+#include "PlayBuffer.cpp"
+#include "LoadPolicy.cpp"
+#include "WaveformCache.cpp"
+#include "LevelStream.cpp"
+#include "LoudnessMeter.cpp"
+#include "LoudnessCache.cpp"
+#include "OneShotSampler.cpp"
+#include "SincResampler.cpp"
+#include "ResamplingReader.cpp"
+#include "MixKernels.cpp"
+#include "BlockCodec.cpp"
+#include "MixBus.cpp"
+#include "EventChannel.cpp"
@@ -21,3 +21,17 @@
 #include "Models.h"
 #include "Logger.h"
 #include "TaskQueue.h"
+#include "PlayBuffer.h"
+#include "LoadPolicy.h"
+#include "WaveformCache.h"
+#include "LevelStream.h"
+#include "LoudnessMeter.h"
+#include "LoudnessCache.h"
+#include "OneShotSampler.h"
+#include "SincResampler.h"
+#include "ResamplingReader.h"
+#include "MixKernels.h"
+#include "BlockCodec.h"
+#include "MixBus.h"
+#include "TransportState.h"
+#include "EventChannel.h"
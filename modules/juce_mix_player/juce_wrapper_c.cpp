@@ -16,14 +16,26 @@ void juce_enableLogs(int enable) {
     enableLogsValue = enable == 1;
 }
 
+void JuceMixPlayer_freeString(const char* string) {
+    freeCopyChar(string);
+}
+
+void juce_setSharedOutputBus(int enable) {
+    JuceMixPlayer::setSharedOutputBus(enable == 1);
+}
+
 // MARK: JuceMixPlayer
 
+void juce_setPlayerPoolSize(int size) {
+    JuceMixPlayer::setPoolSize(size);
+}
+
 void *JuceMixPlayer_init() {
-    return new JuceMixPlayer();
+    return JuceMixPlayer::acquire();
 }
 
 void JuceMixPlayer_deinit(void *ptr) {
-    static_cast<JuceMixPlayer *>(ptr)->dispose();
+    static_cast<JuceMixPlayer *>(ptr)->release();
 }
 
 void JuceMixPlayer_play(void *ptr) {
@@ -46,6 +58,50 @@ void JuceMixPlayer_setSettings(void* ptr, const char* json) {
     static_cast<JuceMixPlayer *>(ptr)->setSettings(json);
 }
 
+// MARK: Tracks
+
+void JuceMixPlayer_setTrackVolume(void* ptr, const char* track, float volume) {
+    static_cast<JuceMixPlayer *>(ptr)->updateTracks({ { 0, MixerTrackParam::VOLUME, volume, track } });
+}
+
+void JuceMixPlayer_setTrackOffset(void* ptr, const char* track, float offset) {
+    static_cast<JuceMixPlayer *>(ptr)->updateTracks({ { 0, MixerTrackParam::OFFSET, offset, track } });
+}
+
+void JuceMixPlayer_setTrackEnabled(void* ptr, const char* track, int enabled) {
+    static_cast<JuceMixPlayer *>(ptr)->updateTracks({ { 0, MixerTrackParam::ENABLED, enabled != 0 ? 1.0f : 0.0f, track } });
+}
+
+void JuceMixPlayer_setTrackTrim(void* ptr, const char* track, float fromTime, float duration) {
+    static_cast<JuceMixPlayer *>(ptr)->updateTracks({
+        { 0, MixerTrackParam::FROM_TIME, fromTime, track },
+        { 0, MixerTrackParam::DURATION, duration, track }
+    });
+}
+
+void JuceMixPlayer_setTrackRepeat(void* ptr, const char* track, int repeat, float interval) {
+    static_cast<JuceMixPlayer *>(ptr)->updateTracks({
+        { 0, MixerTrackParam::REPEAT, repeat != 0 ? 1.0f : 0.0f, track },
+        { 0, MixerTrackParam::REPEAT_INTERVAL, interval, track }
+    });
+}
+
+void JuceMixPlayer_updateTracks(void* ptr, const int* tracks, const int* params, const float* values, int count) {
+    std::vector<MixerTrackUpdate> updates((size_t)std::max(0, count));
+    for (size_t i=0; i<updates.size(); i++) {
+        updates[i] = { tracks[i], static_cast<MixerTrackParam>(params[i]), values[i] };
+    }
+    static_cast<JuceMixPlayer *>(ptr)->updateTracks(std::move(updates));
+}
+
+void JuceMixPlayer_updateTracksById(void* ptr, const char* const* tracks, const int* params, const float* values, int count) {
+    std::vector<MixerTrackUpdate> updates((size_t)std::max(0, count));
+    for (size_t i=0; i<updates.size(); i++) {
+        updates[i] = { 0, static_cast<MixerTrackParam>(params[i]), values[i], tracks[i] };
+    }
+    static_cast<JuceMixPlayer *>(ptr)->updateTracks(std::move(updates));
+}
+
 void JuceMixPlayer_onStateUpdate(void* ptr, void (*onStateUpdate)(void* ptr, const char*)) {
     static_cast<JuceMixPlayer *>(ptr)->onStateUpdateCallback = onStateUpdate;
 }
@@ -70,6 +126,22 @@ void JuceMixPlayer_seek(void* ptr, float value) {
     static_cast<JuceMixPlayer *>(ptr)->seek(value);
 }
 
+void JuceMixPlayer_setLoopRegion(void* ptr, float start, float end) {
+    static_cast<JuceMixPlayer *>(ptr)->setLoopRegion(start, end);
+}
+
+void JuceMixPlayer_setBusGain(void* ptr, float gain) {
+    static_cast<JuceMixPlayer *>(ptr)->setBusGain(gain);
+}
+
+static_assert(sizeof(JuceMixPlayerTransport) == sizeof(TransportState), "same layout");
+static_assert(offsetof(JuceMixPlayerTransport, playHead) == offsetof(TransportState, playHead), "same layout");
+static_assert(offsetof(JuceMixPlayerTransport, outputLevel) == offsetof(TransportState, outputLevel), "same layout");
+
+const JuceMixPlayerTransport* JuceMixPlayer_getTransport(void* ptr) {
+    return reinterpret_cast<const JuceMixPlayerTransport*>(&static_cast<JuceMixPlayer *>(ptr)->getTransport());
+}
+
 void JuceMixPlayer_prepareRecorder(void* ptr, const char* file) {
     static_cast<JuceMixPlayer *>(ptr)->prepareRecorder(file);
 }
@@ -110,10 +182,44 @@ const char* JuceMixPlayer_getDeviceLatencyInfo(void *ptr) {
     return static_cast<JuceMixPlayer *>(ptr)->getDeviceLatencyInfo();
 }
 
+const char* JuceMixPlayer_getBufferedRanges(void *ptr) {
+    return static_cast<JuceMixPlayer *>(ptr)->getBufferedRanges();
+}
+
+int JuceMixPlayer_readLevels(void* ptr, float* output, int maxFrames) {
+    return static_cast<JuceMixPlayer *>(ptr)->readLevels(output, maxFrames);
+}
+
+int JuceMixPlayer_getWaveform(void* ptr, const char* path, float startTime, float endTime, int numPoints, float* output) {
+    return static_cast<JuceMixPlayer *>(ptr)->getWaveform(path, startTime, endTime, numPoints, output);
+}
+
+void JuceMixPlayer_onWaveformReady(void* ptr, void (*onReady)(void* ptr, const char* path)) {
+    static_cast<JuceMixPlayer *>(ptr)->onWaveformReadyCallback = onReady;
+}
+
+void JuceMixPlayer_setWaveformCacheDir(void* ptr, const char* path) {
+    static_cast<JuceMixPlayer *>(ptr)->setWaveformCacheDir(path);
+}
+
+int JuceMixPlayer_getLoudness(void* ptr, const char* path, float* output) {
+    return static_cast<JuceMixPlayer *>(ptr)->getLoudness(path, output);
+}
+
+int JuceMixPlayer_getMixLoudness(void* ptr, float* output) {
+    return static_cast<JuceMixPlayer *>(ptr)->getMixLoudness(output);
+}
+
+void JuceMixPlayer_onLoudnessReady(void* ptr, void (*onReady)(void* ptr, const char* path)) {
+    static_cast<JuceMixPlayer *>(ptr)->onLoudnessReadyCallback = onReady;
+}
+
 void JuceMixPlayer_export(void* ptr,
                           const char *outputPath,
                           void (*completion)(const char*)) {
-    return static_cast<JuceMixPlayer *>(ptr)->exportToFile(outputPath, completion);
+    return static_cast<JuceMixPlayer *>(ptr)->exportToFile(outputPath, [completion](const char* error) {
+        completion(returnCopyChar(error));
+    });
 }
 
 // Utility methods
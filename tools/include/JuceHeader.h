@@ -0,0 +1,9 @@
+#pragma once
+
+// Replaces the Projucer generated JuceHeader.h for the CMake build.
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_devices/juce_audio_devices.h>
@@ -0,0 +1,442 @@
+#include "JuceMixPlayer.h"
+
+// Microbenchmarks for block math, one-shot sampler hits of repeated tracks, mixing, play buffer storage formats,
+// the output callback resampling and the recorder resampling. Results are printed as json so runs of
+// different releases can be compared with the same parameter grids.
+
+#ifndef JUCE_MIX_BENCH_ASSETS
+#define JUCE_MIX_BENCH_ASSETS "flutter_app/assets/media"
+#endif
+
+using BenchClock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    juce::File assets = juce::File::getCurrentWorkingDirectory().getChildFile(JUCE_MIX_BENCH_ASSETS);
+    std::string filter = "";
+    double minTime = 0.25; // seconds per case
+    int minIterations = 5;
+    int maxIterations = 100000;
+};
+
+static BenchOptions options;
+static nlohmann::json results = nlohmann::json::array();
+
+static bool isEnabled(const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+/// Times `run` until `options.minTime` elapsed. `setup` runs untimed before every iteration.
+/// `opsPerIteration` divides the timings, `audioSeconds` is the audio processed per iteration.
+static void measure(const std::string& name,
+                    const nlohmann::json& params,
+                    int opsPerIteration,
+                    double audioSeconds,
+                    std::function<void()> run,
+                    std::function<void()> setup = nullptr) {
+    if (!isEnabled(name)) {
+        return;
+    }
+
+    // warm up caches and lazy allocations
+    if (setup) setup();
+    run();
+
+    std::vector<double> samples;
+    double total = 0;
+    while ((int)samples.size() < options.minIterations
+           || (total < options.minTime && (int)samples.size() < options.maxIterations)) {
+        if (setup) setup();
+        auto start = BenchClock::now();
+        run();
+        double elapsed = std::chrono::duration<double>(BenchClock::now() - start).count();
+        samples.push_back(elapsed);
+        total += elapsed;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    const double toNs = 1e9 / opsPerIteration;
+    const double median = samples[samples.size() / 2];
+
+    nlohmann::json result;
+    result["name"] = name;
+    result["params"] = params;
+    result["iterations"] = samples.size();
+    result["nsPerOp"] = {
+        {"min", samples.front() * toNs},
+        {"median", median * toNs},
+        {"mean", total / samples.size() * toNs},
+        {"p95", samples[std::min(samples.size() - 1, samples.size() * 95 / 100)] * toNs},
+    };
+    if (audioSeconds > 0) {
+        // audio seconds processed per wall clock second, at the median
+        result["realtimeFactor"] = audioSeconds / median;
+    }
+    results.push_back(result);
+
+    std::cerr << name << " " << params.dump() << ": " << median * toNs << " ns/op" << std::endl;
+}
+
+static void fillNoise(juce::AudioBuffer<float>& buffer) {
+    juce::Random random(1234);
+    for (int ch=0; ch<buffer.getNumChannels(); ch++) {
+        float* data = buffer.getWritePointer(ch);
+        for (int i=0; i<buffer.getNumSamples(); i++) {
+            data[i] = random.nextFloat() * 2.0f - 1.0f;
+        }
+    }
+}
+
+static std::string composition(const std::vector<std::string>& files, bool repeat = false) {
+    nlohmann::json tracks = nlohmann::json::array();
+    for (size_t i=0; i<files.size(); i++) {
+        nlohmann::json track;
+        track["id_"] = "track_" + std::to_string(i);
+        track["path"] = options.assets.getChildFile(files[i]).getFullPathName().toStdString();
+        track["volume"] = 1.0f / files.size();
+        if (repeat) {
+            track["repeat"] = true;
+            track["repeatInterval"] = 2.0;
+            track["offset"] = 0.5 * (i % 4);
+        }
+        tracks.push_back(track);
+    }
+    nlohmann::json j;
+    j["tracks"] = tracks;
+    return j.dump();
+}
+
+struct JuceMixPlayerBenchmark {
+
+    static void calculateBlockToRead() {
+        if (!isEnabled("calculateBlockToRead")) return;
+
+        JuceMixPlayer player(false);
+        MixerTrack track;
+        track.path = options.assets.getChildFile("beats.wav").getFullPathName().toStdString();
+        track.reader.reset(player.formatManager.createReaderFor(juce::File(track.path)));
+        if (!track.reader) {
+            std::cerr << "skipping calculateBlockToRead, unable to read " << track.path << std::endl;
+            return;
+        }
+        const int calls = 1000;
+        const int blockSamples = player.maxBlockDuration * player.sampleRate;
+        for (float offset: {0.0f, 3.3f, 60.0f}) {
+            for (float fromTime: {0.0f, 1.5f}) {
+                track.offset = offset;
+                track.fromTime = fromTime;
+                volatile float sink = 0;
+                measure("calculateBlockToRead", {{"offset", offset}, {"fromTime", fromTime}}, calls, 0, [&] {
+                    for (int i=0; i<calls; i++) {
+                        auto res = player._calculateRangeToRead((i % 16) * blockSamples, blockSamples, track);
+                        if (res.has_value()) sink = std::get<1>(res.value());
+                    }
+                });
+            }
+        }
+    }
+
+    static void oneShotSampler() {
+        if (!isEnabled("oneShotSampler")) return;
+
+        JuceMixPlayer player(false);
+        auto sample = player._loadOneShotSample(options.assets.getChildFile("met_h.wav").getFullPathName().toStdString());
+        if (!sample) {
+            std::cerr << "skipping oneShotSampler, unable to read met_h.wav" << std::endl;
+            return;
+        }
+
+        // one audio callback worth of timeline
+        const int bufferSize = 256;
+        juce::AudioBuffer<float> output(2, bufferSize);
+        const int calls = 1000;
+
+        for (float interval: {0.25f, 0.5f, 2.0f}) {
+            OneShotSampler sampler;
+            // four metronome tracks, as in the README composition
+            for (int i=0; i<4; i++) {
+                sampler.add({ sample, 0.5 * i * player.sampleRate, interval * player.sampleRate, 0.25f });
+            }
+            // minute 60 is one hour into the timeline, the cost must not grow with the position
+            for (int minute: {0, 1, 10, 60}) {
+                const juce::int64 start = (juce::int64)minute * 60 * player.sampleRate;
+                measure("oneShotSampler", {{"repeatInterval", interval}, {"minute", minute}}, calls, calls * bufferSize / player.sampleRate, [&] {
+                    for (int i=0; i<calls; i++) {
+                        sampler.render(output, 0, start + (juce::int64)i * bufferSize, bufferSize);
+                    }
+                }, [&] {
+                    output.clear();
+                });
+            }
+        }
+    }
+
+    static void mixAddFrom() {
+        if (!isEnabled("mixAddFrom")) return;
+
+        const int sampleRate = 48000;
+        for (float blockSeconds: {0.1f, 1.0f, 5.0f}) {
+            const int sampleCount = blockSeconds * sampleRate;
+            juce::AudioBuffer<float> playBuffer(2, sampleCount);
+            playBuffer.clear();
+            // mono tracks are mixed to both sides from one channel
+            for (int channels: {1, 2}) {
+                juce::AudioBuffer<float> tempBuffer(channels, sampleCount);
+                fillNoise(tempBuffer);
+                for (int tracks: {1, 4, 8, 16, 32}) {
+                    // same accumulation `_renderRange` does per track
+                    measure("mixAddFrom", {{"tracks", tracks}, {"blockSeconds", blockSeconds}, {"channels", channels}}, 1, blockSeconds, [&] {
+                        for (int t=0; t<tracks; t++) {
+                            MixKernels::addChannels(playBuffer, 0, tempBuffer, channels, 0, sampleCount, 0.5f);
+                        }
+                    });
+                }
+            }
+        }
+    }
+
+    static void playBufferFormat() {
+        if (!isEnabled("playBuffer")) return;
+
+        const int sampleRate = 48000;
+        const int pageSamples = 0.5 * sampleRate;
+        const int blockSamples = 5 * sampleRate;
+        juce::AudioBuffer<float> block(2, blockSamples);
+        fillNoise(block);
+        for (auto format: {PlayBuffer::SampleFormat::FLOAT32, PlayBuffer::SampleFormat::INT16}) {
+            const std::string formatName = format == PlayBuffer::SampleFormat::INT16 ? "int16" : "float32";
+            PlayBuffer playBuffer;
+            playBuffer.setSize(2, blockSamples, pageSamples);
+            playBuffer.setSampleFormat(format);
+            // narrowing of a loaded block, pages already allocated like a reload
+            measure("playBufferWrite", {{"format", formatName}}, 1, 5, [&] {
+                playBuffer.write(0, block, 0, blockSamples);
+            });
+            std::cerr << "playBuffer " << formatName << ": " << playBuffer.getNumAllocatedBytes() / 5 << " bytes per second" << std::endl;
+            // expanding in the audio callback
+            for (int bufferSize: {256, 1024}) {
+                juce::AudioBuffer<float> output(2, bufferSize);
+                const int calls = blockSamples / bufferSize;
+                measure("playBufferRead", {{"format", formatName}, {"bufferSize", bufferSize}}, calls, calls * bufferSize / (double)sampleRate, [&] {
+                    for (int i=0; i<calls; i++) {
+                        playBuffer.read(i * bufferSize, output, 0, bufferSize);
+                    }
+                });
+            }
+        }
+    }
+
+    static void loadAudioBlock() {
+        if (!isEnabled("loadAudioBlock")) return;
+
+        for (std::string file: {"beats.wav", "tu_hi_re_92_D_sharp_bgm.mp3"}) {
+            // memory mapped where the format allows it, or the buffered stream readers
+            for (bool mapped: {true, false}) {
+                for (int tracks: {1, 4, 8}) {
+                    JuceMixPlayer player(false);
+                    if (!mapped) {
+                        player.readerFactory = [&player](const juce::File& file) {
+                            return player.formatManager.createReaderFor(file);
+                        };
+                    }
+                    player.mixerData = MixerModel::parse(composition(std::vector<std::string>(tracks, file)).c_str());
+                    player._createFileReadersAndTotalDuration();
+                    if (player.playBuffer.getNumSamples() == 0) {
+                        std::cerr << "skipping loadAudioBlock, unable to read " << file << std::endl;
+                        break;
+                    }
+                    // the second full size block
+                    const int blockPages = player._getPageCount(player.maxBlockDuration);
+                    measure("loadAudioBlock", {{"file", file}, {"tracks", tracks}, {"mapped", mapped}}, 1, player.maxBlockDuration, [&] {
+                        player._loadAudioBlock(blockPages, blockPages, player.taskQueueIndex);
+                    }, [&] {
+                        player.playBuffer.clear();
+                    });
+                }
+            }
+        }
+        // four repeated metronome tracks, as in the README composition
+        JuceMixPlayer player(false);
+        player.mixerData = MixerModel::parse(composition({"beats.wav", "met_h.wav", "met_l.wav", "met_l.wav", "met_l.wav"}).c_str());
+        for (size_t i=1; i<player.mixerData.tracks.size(); i++) {
+            player.mixerData.tracks[i].repeat = true;
+            player.mixerData.tracks[i].repeatInterval = 2.0;
+            player.mixerData.tracks[i].offset = 0.5 * (i - 1);
+        }
+        player._createFileReadersAndTotalDuration();
+        if (player.playBuffer.getNumSamples() > 0) {
+            const int blockPages = player._getPageCount(player.maxBlockDuration);
+            measure("loadAudioBlock", {{"file", "beats.wav+metronome"}, {"tracks", 5}}, 1, player.maxBlockDuration, [&] {
+                player._loadAudioBlock(blockPages, blockPages, player.taskQueueIndex);
+            }, [&] {
+                player.playBuffer.clear();
+            });
+        }
+    }
+
+    static void blockCodec() {
+        if (!isEnabled("blockCodec")) return;
+
+        for (std::string file: {"beats.wav", "tu_hi_re_92_D_sharp_bgm.mp3"}) {
+            // pages of a rendered block, as they are evicted
+            JuceMixPlayer player(false);
+            player.mixerData = MixerModel::parse(composition({file}).c_str());
+            player._createFileReadersAndTotalDuration();
+            if (player.playBuffer.getNumSamples() == 0) {
+                std::cerr << "skipping blockCodec, unable to read " << file << std::endl;
+                continue;
+            }
+            const int blockPages = std::min(player._getPageCount(player.maxBlockDuration), player.playBuffer.getNumPages());
+            player._loadAudioBlock(0, blockPages, player.taskQueueIndex);
+            const int numChannels = player.playBuffer.getNumChannels();
+            const int pageSize = player.playBuffer.getPageSize();
+            const double audioSeconds = blockPages * player.pageDuration;
+
+            std::vector<std::vector<juce::int16>> pages(blockPages, std::vector<juce::int16>((size_t)(numChannels * pageSize)));
+            for (int i=0; i<blockPages; i++) {
+                if (auto audio = player.playBuffer.getPageAudio(i)) {
+                    audio->read(pages[i].data());
+                }
+            }
+            std::vector<std::vector<juce::uint8>> encoded(blockPages);
+            measure("blockCodecEncode", {{"file", file}}, blockPages, audioSeconds, [&] {
+                for (int i=0; i<blockPages; i++) {
+                    encoded[i] = BlockCodec::encode(pages[i].data(), numChannels, pageSize);
+                }
+            });
+            size_t encodedBytes = 0;
+            for (const auto& data: encoded) {
+                encodedBytes += data.size();
+            }
+            std::vector<juce::int16> decoded((size_t)(numChannels * pageSize));
+            measure("blockCodecDecode", {{"file", file}}, blockPages, audioSeconds, [&] {
+                for (int i=0; i<blockPages; i++) {
+                    BlockCodec::decode(encoded[i], decoded.data(), numChannels, pageSize);
+                }
+            });
+            results.back()["ratio"] = encodedBytes / (double)((size_t)blockPages * pages[0].size() * sizeof(juce::int16));
+            std::cerr << "blockCodec " << file << ": " << encodedBytes / audioSeconds << " bytes per second" << std::endl;
+        }
+    }
+
+    static void callbackInterpolator() {
+        if (!isEnabled("callbackInterpolator")) return;
+
+        JuceMixPlayer player(false);
+        try {
+            player.renderOffline(composition({"beats.wav"}).c_str());
+        } catch (const std::exception& e) {
+            std::cerr << "skipping callbackInterpolator, " << e.what() << std::endl;
+            return;
+        }
+        if (player.playBuffer.getNumSamples() == 0) {
+            std::cerr << "skipping callbackInterpolator, unable to read beats.wav" << std::endl;
+            return;
+        }
+        player._isPlaying = true;
+        player._isPlayingInternal = true;
+
+        for (int quality: {0, 1, 2}) {
+            player.settings.resamplerQuality = quality;
+            for (float deviceSampleRate: {44100.0f, 48000.0f, 96000.0f}) {
+                for (int bufferSize: {64, 256, 1024}) {
+                    juce::AudioBuffer<float> output(2, bufferSize);
+                    juce::AudioIODeviceCallbackContext context;
+                    player.deviceSampleRate = deviceSampleRate;
+                    player.samplesPerBlockExpected = bufferSize;
+                    {
+                        // `audioDeviceAboutToStart` does this for a real device, the callback never allocates
+                        auto newResampler = player._createResampler(quality, player.sampleRate);
+                        const juce::ScopedLock sl (player.lock);
+                        player._swapResampler(newResampler);
+                    }
+                    player.playHeadIndex = 0;
+                    const int calls = 64;
+                    measure("callbackInterpolator", {{"resamplerQuality", quality}, {"deviceSampleRate", deviceSampleRate}, {"bufferSize", bufferSize}}, calls, calls * bufferSize / deviceSampleRate, [&] {
+                        for (int i=0; i<calls; i++) {
+                            player.audioDeviceIOCallbackWithContext(nullptr, 0, output.getArrayOfWritePointers(), 2, bufferSize, context);
+                        }
+                    }, [&] {
+                        // keep away from the end so the callback never completes playback
+                        if (player.playHeadIndex + 2 * calls * bufferSize * player.sampleRate / deviceSampleRate >= player.playBuffer.getNumSamples()) {
+                            player.playHeadIndex = 0;
+                        }
+                    });
+                }
+            }
+        }
+        player._isPlaying = false;
+    }
+
+    static void recorderResample() {
+        if (!isEnabled("flushRecordBufferToFile")) return;
+
+        JuceMixPlayer player(false);
+        player.settings.sampleRate = 48000;
+        for (float deviceSampleRate: {16000.0f, 44100.0f, 48000.0f}) {
+            for (float seconds: {1.0f, 10.0f}) {
+                juce::AudioBuffer<float> buffer(1, seconds * deviceSampleRate);
+                fillNoise(buffer);
+                player.deviceSampleRate = deviceSampleRate;
+                measure("flushRecordBufferToFile", {{"deviceSampleRate", deviceSampleRate}, {"seconds", seconds}}, 1, seconds, [&] {
+                    player.flushRecordBufferToFile(buffer, buffer.getNumSamples());
+                }, [&] {
+                    juce::WavAudioFormat format;
+                    player.recWriter.reset(format.createWriterFor(new juce::MemoryOutputStream(), 48000, 1, 16, {}, 0));
+                });
+            }
+        }
+        player.recWriter.reset();
+    }
+};
+
+static void printUsage() {
+    std::cerr << "Usage: juce_mix_bench [--assets dir] [--filter name] [--min-time seconds] [--output results.json]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string outputPath;
+
+    for (int i=1; i<argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--assets" && i + 1 < argc) {
+            options.assets = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.minTime = std::atof(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!options.assets.isDirectory()) {
+        std::cerr << "Assets directory not found: " << options.assets.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    JuceMixPlayerBenchmark::calculateBlockToRead();
+    JuceMixPlayerBenchmark::oneShotSampler();
+    JuceMixPlayerBenchmark::mixAddFrom();
+    JuceMixPlayerBenchmark::playBufferFormat();
+    JuceMixPlayerBenchmark::loadAudioBlock();
+    JuceMixPlayerBenchmark::blockCodec();
+    JuceMixPlayerBenchmark::callbackInterpolator();
+    JuceMixPlayerBenchmark::recorderResample();
+
+    nlohmann::json report;
+    report["suite"] = "juce_mix_bench";
+    report["cpu"] = juce::SystemStats::getCpuModel().toStdString();
+    report["os"] = juce::SystemStats::getOperatingSystemName().toStdString();
+    report["minTime"] = options.minTime;
+    report["results"] = results;
+
+    if (outputPath.empty()) {
+        std::cout << report.dump(4) << std::endl;
+    } else {
+        juce::File(outputPath).replaceWithText(report.dump(4));
+    }
+    return 0;
+}
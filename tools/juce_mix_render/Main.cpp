@@ -0,0 +1,86 @@
+#include "JuceMixPlayer.h"
+#include <sys/resource.h>
+
+// Renders a composition (same json as `JuceMixPlayer_set`) without an audio device
+// and prints throughput, peak memory and per-phase timings as json.
+
+static void printUsage() {
+    std::cerr << "Usage: juce_mix_render <composition.json> [--output file.wav|file.flac] [--iterations N]" << std::endl;
+}
+
+// peak resident set size in bytes
+static long getPeakRss() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if JUCE_MAC
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss * 1024;
+#endif
+}
+
+// track paths are resolved relative to the composition file
+static std::string resolvePaths(const juce::File& compositionFile) {
+    nlohmann::json j = nlohmann::json::parse(compositionFile.loadFileAsString().toStdString());
+    for (auto& track: j["tracks"]) {
+        std::string path = track.value("path", "");
+        if (!path.empty() && !juce::File::isAbsolutePath(path)) {
+            track["path"] = compositionFile.getParentDirectory().getChildFile(path).getFullPathName().toStdString();
+        }
+    }
+    return j.dump();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    juce::File compositionFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[1]);
+    std::string outputPath;
+    int iterations = 1;
+
+    for (int i=2; i<argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--output" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!compositionFile.existsAsFile()) {
+        std::cerr << "File not found: " << compositionFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    try {
+        const std::string json = resolvePaths(compositionFile);
+        nlohmann::json runs = nlohmann::json::array();
+
+        for (int i=0; i<iterations; i++) {
+            std::unique_ptr<JuceMixPlayer> player(new JuceMixPlayer(false));
+            player->onErrorCallback = [](void*, const char* error) {
+                std::cerr << "error: " << error << std::endl;
+                freeCopyChar(error);
+            };
+            const bool write = i == iterations - 1 && !outputPath.empty();
+            MixerRenderStats stats = player->renderOffline(json.c_str(), write ? outputPath.c_str() : nullptr);
+            runs.push_back(stats);
+        }
+
+        nlohmann::json result;
+        result["composition"] = compositionFile.getFullPathName().toStdString();
+        result["runs"] = runs;
+        result["peakRss"] = getPeakRss();
+        std::cout << result.dump(4) << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,478 @@
+#include "JuceMixPlayer.h"
+#include "VirtualAudioIODevice.h"
+#include "SlowAudioFormatReader.h"
+
+// Drives a player through a virtual audio device with a random script of seek, setJson,
+// updateTracks, play, pause and recorder calls. Reports underruns, silent buffers, time to audible
+// after each action and the callback time.
+
+#ifndef JUCE_MIX_STRESS_ASSETS
+#define JUCE_MIX_STRESS_ASSETS "flutter_app/assets/media"
+#endif
+
+struct StressOptions {
+    juce::File assets = juce::File::getCurrentWorkingDirectory().getChildFile(JUCE_MIX_STRESS_ASSETS);
+    double sampleRate = 48000;
+    int bufferSize = 256;
+    double speed = 1.0; // 0 = as fast as possible
+    double duration = 60; // device seconds
+    double decodeLatency = 0; // millis per read
+    double decodeLatencyPerSecond = 0; // millis per decoded second
+    bool recorder = true;
+    bool loop = false;
+    std::string settings = ""; // MixerSettings json
+    int sharedBus = 0; // muted preview players sharing the output bus with the scripted one
+    int playerPool = 0; // released previews kept for reuse
+    bool trackUpdates = false; // some setJson actions edit tracks with `updateTracks` instead
+    int seed = 1;
+};
+
+/// Shared between the device thread, the script thread and the player callbacks.
+struct StressStats {
+    std::mutex mutex;
+
+    double deviceTime = 0; // seconds of audio produced
+    juce::int64 callbacks = 0;
+    double maxCallbackTime = 0; // millis
+    double callbackBudget = 0; // millis
+    juce::int64 lateCallbacks = 0; // callback slower than its buffer duration
+    juce::int64 silentBuffers = 0; // silent while playing
+    juce::int64 underruns = 0; // silent while playing and no action is settling
+
+    // action waiting for the first audible buffer
+    std::string pendingAction = "";
+    double pendingSince = 0;
+    std::map<std::string, std::vector<double>> timeToAudible; // millis of device time
+    std::map<std::string, int> unresolved;
+    std::map<std::string, int> actions;
+
+    std::atomic<bool> playing { false };
+    std::atomic<bool> recorderReady { false };
+    std::atomic<int> errors { 0 };
+    std::atomic<juce::int64> levelFrames { 0 }; // live level frames drained by the poller
+    std::atomic<juce::int64> transportFrames { 0 }; // polls that found the transport updated
+    std::vector<double> previewReplaceTimes; // millis to release a preview and acquire the next, preview thread only
+
+    void startPending(const std::string& action) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!pendingAction.empty()) {
+            unresolved[pendingAction]++;
+        }
+        pendingAction = action;
+        pendingSince = deviceTime;
+    }
+
+    void cancelPending() {
+        std::lock_guard<std::mutex> guard(mutex);
+        pendingAction = "";
+    }
+
+    void onBuffer(const float* const* output, int numChannels, int numSamples, double sampleRate, double callbackTimeMs) {
+        float magnitude = 0;
+        for (int ch=0; ch<numChannels; ch++) {
+            auto range = juce::FloatVectorOperations::findMinAndMax(output[ch], numSamples);
+            magnitude = std::max({ magnitude, std::abs(range.getStart()), std::abs(range.getEnd()) });
+        }
+        const bool silent = magnitude < 1e-6f;
+        const double budget = numSamples * 1000.0 / sampleRate;
+
+        std::lock_guard<std::mutex> guard(mutex);
+        callbacks++;
+        callbackBudget = budget;
+        maxCallbackTime = std::max(maxCallbackTime, callbackTimeMs);
+        if (callbackTimeMs > budget) {
+            lateCallbacks++;
+        }
+        if (!silent && !pendingAction.empty()) {
+            timeToAudible[pendingAction].push_back((deviceTime - pendingSince) * 1000.0);
+            pendingAction = "";
+        } else if (silent && playing) {
+            silentBuffers++;
+            if (pendingAction.empty()) {
+                underruns++;
+            }
+        }
+        deviceTime += numSamples / sampleRate;
+    }
+
+    double getDeviceTime() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return deviceTime;
+    }
+};
+
+static StressOptions options;
+static StressStats stats;
+
+static nlohmann::json summarise(std::vector<double> values) {
+    nlohmann::json j;
+    j["count"] = values.size();
+    if (values.empty()) {
+        return j;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (double v: values) sum += v;
+    j["min"] = values.front();
+    j["avg"] = sum / values.size();
+    j["p95"] = values[std::min(values.size() - 1, values.size() * 95 / 100)];
+    j["max"] = values.back();
+    return j;
+}
+
+/// Continuous tone, keeps the mix audible for the whole timeline so silence always means a gap.
+static juce::File createToneFile(double seconds) {
+    juce::File file = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("juce_mix_stress_tone.wav");
+    file.deleteFile();
+    juce::WavAudioFormat format;
+    std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(new juce::FileOutputStream(file), 48000, 1, 16, {}, 0));
+    juce::AudioBuffer<float> buffer(1, 48000);
+    for (int i=0; i<buffer.getNumSamples(); i++) {
+        buffer.setSample(0, i, 0.2f * (float)std::sin(juce::MathConstants<double>::twoPi * 220.0 * i / 48000.0));
+    }
+    for (int s=0; s<(int)std::ceil(seconds); s++) {
+        writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+    }
+    return file;
+}
+
+static std::string composition(const juce::File& tone, juce::Random& random, bool variant) {
+    auto asset = [](const char* name) {
+        return options.assets.getChildFile(name).getFullPathName().toStdString();
+    };
+    nlohmann::json tracks = nlohmann::json::array();
+    tracks.push_back({{"id_", "tone"}, {"path", tone.getFullPathName().toStdString()}, {"volume", 0.5}});
+    tracks.push_back({{"id_", "beats"}, {"path", asset("beats.wav")}, {"volume", variant ? random.nextFloat() : 0.8f}});
+    for (int i=0; i<4; i++) {
+        if (variant && random.nextInt(4) == 0) {
+            // dropping a track replaces the mix data, keeping all only updates volumes
+            continue;
+        }
+        tracks.push_back({
+            {"id_", "met_" + std::to_string(i)},
+            {"path", asset(i == 0 ? "met_h.wav" : "met_l.wav")},
+            {"offset", 0.5 * i},
+            {"volume", 0.1},
+            {"repeat", true},
+            {"repeatInterval", 2.0},
+        });
+    }
+    nlohmann::json j;
+    j["tracks"] = tracks;
+    return j.dump();
+}
+
+static void runScript(JuceMixPlayer* player, const juce::File& tone) {
+    juce::Random random(options.seed);
+    juce::File recordFile = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("juce_mix_stress_rec.wav");
+    bool recording = false;
+
+    auto waitUntil = [](double deviceTime) {
+        while (stats.getDeviceTime() < deviceTime) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    player->setJson(composition(tone, random, false).c_str());
+    stats.startPending("setJson");
+    player->play();
+
+    double time = 0;
+    while (time < options.duration) {
+        time += 0.2 + random.nextDouble() * 1.8;
+        waitUntil(time);
+
+        int action = random.nextInt(100);
+        if (action < 35) {
+            stats.actions["seek"]++;
+            if (options.loop && random.nextInt(3) == 0) {
+                // a region of 2 to 10 seconds, or none
+                const float start = random.nextFloat() * 30;
+                player->setLoopRegion(start, random.nextBool() ? start + 2 + random.nextFloat() * 8 : 0);
+            }
+            player->seek(random.nextFloat());
+            if (player->isPlaying()) stats.startPending("seek");
+        } else if (action < 55 && options.trackUpdates && random.nextBool()) {
+            stats.actions["updateTracks"]++;
+            // tone and beats are in every composition. Mostly volumes, heard without a reset,
+            // sometimes a trim that changes the timeline or beats turned into a repeat track and back.
+            const int edit = random.nextInt(10);
+            if (edit < 7) {
+                player->updateTracks({
+                    { 0, MixerTrackParam::VOLUME, random.nextFloat(), "tone" },
+                    { 0, MixerTrackParam::VOLUME, random.nextFloat(), "beats" }
+                });
+            } else if (edit < 9) {
+                player->updateTracks({ { 0, MixerTrackParam::DURATION, edit == 7 ? 0.0f : 10 + random.nextFloat() * 20, "tone" } });
+            } else {
+                player->updateTracks({
+                    { 0, MixerTrackParam::REPEAT, random.nextBool() ? 1.0f : 0.0f, "beats" },
+                    { 0, MixerTrackParam::REPEAT_INTERVAL, 4, "beats" }
+                });
+            }
+            if (player->isPlaying()) stats.startPending("updateTracks");
+        } else if (action < 55) {
+            stats.actions["setJson"]++;
+            // replacing the mix data pauses, the app resumes right after
+            const bool wasPlaying = player->isPlaying();
+            player->setJson(composition(tone, random, true).c_str());
+            if (wasPlaying) {
+                player->play();
+                stats.startPending("setJson");
+            }
+        } else if (action < 75) {
+            stats.actions["play"]++;
+            if (!player->isPlaying()) stats.startPending("play");
+            player->play();
+        } else if (action < 85) {
+            stats.actions["pause"]++;
+            player->pause();
+            stats.cancelPending();
+        } else if (action < 95 && options.recorder) {
+            if (recording) {
+                stats.actions["stopRecorder"]++;
+                player->stopRecorder();
+            } else {
+                stats.actions["startRecorder"]++;
+                stats.recorderReady = false;
+                player->prepareRecorder(recordFile.getFullPathName().toRawUTF8());
+                waitUntil(stats.getDeviceTime() + 0.05);
+                // prepare waits behind block loading on the task queue
+                for (int i=0; i<5000 && !stats.recorderReady; i++) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                player->startRecorder();
+            }
+            recording = !recording;
+        }
+    }
+    if (recording) {
+        player->stopRecorder();
+    }
+    player->pause();
+}
+
+static void printUsage() {
+    std::cerr << "Usage: juce_mix_stress [--assets dir] [--sample-rate hz] [--buffer-size samples] [--speed x]"
+              << " [--duration seconds] [--decode-latency ms] [--decode-latency-per-second ms]"
+              << " [--no-recorder] [--loop] [--settings json] [--shared-bus players] [--player-pool size] [--track-updates] [--seed n]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    for (int i=1; i<argc; i++) {
+        std::string arg(argv[i]);
+        bool hasValue = i + 1 < argc;
+        if (arg == "--assets" && hasValue) {
+            options.assets = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        } else if (arg == "--sample-rate" && hasValue) {
+            options.sampleRate = std::atof(argv[++i]);
+        } else if (arg == "--buffer-size" && hasValue) {
+            options.bufferSize = std::max(16, std::atoi(argv[++i]));
+        } else if (arg == "--speed" && hasValue) {
+            options.speed = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "--duration" && hasValue) {
+            options.duration = std::atof(argv[++i]);
+        } else if (arg == "--decode-latency" && hasValue) {
+            options.decodeLatency = std::atof(argv[++i]);
+        } else if (arg == "--decode-latency-per-second" && hasValue) {
+            options.decodeLatencyPerSecond = std::atof(argv[++i]);
+        } else if (arg == "--no-recorder") {
+            options.recorder = false;
+        } else if (arg == "--loop") {
+            options.loop = true;
+        } else if (arg == "--settings" && hasValue) {
+            options.settings = argv[++i];
+        } else if (arg == "--shared-bus" && hasValue) {
+            options.sharedBus = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--player-pool" && hasValue) {
+            options.playerPool = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--track-updates") {
+            options.trackUpdates = true;
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::atoi(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!options.assets.isDirectory()) {
+        std::cerr << "Assets directory not found: " << options.assets.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    // looping keeps the timeline at 40s so long runs wrap, a gap at the loop end counts as an underrun
+    const juce::File tone = createToneFile(options.loop ? 40.0 : std::max(40.0, options.duration));
+
+    VirtualAudioIODevice::Config config;
+    config.sampleRate = options.sampleRate;
+    config.bufferSize = options.bufferSize;
+    config.speed = options.speed;
+    config.onBufferProcessed = [](const float* const* output, int numChannels, int numSamples, double sampleRate, double callbackTimeMs) {
+        stats.onBuffer(output, numChannels, numSamples, sampleRate, callbackTimeMs);
+    };
+
+    juce::AudioDeviceManager deviceManager;
+    deviceManager.addAudioDeviceType(std::make_unique<VirtualAudioIODeviceType>(config));
+    deviceManager.setCurrentAudioDeviceType(VirtualAudioIODeviceType::typeName, true);
+    JuceMixPlayer::setAudioDeviceManager(&deviceManager);
+    JuceMixPlayer::setSharedOutputBus(options.sharedBus > 0);
+    JuceMixPlayer::setPoolSize(options.playerPool);
+
+    // disposed players delete themselves later, the process exits before that
+    JuceMixPlayer* player = new JuceMixPlayer();
+    nlohmann::json settings = options.settings.empty() ? nlohmann::json::object() : nlohmann::json::parse(options.settings);
+    if (options.loop) {
+        settings["loop"] = true;
+    }
+    if (!settings.empty()) {
+        player->setSettings(settings.dump().c_str());
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    player->setReaderFactory([&formatManager](const juce::File& file) -> juce::AudioFormatReader* {
+        juce::AudioFormatReader* reader = formatManager.createReaderFor(file);
+        if (reader == nullptr || (options.decodeLatency <= 0 && options.decodeLatencyPerSecond <= 0)) {
+            return reader;
+        }
+        return new SlowAudioFormatReader(reader, options.decodeLatency, options.decodeLatencyPerSecond);
+    });
+    player->onStateUpdateCallback = [](void*, const char* state) {
+        // READY arrives while playing once the first block of new mix data is loaded
+        std::string value(state);
+        freeCopyChar(state);
+        if (value != "READY") {
+            stats.playing = value == "PLAYING";
+        }
+    };
+    player->onRecStateUpdateCallback = [](void*, const char* state) {
+        stats.recorderReady = std::string(state) == "READY";
+        freeCopyChar(state);
+    };
+    player->onErrorCallback = [](void*, const char* error) {
+        stats.errors++;
+        std::cerr << "error: " << error << std::endl;
+        freeCopyChar(error);
+    };
+    player->onRecErrorCallback = [](void*, const char* error) {
+        stats.errors++;
+        std::cerr << "recorder error: " << error << std::endl;
+        freeCopyChar(error);
+    };
+
+    std::thread script([player, tone] {
+        // device starts from the message thread
+        while (stats.getDeviceTime() <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        runScript(player, tone);
+        juce::MessageManager::callAsync([] {
+            juce::MessageManager::getInstance()->stopDispatchLoop();
+        });
+    });
+
+    // drains the live level stream like a UI ticker would
+    std::atomic<bool> scriptDone { false };
+
+    // previews play the tone muted on the shared bus, one is replaced every second so players join and leave while it mixes
+    std::thread previews([tone, &scriptDone] {
+        if (options.sharedBus <= 0) {
+            return;
+        }
+        auto createPreview = [&tone] {
+            JuceMixPlayer* preview = JuceMixPlayer::acquire();
+            preview->setBusGain(0);
+            nlohmann::json j;
+            j["tracks"] = nlohmann::json::array({{{"id_", "tone"}, {"path", tone.getFullPathName().toStdString()}}});
+            preview->setJson(j.dump().c_str());
+            preview->play();
+            return preview;
+        };
+        std::vector<JuceMixPlayer*> players;
+        for (int i=0; i<options.sharedBus; i++) {
+            players.push_back(createPreview());
+        }
+        for (size_t i=0; !scriptDone; i++) {
+            const double until = stats.getDeviceTime() + 1;
+            while (!scriptDone && stats.getDeviceTime() < until) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            JuceMixPlayer*& replaced = players[i % players.size()];
+            const double start = juce::Time::getMillisecondCounterHiRes();
+            replaced->release();
+            replaced = createPreview();
+            stats.previewReplaceTimes.push_back(juce::Time::getMillisecondCounterHiRes() - start);
+        }
+    });
+    std::thread levelPoller([player, &scriptDone] {
+        std::vector<float> frames(256 * LevelStream::floatsPerFrame);
+        // read in place like a UI at display rate
+        const TransportState& transport = player->getTransport();
+        juce::uint32 sequence = transport.sequence;
+        while (!scriptDone) {
+            int count;
+            while ((count = player->readLevels(frames.data(), 256)) > 0) {
+                stats.levelFrames += count;
+            }
+            if (transport.sequence != sequence) {
+                sequence = transport.sequence;
+                stats.transportFrames++;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        }
+    });
+
+    juce::MessageManager::getInstance()->runDispatchLoop();
+    script.join();
+    scriptDone = true;
+    levelPoller.join();
+    previews.join();
+    deviceManager.closeAudioDevice();
+
+    nlohmann::json report;
+    report["config"] = {
+        {"sampleRate", options.sampleRate},
+        {"bufferSize", options.bufferSize},
+        {"speed", options.speed},
+        {"duration", options.duration},
+        {"decodeLatency", options.decodeLatency},
+        {"decodeLatencyPerSecond", options.decodeLatencyPerSecond},
+        {"recorder", options.recorder},
+        {"sharedBus", options.sharedBus},
+        {"playerPool", options.playerPool},
+        {"seed", options.seed},
+    };
+    {
+        std::lock_guard<std::mutex> guard(stats.mutex);
+        report["deviceTime"] = stats.deviceTime;
+        report["callbacks"] = stats.callbacks;
+        report["callbackBudget"] = stats.callbackBudget;
+        report["maxCallbackTime"] = stats.maxCallbackTime;
+        report["lateCallbacks"] = stats.lateCallbacks;
+        report["silentBuffers"] = stats.silentBuffers;
+        report["underruns"] = stats.underruns;
+        nlohmann::json timeToAudible;
+        for (auto& [action, values]: stats.timeToAudible) {
+            timeToAudible[action] = summarise(values);
+        }
+        report["timeToAudible"] = timeToAudible;
+        report["unresolved"] = stats.unresolved;
+        report["actions"] = stats.actions;
+    }
+    report["errors"] = stats.errors.load();
+    report["levelFrames"] = stats.levelFrames.load();
+    report["transportFrames"] = stats.transportFrames.load();
+    report["previewReplaceTime"] = summarise(stats.previewReplaceTimes);
+    // what was in memory when the script ended
+    const char* bufferedRanges = player->getBufferedRanges();
+    report["bufferedRanges"] = nlohmann::json::parse(bufferedRanges);
+    freeCopyChar(bufferedRanges);
+
+    std::cout << report.dump(4) << std::endl;
+
+    // skips the static device manager teardown while the player still references it
+    std::_Exit(0);
+}
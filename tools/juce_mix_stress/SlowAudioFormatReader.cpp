@@ -0,0 +1,26 @@
+#include "SlowAudioFormatReader.h"
+
+SlowAudioFormatReader::SlowAudioFormatReader(juce::AudioFormatReader* source, double fixedLatencyMs, double latencyPerSecondMs)
+: juce::AudioFormatReader(nullptr, source->getFormatName()),
+  source(source),
+  fixedLatencyMs(fixedLatencyMs),
+  latencyPerSecondMs(latencyPerSecondMs) {
+    sampleRate = source->sampleRate;
+    bitsPerSample = source->bitsPerSample;
+    lengthInSamples = source->lengthInSamples;
+    numChannels = source->numChannels;
+    usesFloatingPointData = source->usesFloatingPointData;
+    metadataValues = source->metadataValues;
+}
+
+bool SlowAudioFormatReader::readSamples(int* const* destChannels,
+                                        int numDestChannels,
+                                        int startOffsetInDestBuffer,
+                                        juce::int64 startSampleInFile,
+                                        int numSamples) {
+    const double delayMs = fixedLatencyMs + latencyPerSecondMs * numSamples / sampleRate;
+    if (delayMs > 0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delayMs));
+    }
+    return source->readSamples(destChannels, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/// Wraps a reader and sleeps before every read to simulate slow decoding.
+/// Delay per read is `fixedLatencyMs` plus `latencyPerSecondMs` per second of audio read.
+class SlowAudioFormatReader : public juce::AudioFormatReader {
+public:
+
+    SlowAudioFormatReader(juce::AudioFormatReader* source, double fixedLatencyMs, double latencyPerSecondMs);
+
+    bool readSamples(int* const* destChannels,
+                     int numDestChannels,
+                     int startOffsetInDestBuffer,
+                     juce::int64 startSampleInFile,
+                     int numSamples) override;
+
+private:
+
+    std::unique_ptr<juce::AudioFormatReader> source;
+    double fixedLatencyMs;
+    double latencyPerSecondMs;
+};
@@ -0,0 +1,211 @@
+#include "VirtualAudioIODevice.h"
+
+VirtualAudioIODevice::VirtualAudioIODevice(const Config& config)
+: juce::AudioIODevice(VirtualAudioIODeviceType::deviceName, VirtualAudioIODeviceType::typeName),
+  config(config),
+  currentSampleRate(config.sampleRate),
+  currentBufferSize(config.bufferSize) {
+}
+
+VirtualAudioIODevice::~VirtualAudioIODevice() {
+    close();
+}
+
+juce::StringArray VirtualAudioIODevice::getOutputChannelNames() {
+    juce::StringArray names;
+    for (int i=0; i<config.numOutputChannels; i++) {
+        names.add("Output " + juce::String(i + 1));
+    }
+    return names;
+}
+
+juce::StringArray VirtualAudioIODevice::getInputChannelNames() {
+    juce::StringArray names;
+    for (int i=0; i<config.numInputChannels; i++) {
+        names.add("Input " + juce::String(i + 1));
+    }
+    return names;
+}
+
+juce::Array<double> VirtualAudioIODevice::getAvailableSampleRates() {
+    juce::Array<double> rates { 16000.0, 44100.0, 48000.0, 96000.0 };
+    if (!rates.contains(config.sampleRate)) {
+        rates.add(config.sampleRate);
+    }
+    return rates;
+}
+
+juce::Array<int> VirtualAudioIODevice::getAvailableBufferSizes() {
+    return { config.bufferSize };
+}
+
+int VirtualAudioIODevice::getDefaultBufferSize() {
+    return config.bufferSize;
+}
+
+juce::String VirtualAudioIODevice::open(const juce::BigInteger& inputChannels,
+                                        const juce::BigInteger& outputChannels,
+                                        double sampleRate,
+                                        int bufferSizeSamples) {
+    close();
+    activeInputs = inputChannels;
+    activeInputs.setRange(config.numInputChannels, activeInputs.getHighestBit() + 1, false);
+    activeOutputs = outputChannels;
+    activeOutputs.setRange(config.numOutputChannels, activeOutputs.getHighestBit() + 1, false);
+    currentSampleRate = sampleRate > 0 ? sampleRate : config.sampleRate;
+    // buffer size is what the stress run is about, requests are ignored
+    currentBufferSize = config.bufferSize;
+    opened = true;
+    return {};
+}
+
+void VirtualAudioIODevice::close() {
+    stop();
+    opened = false;
+}
+
+bool VirtualAudioIODevice::isOpen() {
+    return opened;
+}
+
+void VirtualAudioIODevice::start(juce::AudioIODeviceCallback* newCallback) {
+    if (!opened || newCallback == nullptr || running) {
+        return;
+    }
+    newCallback->audioDeviceAboutToStart(this);
+    {
+        std::lock_guard<std::mutex> guard(callbackLock);
+        callback = newCallback;
+    }
+    running = true;
+    thread = std::thread([this] { run(); });
+}
+
+void VirtualAudioIODevice::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    juce::AudioIODeviceCallback* old = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(callbackLock);
+        old = callback;
+        callback = nullptr;
+    }
+    if (old != nullptr) {
+        old->audioDeviceStopped();
+    }
+}
+
+bool VirtualAudioIODevice::isPlaying() {
+    return running;
+}
+
+juce::String VirtualAudioIODevice::getLastError() {
+    return {};
+}
+
+int VirtualAudioIODevice::getCurrentBufferSizeSamples() {
+    return currentBufferSize;
+}
+
+double VirtualAudioIODevice::getCurrentSampleRate() {
+    return currentSampleRate;
+}
+
+int VirtualAudioIODevice::getCurrentBitDepth() {
+    return 32;
+}
+
+juce::BigInteger VirtualAudioIODevice::getActiveOutputChannels() const {
+    return activeOutputs;
+}
+
+juce::BigInteger VirtualAudioIODevice::getActiveInputChannels() const {
+    return activeInputs;
+}
+
+int VirtualAudioIODevice::getOutputLatencyInSamples() {
+    return currentBufferSize;
+}
+
+int VirtualAudioIODevice::getInputLatencyInSamples() {
+    return currentBufferSize;
+}
+
+void VirtualAudioIODevice::run() {
+    const int numInputs = activeInputs.countNumberOfSetBits();
+    const int numOutputs = activeOutputs.countNumberOfSetBits();
+    juce::AudioBuffer<float> input(std::max(1, numInputs), currentBufferSize);
+    juce::AudioBuffer<float> output(std::max(1, numOutputs), currentBufferSize);
+    juce::AudioIODeviceCallbackContext context;
+
+    const auto period = std::chrono::duration<double>(currentBufferSize / currentSampleRate / std::max(config.speed, 1e-9));
+    auto deadline = std::chrono::steady_clock::now();
+
+    while (running) {
+        // -12 dB 440 Hz tone on every input
+        const double delta = juce::MathConstants<double>::twoPi * 440.0 / currentSampleRate;
+        for (int i=0; i<currentBufferSize; i++) {
+            const float sample = 0.25f * (float)std::sin(phase);
+            for (int ch=0; ch<numInputs; ch++) {
+                input.setSample(ch, i, sample);
+            }
+            phase = std::fmod(phase + delta, juce::MathConstants<double>::twoPi);
+        }
+        output.clear();
+
+        const auto start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> guard(callbackLock);
+            if (callback != nullptr) {
+                callback->audioDeviceIOCallbackWithContext(input.getArrayOfReadPointers(),
+                                                           numInputs,
+                                                           output.getArrayOfWritePointers(),
+                                                           numOutputs,
+                                                           currentBufferSize,
+                                                           context);
+            }
+        }
+        const double callbackTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (config.onBufferProcessed) {
+            config.onBufferProcessed(output.getArrayOfReadPointers(), numOutputs, currentBufferSize, currentSampleRate, callbackTimeMs);
+        }
+
+        if (config.speed > 0) {
+            deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+}
+
+// MARK: VirtualAudioIODeviceType
+
+VirtualAudioIODeviceType::VirtualAudioIODeviceType(const VirtualAudioIODevice::Config& config)
+: juce::AudioIODeviceType(typeName), config(config) {
+}
+
+void VirtualAudioIODeviceType::scanForDevices() {
+}
+
+juce::StringArray VirtualAudioIODeviceType::getDeviceNames(bool wantInputNames) const {
+    return juce::StringArray(deviceName);
+}
+
+int VirtualAudioIODeviceType::getDefaultDeviceIndex(bool forInput) const {
+    return 0;
+}
+
+int VirtualAudioIODeviceType::getIndexOfDevice(juce::AudioIODevice* device, bool asInput) const {
+    return device != nullptr ? 0 : -1;
+}
+
+bool VirtualAudioIODeviceType::hasSeparateInputsAndOutputs() const {
+    return false;
+}
+
+juce::AudioIODevice* VirtualAudioIODeviceType::createDevice(const juce::String& outputDeviceName,
+                                                            const juce::String& inputDeviceName) {
+    return new VirtualAudioIODevice(config);
+}
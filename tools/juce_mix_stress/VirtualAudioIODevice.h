@@ -0,0 +1,113 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/// Audio device without hardware. A worker thread drives the callback with a fixed buffer size,
+/// paced at `speed` times real time (0 runs as fast as possible). Inputs receive a sine tone.
+class VirtualAudioIODevice : public juce::AudioIODevice {
+public:
+
+    struct Config {
+        double sampleRate = 48000;
+        int bufferSize = 256;
+        double speed = 1.0;
+        int numInputChannels = 1;
+        int numOutputChannels = 2;
+
+        // called on the device thread after every callback with the produced output
+        std::function<void(const float* const* output,
+                           int numOutputChannels,
+                           int numSamples,
+                           double sampleRate,
+                           double callbackTimeMs)> onBufferProcessed;
+    };
+
+    VirtualAudioIODevice(const Config& config);
+
+    ~VirtualAudioIODevice() override;
+
+    juce::StringArray getOutputChannelNames() override;
+
+    juce::StringArray getInputChannelNames() override;
+
+    juce::Array<double> getAvailableSampleRates() override;
+
+    juce::Array<int> getAvailableBufferSizes() override;
+
+    int getDefaultBufferSize() override;
+
+    juce::String open(const juce::BigInteger& inputChannels,
+                      const juce::BigInteger& outputChannels,
+                      double sampleRate,
+                      int bufferSizeSamples) override;
+
+    void close() override;
+
+    bool isOpen() override;
+
+    void start(juce::AudioIODeviceCallback* callback) override;
+
+    void stop() override;
+
+    bool isPlaying() override;
+
+    juce::String getLastError() override;
+
+    int getCurrentBufferSizeSamples() override;
+
+    double getCurrentSampleRate() override;
+
+    int getCurrentBitDepth() override;
+
+    juce::BigInteger getActiveOutputChannels() const override;
+
+    juce::BigInteger getActiveInputChannels() const override;
+
+    int getOutputLatencyInSamples() override;
+
+    int getInputLatencyInSamples() override;
+
+private:
+
+    Config config;
+    double currentSampleRate;
+    int currentBufferSize;
+    juce::BigInteger activeInputs;
+    juce::BigInteger activeOutputs;
+    bool opened = false;
+
+    std::mutex callbackLock;
+    juce::AudioIODeviceCallback* callback = nullptr;
+    std::atomic<bool> running { false };
+    std::thread thread;
+    double phase = 0;
+
+    void run();
+};
+
+/// Device type that only offers `VirtualAudioIODevice`s, register it on a `juce::AudioDeviceManager`.
+class VirtualAudioIODeviceType : public juce::AudioIODeviceType {
+public:
+
+    VirtualAudioIODeviceType(const VirtualAudioIODevice::Config& config);
+
+    void scanForDevices() override;
+
+    juce::StringArray getDeviceNames(bool wantInputNames) const override;
+
+    int getDefaultDeviceIndex(bool forInput) const override;
+
+    int getIndexOfDevice(juce::AudioIODevice* device, bool asInput) const override;
+
+    bool hasSeparateInputsAndOutputs() const override;
+
+    juce::AudioIODevice* createDevice(const juce::String& outputDeviceName,
+                                      const juce::String& inputDeviceName) override;
+
+    static inline const juce::String typeName = "Virtual";
+    static inline const juce::String deviceName = "Virtual Device";
+
+private:
+
+    VirtualAudioIODevice::Config config;
+};
@@ -0,0 +1,117 @@
+#include "JuceMixPlayer.h"
+
+class BlockCodecTests : public juce::UnitTest {
+public:
+    BlockCodecTests(): juce::UnitTest("BlockCodec", "juce_mix_player") {}
+
+    void runTest() override {
+        juce::Random random(7);
+
+        beginTest("noise round-trips");
+        {
+            std::vector<juce::int16> samples(2 * 4800);
+            for (juce::int16& sample: samples) {
+                sample = (juce::int16)(random.nextInt(65536) - 32768);
+            }
+            expectRoundTrip(samples, 2, 4800);
+        }
+
+        beginTest("correlated stereo round-trips and shrinks");
+        {
+            const int numSamples = 4800;
+            std::vector<juce::int16> samples(2 * numSamples);
+            for (int i=0; i<numSamples; i++) {
+                const double tone = 12000 * std::sin(i * 0.05) + 3000 * std::sin(i * 0.31);
+                samples[(size_t)i] = (juce::int16)tone;
+                samples[(size_t)(numSamples + i)] = (juce::int16)(tone * 0.9 + random.nextInt(9) - 4);
+            }
+            const std::vector<juce::uint8> data = expectRoundTrip(samples, 2, numSamples);
+            expect(data.size() < samples.size() * sizeof(juce::int16) / 2, "predictable audio takes less than half");
+        }
+
+        beginTest("full scale steps round-trip");
+        {
+            std::vector<juce::int16> samples(2 * 1000);
+            for (size_t i=0; i<samples.size(); i++) {
+                samples[i] = i % 2 == 0 ? (juce::int16)32767 : (juce::int16)-32768;
+            }
+            expectRoundTrip(samples, 2, 1000);
+        }
+
+        beginTest("mono and odd lengths round-trip");
+        for (int numSamples: { 1, 2, 3, 4, 5, 63, 65, 1001 }) {
+            std::vector<juce::int16> samples((size_t)numSamples);
+            for (juce::int16& sample: samples) {
+                sample = (juce::int16)(random.nextInt(2000) - 1000);
+            }
+            expectRoundTrip(samples, 1, numSamples);
+        }
+
+        beginTest("silence is next to nothing");
+        {
+            std::vector<juce::int16> samples(2 * 48000, 0);
+            const std::vector<juce::uint8> data = expectRoundTrip(samples, 2, 48000);
+            expect(data.size() < 1024, "silence block of " + juce::String((int)data.size()) + " bytes");
+        }
+
+        beginTest("a 16 bit play buffer page is restored exactly");
+        {
+            const int pageSize = 480;
+            PlayBuffer buffer;
+            buffer.setSampleFormat(PlayBuffer::SampleFormat::INT16);
+            buffer.setSize(2, 2 * pageSize, pageSize);
+            juce::AudioBuffer<float> source(2, pageSize);
+            for (int ch=0; ch<2; ch++) {
+                for (int i=0; i<pageSize; i++) {
+                    source.setSample(ch, i, (float)std::sin(i * 0.07 + ch));
+                }
+            }
+            buffer.write(0, source, 0, pageSize);
+            std::vector<juce::int16> samples(2 * pageSize);
+            buffer.getPageAudio(0)->read(samples.data());
+            const std::vector<juce::uint8> data = BlockCodec::encode(samples.data(), 2, pageSize);
+            std::vector<juce::int16> decoded(samples.size());
+            expect(BlockCodec::decode(data, decoded.data(), 2, pageSize), "decodes");
+            buffer.writePage(1, decoded.data());
+
+            juce::AudioBuffer<float> original(2, pageSize);
+            juce::AudioBuffer<float> restored(2, pageSize);
+            buffer.read(0, original, 0, pageSize);
+            buffer.read(pageSize, restored, 0, pageSize);
+            bool same = true;
+            for (int ch=0; ch<2; ch++) {
+                for (int i=0; i<pageSize; i++) {
+                    same = same && original.getSample(ch, i) == restored.getSample(ch, i);
+                }
+            }
+            expect(same, "plays as before it was evicted");
+        }
+
+        beginTest("decode rejects other sizes and damaged blocks");
+        {
+            std::vector<juce::int16> samples(2 * 480);
+            for (juce::int16& sample: samples) {
+                sample = (juce::int16)(random.nextInt(20000) - 10000);
+            }
+            const std::vector<juce::uint8> data = BlockCodec::encode(samples.data(), 2, 480);
+            std::vector<juce::int16> decoded(2 * 481);
+            expect(!BlockCodec::decode(data, decoded.data(), 2, 481), "other length");
+            expect(!BlockCodec::decode(data, decoded.data(), 1, 480), "other channel count");
+            expect(!BlockCodec::decode({}, decoded.data(), 2, 480), "empty");
+            const std::vector<juce::uint8> truncated(data.begin(), data.begin() + (std::ptrdiff_t)(data.size() / 2));
+            expect(!BlockCodec::decode(truncated, decoded.data(), 2, 480), "truncated");
+        }
+    }
+
+private:
+
+    std::vector<juce::uint8> expectRoundTrip(const std::vector<juce::int16>& samples, int numChannels, int numSamples) {
+        const std::vector<juce::uint8> data = BlockCodec::encode(samples.data(), numChannels, numSamples);
+        std::vector<juce::int16> decoded(samples.size(), 1);
+        expect(BlockCodec::decode(data, decoded.data(), numChannels, numSamples), "decodes");
+        expect(decoded == samples, juce::String(numChannels) + " x " + juce::String(numSamples) + " samples are lossless");
+        return data;
+    }
+};
+
+static BlockCodecTests blockCodecTests;
@@ -0,0 +1,146 @@
+#include "JuceMixPlayer.h"
+
+class EventChannelTests : public juce::UnitTest {
+public:
+    EventChannelTests(): juce::UnitTest("EventChannel", "juce_mix_player") {}
+
+    void runTest() override {
+        using Type = EventChannel::Type;
+
+        beginTest("events and messages are delivered in posting order");
+        {
+            EventChannel channel;
+            std::vector<std::string> delivered;
+            channel.onEvent = [&](const EventChannel::Event& event) {
+                delivered.push_back(describe(event));
+            };
+            channel.post({ Type::RECORD_BUFFER, 480, 1 });
+            channel.postMessage(Type::WAVEFORM_READY, "a.wav");
+            channel.post({ Type::PREFETCH, 0, 0 });
+            channel.postMessage(Type::LOUDNESS_READY, "b.wav");
+            channel.post({ Type::ENDED, 3, 0 });
+            channel.flush();
+            expect(delivered == std::vector<std::string> { "record 1 480", "waveform a.wav", "prefetch", "loudness b.wav", "ended 3" },
+                   joined(delivered));
+
+            delivered.clear();
+            channel.flush();
+            expect(delivered.empty(), "delivered once");
+        }
+
+        beginTest("an event posted again replaces the undelivered one and moves to the end");
+        {
+            EventChannel channel;
+            std::vector<std::string> delivered;
+            channel.onEvent = [&](const EventChannel::Event& event) {
+                delivered.push_back(describe(event));
+            };
+            channel.post({ Type::RECORD_BUFFER, 100, 0 });
+            channel.post({ Type::RECORD_BUFFER, 200, 1 });
+            channel.post({ Type::RECORD_BUFFER, 300, 0 });
+            channel.postMessage(Type::WAVEFORM_READY, "a.wav");
+            channel.postMessage(Type::WAVEFORM_READY, "a.wav");
+            channel.flush();
+            expect(delivered == std::vector<std::string> { "record 1 200", "record 0 300", "waveform a.wav", "waveform a.wav" },
+                   joined(delivered));
+        }
+
+        beginTest("values are delivered once with the latest amount");
+        {
+            EventChannel channel;
+            std::vector<std::pair<EventChannel::Value, float>> delivered;
+            channel.onValue = [&](EventChannel::Value value, float amount) {
+                delivered.emplace_back(value, amount);
+            };
+            channel.setLatest(EventChannel::Value::PROGRESS, 0.1f);
+            channel.setLatest(EventChannel::Value::REC_LEVEL, 0.5f);
+            channel.setLatest(EventChannel::Value::PROGRESS, 0.2f);
+            channel.flush();
+            expectEquals((int)delivered.size(), 2);
+            expect(delivered.size() == 2 && delivered[0].first == EventChannel::Value::PROGRESS && delivered[0].second == 0.2f);
+            expect(delivered.size() == 2 && delivered[1].first == EventChannel::Value::REC_LEVEL && delivered[1].second == 0.5f);
+            delivered.clear();
+            channel.flush();
+            expect(delivered.empty(), "delivered once");
+        }
+
+        beginTest("discard drops what is pending");
+        {
+            EventChannel channel;
+            int delivered = 0;
+            channel.onEvent = [&](const EventChannel::Event&) { delivered++; };
+            channel.onValue = [&](EventChannel::Value, float) { delivered++; };
+            channel.post({ Type::ENDED, 1, 0 });
+            channel.postMessage(Type::WAVEFORM_READY, "a.wav");
+            channel.setLatest(EventChannel::Value::PROGRESS, 1);
+            channel.discard();
+            channel.flush();
+            expectEquals(delivered, 0);
+        }
+
+        beginTest("the dispatcher delivers an open channel in order");
+        {
+            EventChannel channel;
+            std::mutex mutex;
+            std::vector<std::string> delivered;
+            juce::WaitableEvent done;
+            channel.onEvent = [&](const EventChannel::Event& event) {
+                const std::lock_guard<std::mutex> guard(mutex);
+                delivered.push_back(describe(event));
+                if (event.type == Type::ENDED) {
+                    done.signal();
+                }
+            };
+            channel.open();
+            channel.postMessage(Type::WAVEFORM_READY, "a.wav");
+            channel.post({ Type::RECORD_BUFFER, 10, 0 });
+            channel.post({ Type::ENDED, 2, 0 });
+            expect(done.wait(2000), "delivered without a flush");
+            channel.close();
+            const std::lock_guard<std::mutex> guard(mutex);
+            expect(delivered == std::vector<std::string> { "waveform a.wav", "record 0 10", "ended 2" }, joined(delivered));
+        }
+
+        beginTest("a handler can close its channel, nothing is delivered after close");
+        {
+            auto channel = std::make_unique<EventChannel>();
+            std::atomic<int> delivered { 0 };
+            juce::WaitableEvent closed;
+            channel->onEvent = [&](const EventChannel::Event&) {
+                delivered++;
+                channel->close();
+                closed.signal();
+            };
+            channel->open();
+            channel->post({ Type::PREFETCH, 0, 0 });
+            expect(closed.wait(2000), "delivered and closed from the handler");
+            channel->post({ Type::PREFETCH, 0, 0 });
+            juce::Thread::sleep(300);
+            expectEquals(delivered.load(), 1);
+            channel.reset();
+        }
+    }
+
+private:
+
+    static std::string describe(const EventChannel::Event& event) {
+        switch (event.type) {
+            case EventChannel::Type::ENDED: return "ended " + std::to_string(event.value);
+            case EventChannel::Type::RECORD_BUFFER: return "record " + std::to_string(event.index) + " " + std::to_string(event.value);
+            case EventChannel::Type::PREFETCH: return "prefetch";
+            case EventChannel::Type::WAVEFORM_READY: return "waveform " + event.text;
+            case EventChannel::Type::LOUDNESS_READY: return "loudness " + event.text;
+        }
+        return "unknown";
+    }
+
+    static juce::String joined(const std::vector<std::string>& delivered) {
+        std::string text;
+        for (const std::string& event: delivered) {
+            text += (text.empty() ? "" : ", ") + event;
+        }
+        return text;
+    }
+};
+
+static EventChannelTests eventChannelTests;
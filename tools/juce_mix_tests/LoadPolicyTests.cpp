@@ -0,0 +1,76 @@
+#include "JuceMixPlayer.h"
+
+class LoadPolicyTests : public juce::UnitTest {
+public:
+    LoadPolicyTests(): juce::UnitTest("LoadPolicy", "juce_mix_player") {}
+
+    void runTest() override {
+        const float pageDuration = 0.5f;
+        const float maxBlockDuration = 4;
+
+        beginTest("unmeasured it loads single pages and two blocks ahead");
+        {
+            LoadPolicy policy(pageDuration, maxBlockDuration);
+            expectEquals(policy.getRenderSpeed(), 0.0f);
+            expectEquals(policy.getBlockDuration(0), pageDuration);
+            expectEquals(policy.getBlockDuration(30), pageDuration);
+            expectEquals(policy.getLookAhead(30), maxBlockDuration * 2);
+            expectEquals(policy.getLookAhead(5), 5.0f);
+        }
+
+        beginTest("measurements are smoothed");
+        {
+            LoadPolicy policy(pageDuration, maxBlockDuration);
+            policy.addMeasurement(10, 1000);
+            expectWithinAbsoluteError(policy.getRenderSpeed(), 10.0f, 0.001f);
+            policy.addMeasurement(20, 1000);
+            expectWithinAbsoluteError(policy.getRenderSpeed(), 13.0f, 0.001f);
+            // nothing mixed is no measurement
+            policy.addMeasurement(0, 1000);
+            expectWithinAbsoluteError(policy.getRenderSpeed(), 13.0f, 0.001f);
+        }
+
+        beginTest("sub millisecond jobs count as one millisecond");
+        {
+            LoadPolicy policy(pageDuration, maxBlockDuration);
+            policy.addMeasurement(0.5f, 0);
+            expectWithinAbsoluteError(policy.getRenderSpeed(), 500.0f, 0.01f);
+        }
+
+        beginTest("blocks are whole pages growing with the buffer up to the largest");
+        {
+            LoadPolicy policy(pageDuration, maxBlockDuration);
+            policy.addMeasurement(4, 1000);
+            float previous = 0;
+            for (float bufferedAhead = 0; bufferedAhead < 10; bufferedAhead += 0.25f) {
+                const float block = policy.getBlockDuration(bufferedAhead);
+                expect(block >= previous, "grows with the buffer");
+                expect(block >= pageDuration && block <= maxBlockDuration, "within one page and the largest block");
+                expectWithinAbsoluteError(std::fmod(block, pageDuration), 0.0f, 0.0001f, "whole pages");
+                previous = block;
+            }
+            // half of what playback consumes meanwhile, speed 4 x 1 s x 0.5 = 2 s
+            expectEquals(policy.getBlockDuration(1), 2.0f);
+            expectEquals(policy.getBlockDuration(100), maxBlockDuration);
+        }
+
+        beginTest("look-ahead follows the render speed");
+        {
+            LoadPolicy slow(pageDuration, maxBlockDuration);
+            slow.addMeasurement(0.5f, 1000);
+            expectEquals(slow.getLookAhead(60), 60.0f);
+
+            LoadPolicy fast(pageDuration, maxBlockDuration);
+            fast.addMeasurement(100, 1000);
+            // a 1 s stall plus refilling it at 100x
+            expectWithinAbsoluteError(fast.getLookAhead(60), maxBlockDuration + 100.0f / 99, 0.001f);
+
+            LoadPolicy nearRealTime(pageDuration, maxBlockDuration);
+            nearRealTime.addMeasurement(1.01f, 1000);
+            expectEquals(nearRealTime.getLookAhead(60), 60.0f);
+            expect(fast.getLookAhead(60) < nearRealTime.getLookAhead(60), "faster renders keep less ahead");
+        }
+    }
+};
+
+static LoadPolicyTests loadPolicyTests;
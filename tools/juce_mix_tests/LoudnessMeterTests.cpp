@@ -0,0 +1,106 @@
+#include "JuceMixPlayer.h"
+
+class LoudnessMeterTests : public juce::UnitTest {
+public:
+    LoudnessMeterTests(): juce::UnitTest("LoudnessMeter", "juce_mix_player") {}
+
+    void runTest() override {
+        beginTest("a stereo 1 kHz sine at -23 dBFS is -23 LUFS (EBU Tech 3341 case 1)");
+        for (double sampleRate: { 44100.0, 48000.0 }) {
+            juce::AudioBuffer<float> buffer = makeSine(sampleRate, 1000, -23, 20);
+            const MixerLoudness loudness = measure(buffer, sampleRate, 2);
+            expectWithinAbsoluteError(loudness.integrated, -23.0f, 0.1f, juce::String(sampleRate) + " Hz");
+            expectWithinAbsoluteError(loudness.maxMomentary, -23.0f, 0.1f);
+            expectWithinAbsoluteError(loudness.maxShortTerm, -23.0f, 0.1f);
+            expectWithinAbsoluteError(loudness.loudnessRange, 0.0f, 0.1f);
+        }
+
+        beginTest("quiet parts are gated (EBU Tech 3341 case 5)");
+        {
+            const double sampleRate = 48000;
+            juce::AudioBuffer<float> buffer(2, (int)(80 * sampleRate));
+            copy(makeSine(sampleRate, 1000, -36, 10), buffer, 0);
+            copy(makeSine(sampleRate, 1000, -23, 60), buffer, (int)(10 * sampleRate));
+            copy(makeSine(sampleRate, 1000, -36, 10), buffer, (int)(70 * sampleRate));
+            const MixerLoudness loudness = measure(buffer, sampleRate, 2);
+            expectWithinAbsoluteError(loudness.integrated, -23.0f, 0.1f);
+            expect(loudness.loudnessRange > 10, "range of " + juce::String(loudness.loudnessRange) + " LU");
+        }
+
+        beginTest("silence is floored");
+        {
+            juce::AudioBuffer<float> buffer(2, 48000 * 5);
+            buffer.clear();
+            const MixerLoudness loudness = measure(buffer, 48000, 2);
+            expectEquals(loudness.integrated, -70.0f);
+            expectEquals(loudness.truePeak, -70.0f);
+        }
+
+        beginTest("true peak finds the peak between the samples");
+        {
+            // a quarter of the rate a quarter period late, every sample is at -3 dB of the full scale peak
+            const double sampleRate = 48000;
+            juce::AudioBuffer<float> buffer(1, (int)sampleRate);
+            for (int i=0; i<buffer.getNumSamples(); i++) {
+                buffer.setSample(0, i, (float)std::sin(juce::MathConstants<double>::halfPi * i + juce::MathConstants<double>::pi / 4));
+            }
+            expectWithinAbsoluteError(buffer.getMagnitude(0, 0, buffer.getNumSamples()), 0.7071f, 0.001f);
+            const MixerLoudness loudness = measure(buffer, sampleRate, 1);
+            expectWithinAbsoluteError(loudness.truePeak, 0.0f, 0.5f);
+        }
+
+        beginTest("audio measured in pieces gives the same segments");
+        {
+            const double sampleRate = 48000;
+            juce::AudioBuffer<float> buffer = makeSine(sampleRate, 440, -12, 3);
+            LoudnessMeter whole(sampleRate, 2);
+            whole.process(buffer, 0, buffer.getNumSamples());
+            whole.flush();
+            LoudnessMeter pieces(sampleRate, 2);
+            for (int start=0; start<buffer.getNumSamples(); start+=777) {
+                pieces.process(buffer, start, std::min(777, buffer.getNumSamples() - start));
+            }
+            pieces.flush();
+            expectEquals((int)pieces.getSegments().size(), (int)whole.getSegments().size());
+            expectEquals((int)whole.getSegments().size(), buffer.getNumSamples() / whole.getSegmentSize());
+            bool same = pieces.getSegments().size() == whole.getSegments().size();
+            for (size_t i=0; same && i<whole.getSegments().size(); i++) {
+                same = pieces.getSegments()[i].energy == whole.getSegments()[i].energy
+                    && pieces.getSegments()[i].truePeak == whole.getSegments()[i].truePeak;
+            }
+            expect(same, "segments differ");
+
+            whole.reset();
+            expect(whole.getSegments().empty());
+        }
+    }
+
+private:
+
+    /// stereo, `level` dBFS peak
+    static juce::AudioBuffer<float> makeSine(double sampleRate, double frequency, float level, double seconds) {
+        juce::AudioBuffer<float> buffer(2, (int)(seconds * sampleRate));
+        const float gain = juce::Decibels::decibelsToGain(level);
+        for (int i=0; i<buffer.getNumSamples(); i++) {
+            const float sample = gain * (float)std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate);
+            buffer.setSample(0, i, sample);
+            buffer.setSample(1, i, sample);
+        }
+        return buffer;
+    }
+
+    static void copy(const juce::AudioBuffer<float>& source, juce::AudioBuffer<float>& dest, int destStart) {
+        for (int ch=0; ch<dest.getNumChannels(); ch++) {
+            dest.copyFrom(ch, destStart, source, ch, 0, source.getNumSamples());
+        }
+    }
+
+    static MixerLoudness measure(const juce::AudioBuffer<float>& buffer, double sampleRate, int numChannels) {
+        LoudnessMeter meter(sampleRate, numChannels);
+        meter.process(buffer, 0, buffer.getNumSamples());
+        meter.flush();
+        return LoudnessMeter::getLoudness(meter.getSegments());
+    }
+};
+
+static LoudnessMeterTests loudnessMeterTests;
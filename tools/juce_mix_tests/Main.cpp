@@ -0,0 +1,15 @@
+#include "JuceMixPlayer.h"
+
+// Runs the unit tests of the juce_mix_player module, `ctest` runs it. Exits with 1 when one failed.
+
+int main() {
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("juce_mix_player");
+
+    int failures = 0;
+    for (int i=0; i<runner.getNumResults(); i++) {
+        failures += runner.getResult(i)->failures;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+#include "JuceMixPlayer.h"
+
+class MixerModelTests : public juce::UnitTest {
+public:
+    MixerModelTests(): juce::UnitTest("MixerModel::apply", "juce_mix_player") {}
+
+    void runTest() override {
+        beginTest("updates by index and by id");
+        {
+            MixerData data = createData();
+            MixerModel::apply(data, {
+                { 0, MixerTrackParam::VOLUME, 0.25f },
+                { 0, MixerTrackParam::OFFSET, 2, "beats" },
+                { 0, MixerTrackParam::FROM_TIME, 1.5f, "beats" },
+                { 0, MixerTrackParam::DURATION, 3, "beats" },
+                { 0, MixerTrackParam::ENABLED, 0, "click" },
+                { 0, MixerTrackParam::REPEAT, 1, "click" },
+                { 0, MixerTrackParam::REPEAT_INTERVAL, 0.5f, "click" }
+            });
+            expectEquals(data.tracks[0].volume, 0.25f);
+            expectEquals(data.tracks[1].offset, 2.0f);
+            expectEquals(data.tracks[1].fromTime, 1.5f);
+            expectEquals(data.tracks[1].duration, 3.0f);
+            expect(!data.tracks[2].enabled);
+            expect(data.tracks[2].repeat);
+            expectEquals(data.tracks[2].repeatInterval, 0.5f);
+        }
+
+        beginTest("the id wins over the index");
+        {
+            MixerData data = createData();
+            MixerModel::apply(data, { { 0, MixerTrackParam::VOLUME, 0.5f, "click" } });
+            expectEquals(data.tracks[0].volume, 1.0f);
+            expectEquals(data.tracks[2].volume, 0.5f);
+        }
+
+        beginTest("later updates of a field win");
+        {
+            MixerData data = createData();
+            MixerModel::apply(data, {
+                { 1, MixerTrackParam::VOLUME, 0.1f },
+                { 0, MixerTrackParam::VOLUME, 0.7f, "beats" }
+            });
+            expectEquals(data.tracks[1].volume, 0.7f);
+        }
+
+        beginTest("invalid updates throw and change nothing");
+        expectRejected({ { 3, MixerTrackParam::VOLUME, 1 } }, "index past the end");
+        expectRejected({ { -1, MixerTrackParam::VOLUME, 1 } }, "negative index");
+        expectRejected({ { 0, MixerTrackParam::VOLUME, 1, "missing" } }, "unknown id");
+        expectRejected({ { 0, MixerTrackParam::VOLUME, std::numeric_limits<float>::quiet_NaN() } }, "NaN");
+        expectRejected({ { 0, MixerTrackParam::VOLUME, std::numeric_limits<float>::infinity() } }, "infinity");
+        expectRejected({ { 0, MixerTrackParam::OFFSET, -1 } }, "negative offset");
+        expectRejected({ { 0, MixerTrackParam::FROM_TIME, -1 } }, "negative fromTime");
+        expectRejected({ { 0, MixerTrackParam::DURATION, -1 } }, "negative duration");
+        expectRejected({ { 0, MixerTrackParam::REPEAT_INTERVAL, -1 } }, "negative repeatInterval");
+        expectRejected({ { 0, (MixerTrackParam)42, 1 } }, "unknown param");
+        // all or nothing, the valid updates before the invalid one are dropped too
+        expectRejected({
+            { 0, MixerTrackParam::VOLUME, 0.5f },
+            { 1, MixerTrackParam::OFFSET, 4 },
+            { 2, MixerTrackParam::OFFSET, -4 }
+        }, "batch with an invalid update");
+    }
+
+private:
+
+    static MixerData createData() {
+        return MixerModel::parse(R"({"tracks": [
+            {"id_": "tone", "path": "tone.wav"},
+            {"id_": "beats", "path": "beats.wav", "volume": 0.8},
+            {"id_": "click", "path": "click.wav", "offset": 1}
+        ]})");
+    }
+
+    void expectRejected(const std::vector<MixerTrackUpdate>& updates, const juce::String& what) {
+        MixerData data = createData();
+        const MixerData original = data;
+        bool thrown = false;
+        try {
+            MixerModel::apply(data, updates);
+        } catch (const std::exception&) {
+            thrown = true;
+        }
+        expect(thrown, what + " throws");
+        bool unchanged = true;
+        for (size_t i=0; i<data.tracks.size(); i++) {
+            const MixerTrack& a = data.tracks[i];
+            const MixerTrack& b = original.tracks[i];
+            unchanged = unchanged && a.volume == b.volume && a.offset == b.offset && a.fromTime == b.fromTime
+                && a.duration == b.duration && a.enabled == b.enabled && a.repeat == b.repeat && a.repeatInterval == b.repeatInterval;
+        }
+        expect(unchanged, what + " leaves the tracks as they were");
+    }
+};
+
+static MixerModelTests mixerModelTests;
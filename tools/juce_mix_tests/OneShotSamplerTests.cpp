@@ -0,0 +1,113 @@
+#include "JuceMixPlayer.h"
+
+class OneShotSamplerTests : public juce::UnitTest {
+public:
+    OneShotSamplerTests(): juce::UnitTest("OneShotSampler", "juce_mix_player") {}
+
+    void runTest() override {
+        beginTest("empty samples are not added");
+        {
+            OneShotSampler sampler;
+            sampler.add({ nullptr, 0, 10, 1 });
+            sampler.add({ std::make_shared<const juce::AudioBuffer<float>>(1, 0), 0, 10, 1 });
+            expect(sampler.isEmpty());
+            sampler.add({ makeSample(4), 0, 10, 1 });
+            expect(!sampler.isEmpty());
+        }
+
+        beginTest("hits repeat every interval from the offset, mono plays on both channels");
+        {
+            OneShotSampler sampler;
+            sampler.add({ makeSample(4), 5, 20, 0.5f });
+            const juce::AudioBuffer<float> output = render(sampler, 0, 100);
+            for (int hit: { 5, 25, 45, 65, 85 }) {
+                for (int i=0; i<4; i++) {
+                    expectEquals(output.getSample(0, hit + i), 0.5f * (i + 1), "hit at " + juce::String(hit));
+                    expectEquals(output.getSample(1, hit + i), 0.5f * (i + 1));
+                }
+            }
+            expectEquals(output.getSample(0, 4), 0.0f);
+            expectEquals(output.getSample(0, 9), 0.0f);
+        }
+
+        beginTest("no interval plays the sample once");
+        {
+            OneShotSampler sampler;
+            sampler.add({ makeSample(4), 10, 0, 1 });
+            const juce::AudioBuffer<float> output = render(sampler, 0, 100);
+            expectEquals(output.getSample(0, 10), 1.0f);
+            expectEquals(countNonZero(output), 4);
+        }
+
+        beginTest("any range renders the same as the whole timeline");
+        {
+            OneShotSampler sampler;
+            // hits longer than the interval overlap, fractional positions round per hit
+            sampler.add({ makeSample(30), 3.5, 17.3, 1 });
+            sampler.add({ makeSample(5), 0, 50, 0.25f });
+            const juce::AudioBuffer<float> whole = render(sampler, 0, 500);
+            for (int blockSize: { 1, 7, 64, 128 }) {
+                juce::AudioBuffer<float> pieces(2, 500);
+                pieces.clear();
+                for (int start=0; start<500; start+=blockSize) {
+                    sampler.render(pieces, start, start, std::min(blockSize, 500 - start));
+                }
+                bool same = true;
+                for (int i=0; i<500; i++) {
+                    same = same && whole.getSample(0, i) == pieces.getSample(0, i);
+                }
+                expect(same, "blocks of " + juce::String(blockSize));
+            }
+        }
+
+        beginTest("hits far into the timeline don't drift");
+        {
+            OneShotSampler sampler;
+            sampler.add({ makeSample(1), 0, 1000.3, 1 });
+            const juce::int64 hit = 100000;
+            const juce::int64 hitStart = std::llround(hit * 1000.3);
+            juce::AudioBuffer<float> output(2, 10);
+            output.clear();
+            sampler.render(output, 0, hitStart - 5, 10);
+            expectEquals(output.getSample(0, 5), 1.0f);
+            expectEquals(countNonZero(output), 1);
+        }
+
+        beginTest("the click is short and ends at zero");
+        {
+            const auto click = OneShotSampler::synthesizeClick(48000, 1000, 0.5f);
+            expectEquals(click->getNumChannels(), 1);
+            expectEquals(click->getNumSamples(), 1440);
+            expect(click->getMagnitude(0, 0, click->getNumSamples()) <= 0.5f);
+            expectWithinAbsoluteError(click->getSample(0, click->getNumSamples() - 1), 0.0f, 0.0001f);
+        }
+    }
+
+private:
+
+    /// mono, 1, 2, 3 ...
+    static std::shared_ptr<const juce::AudioBuffer<float>> makeSample(int numSamples) {
+        auto sample = std::make_shared<juce::AudioBuffer<float>>(1, numSamples);
+        for (int i=0; i<numSamples; i++) {
+            sample->setSample(0, i, (float)(i + 1));
+        }
+        return sample;
+    }
+
+    static juce::AudioBuffer<float> render(const OneShotSampler& sampler, juce::int64 timelineStart, int numSamples) {
+        juce::AudioBuffer<float> output(2, numSamples);
+        output.clear();
+        sampler.render(output, 0, timelineStart, numSamples);
+        return output;
+    }
+
+    static int countNonZero(const juce::AudioBuffer<float>& buffer) {
+        int count = 0;
+        for (int i=0; i<buffer.getNumSamples(); i++) {
+            count += buffer.getSample(0, i) != 0 ? 1 : 0;
+        }
+        return count;
+    }
+};
+
+static OneShotSamplerTests oneShotSamplerTests;
@@ -0,0 +1,203 @@
+#include "JuceMixPlayer.h"
+
+class PlayBufferTests : public juce::UnitTest {
+public:
+    PlayBufferTests(): juce::UnitTest("PlayBuffer", "juce_mix_player") {}
+
+    void runTest() override {
+        const int pageSize = 100;
+
+        beginTest("pages cover the timeline, the last one is shorter");
+        {
+            PlayBuffer buffer;
+            buffer.setSize(2, 250, pageSize);
+            expectEquals(buffer.getNumPages(), 3);
+            expectEquals(buffer.getPageForSample(199), 1);
+            expectEquals(buffer.getPageRange(2).getStart(), 200);
+            expectEquals(buffer.getPageRange(2).getEnd(), 250);
+            expect(buffer.getPageState(0) == PlayBuffer::PageState::EMPTY);
+            expectEquals(buffer.getNumAllocatedPages(), 0);
+        }
+
+        beginTest("written samples read back, missing pages read as silence");
+        {
+            PlayBuffer buffer;
+            buffer.setSize(2, 300, pageSize);
+            juce::AudioBuffer<float> source = makeRamp(2, 150);
+            buffer.write(50, source, 0, 150);
+            expectEquals(buffer.getNumAllocatedPages(), 2);
+            expectEquals(buffer.getNumAllocatedBytes(), (size_t)(2 * 2 * pageSize * sizeof(float)));
+
+            juce::AudioBuffer<float> dest(2, 150);
+            expect(buffer.read(50, dest, 0, 150));
+            expectEquals(dest.getSample(1, 149), source.getSample(1, 149));
+            // page 2 was never written
+            dest.clear();
+            expect(!buffer.read(150, dest, 0, 150));
+            expectEquals(dest.getSample(0, 0), source.getSample(0, 100));
+            expectEquals(dest.getSample(0, 100), 0.0f);
+        }
+
+        beginTest("INT16 pages clip beyond full scale");
+        {
+            PlayBuffer buffer;
+            buffer.setSampleFormat(PlayBuffer::SampleFormat::INT16);
+            buffer.setSize(1, pageSize, pageSize);
+            juce::AudioBuffer<float> source(1, pageSize);
+            source.clear();
+            source.setSample(0, 0, 1.5f);
+            source.setSample(0, 1, -2.0f);
+            source.setSample(0, 2, 0.5f);
+            buffer.write(0, source, 0, pageSize);
+            expectEquals(buffer.getNumAllocatedBytes(), (size_t)(pageSize * sizeof(juce::int16)));
+
+            juce::AudioBuffer<float> dest(1, pageSize);
+            buffer.read(0, dest, 0, pageSize);
+            expectEquals(dest.getSample(0, 0), 1.0f);
+            expectEquals(dest.getSample(0, 1), -1.0f);
+            expectWithinAbsoluteError(dest.getSample(0, 2), 0.5f, 1.0f / 32767);
+        }
+
+        beginTest("evicted rendered pages can be restored, evicted pages of other states are empty");
+        {
+            PlayBuffer buffer;
+            buffer.setSize(2, 300, pageSize);
+            juce::AudioBuffer<float> source = makeRamp(2, 300);
+            buffer.write(0, source, 0, 300);
+            buffer.setPageState(0, PlayBuffer::PageState::RENDERED);
+            buffer.setPageState(1, PlayBuffer::PageState::STALE);
+            buffer.setPageState(2, PlayBuffer::PageState::RENDERED);
+
+            PlayBuffer::ReleasedPages released;
+            buffer.evict(0, &released);
+            buffer.evict(1, &released);
+            expect(buffer.getPageState(0) == PlayBuffer::PageState::EVICTED);
+            expect(buffer.getPageState(1) == PlayBuffer::PageState::EMPTY);
+            expectEquals(buffer.getNumAllocatedPages(), 1);
+            // kept for the caller to free after its lock
+            expectEquals((int)released.size(), 2);
+            expect(buffer.getPageAudio(0) == nullptr);
+        }
+
+        beginTest("marking stale keeps the audio of rendered pages and drops evicted ones");
+        {
+            PlayBuffer buffer;
+            buffer.setSize(2, 300, pageSize);
+            juce::AudioBuffer<float> source = makeRamp(2, 300);
+            buffer.write(0, source, 0, 300);
+            for (int page=0; page<3; page++) {
+                buffer.setPageState(page, PlayBuffer::PageState::RENDERED);
+            }
+            buffer.setCompressedPage(2, std::make_shared<const std::vector<juce::uint8>>(10, 0));
+            buffer.evict(2);
+            const int generation = buffer.getGeneration();
+
+            buffer.markStale();
+            expect(buffer.getGeneration() != generation);
+            expect(buffer.getPageState(0) == PlayBuffer::PageState::STALE);
+            expect(buffer.getPageState(2) == PlayBuffer::PageState::EMPTY);
+            expect(buffer.getCompressedPage(2) == nullptr);
+            expectEquals(buffer.getNumCompressedBytes(), (size_t)0);
+            // stale pages still play
+            juce::AudioBuffer<float> dest(2, 100);
+            expect(buffer.read(0, dest, 0, 100));
+            expectEquals(dest.getSample(1, 50), source.getSample(1, 50));
+        }
+
+        beginTest("marking a range stale marks only the pages it intersects");
+        {
+            PlayBuffer buffer;
+            buffer.setSize(2, 500, pageSize);
+            juce::AudioBuffer<float> source = makeRamp(2, 500);
+            buffer.write(0, source, 0, 500);
+            for (int page=0; page<5; page++) {
+                buffer.setPageState(page, PlayBuffer::PageState::RENDERED);
+            }
+            buffer.setCompressedPage(0, std::make_shared<const std::vector<juce::uint8>>(10, 0));
+            buffer.setCompressedPage(2, std::make_shared<const std::vector<juce::uint8>>(10, 0));
+            const int generation = buffer.getGeneration();
+
+            buffer.markStale({ 150, 201 });
+            expect(buffer.getGeneration() != generation);
+            expect(buffer.getPageState(0) == PlayBuffer::PageState::RENDERED);
+            expect(buffer.getPageState(1) == PlayBuffer::PageState::STALE);
+            expect(buffer.getPageState(2) == PlayBuffer::PageState::STALE);
+            expect(buffer.getPageState(3) == PlayBuffer::PageState::RENDERED);
+            expect(buffer.getCompressedPage(0) != nullptr);
+            expect(buffer.getCompressedPage(2) == nullptr);
+            expectEquals(buffer.getNumCompressedBytes(), (size_t)10);
+            // past the end and empty ranges mark nothing
+            buffer.markStale({ 600, 700 });
+            buffer.markStale({ 50, 50 });
+            expect(buffer.getPageState(0) == PlayBuffer::PageState::RENDERED);
+            expect(buffer.getPageState(4) == PlayBuffer::PageState::RENDERED);
+        }
+
+        beginTest("page memory allocated elsewhere is attached only when it fits");
+        {
+            PlayBuffer buffer;
+            buffer.setSize(2, 200, pageSize);
+            auto audio = std::make_shared<PlayBuffer::PageAudio>(PlayBuffer::SampleFormat::FLOAT32, 2, pageSize);
+            expect(buffer.attachPageAudio(0, audio) == nullptr);
+            expect(buffer.isPageAllocated(0));
+            expectEquals(buffer.getNumAllocatedPages(), 1);
+            // the page has memory
+            auto other = std::make_shared<PlayBuffer::PageAudio>(PlayBuffer::SampleFormat::FLOAT32, 2, pageSize);
+            expect(buffer.attachPageAudio(0, other) == other);
+            // the format changed meanwhile
+            buffer.setSampleFormat(PlayBuffer::SampleFormat::INT16);
+            expect(buffer.attachPageAudio(1, other) == other);
+            expect(!buffer.isPageAllocated(1));
+        }
+
+        beginTest("pages read as 16 bit are written back by writePage");
+        {
+            PlayBuffer buffer;
+            buffer.setSize(2, 200, pageSize);
+            juce::AudioBuffer<float> source = makeRamp(2, pageSize);
+            buffer.write(0, source, 0, pageSize);
+            std::vector<juce::int16> samples((size_t)(2 * pageSize));
+            buffer.getPageAudio(0)->read(samples.data());
+            buffer.writePage(1, samples.data());
+
+            juce::AudioBuffer<float> dest(2, pageSize);
+            buffer.read(pageSize, dest, 0, pageSize);
+            for (int i=0; i<pageSize; i++) {
+                expectWithinAbsoluteError(dest.getSample(1, i), source.getSample(1, i), 1.0f / 32767);
+            }
+        }
+
+        beginTest("resizing and clearing release all pages");
+        {
+            PlayBuffer buffer;
+            buffer.setSize(2, 300, pageSize);
+            juce::AudioBuffer<float> source = makeRamp(2, 300);
+            buffer.write(0, source, 0, 300);
+            PlayBuffer::ReleasedPages released;
+            buffer.clear(&released);
+            expectEquals((int)released.size(), 3);
+            expectEquals(buffer.getNumAllocatedBytes(), (size_t)0);
+            buffer.write(0, source, 0, 300);
+            const int generation = buffer.getGeneration();
+            buffer.setSize(2, 400, pageSize, &released);
+            expectEquals((int)released.size(), 6);
+            expectEquals(buffer.getNumPages(), 4);
+            expect(buffer.getGeneration() != generation);
+        }
+    }
+
+private:
+
+    /// distinct samples within full scale
+    static juce::AudioBuffer<float> makeRamp(int numChannels, int numSamples) {
+        juce::AudioBuffer<float> buffer(numChannels, numSamples);
+        for (int ch=0; ch<numChannels; ch++) {
+            for (int i=0; i<numSamples; i++) {
+                buffer.setSample(ch, i, (float)((i + ch * 7) % 200) / 200.0f - 0.5f);
+            }
+        }
+        return buffer;
+    }
+};
+
+static PlayBufferTests playBufferTests;
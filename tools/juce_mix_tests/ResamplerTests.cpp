@@ -0,0 +1,156 @@
+#include "JuceMixPlayer.h"
+
+namespace {
+
+/// a sine of `frequency` Hz, float samples computed on read
+class SineReader : public juce::AudioFormatReader {
+public:
+    SineReader(double sampleRate, juce::int64 length, double frequency)
+    : juce::AudioFormatReader(nullptr, "Sine"), frequency(frequency) {
+        this->sampleRate = sampleRate;
+        lengthInSamples = length;
+        numChannels = 2;
+        bitsPerSample = 32;
+        usesFloatingPointData = true;
+    }
+
+    static float getSample(double time, double frequency) {
+        return (float)(0.5 * std::sin(juce::MathConstants<double>::twoPi * frequency * time));
+    }
+
+    bool readSamples(int* const* destChannels,
+                     int numDestChannels,
+                     int startOffsetInDestBuffer,
+                     juce::int64 startSampleInFile,
+                     int numSamples) override {
+        for (int ch=0; ch<numDestChannels; ch++) {
+            if (destChannels[ch] == nullptr) {
+                continue;
+            }
+            float* dest = reinterpret_cast<float*>(destChannels[ch]) + startOffsetInDestBuffer;
+            for (int i=0; i<numSamples; i++) {
+                const juce::int64 position = startSampleInFile + i;
+                dest[i] = position < 0 || position >= lengthInSamples ? 0 : getSample(position / sampleRate, frequency);
+            }
+        }
+        return true;
+    }
+
+private:
+    double frequency;
+};
+
+}
+
+class ResamplerTests : public juce::UnitTest {
+public:
+    ResamplerTests(): juce::UnitTest("SincResampler and ResamplingReader", "juce_mix_player") {}
+
+    void runTest() override {
+        beginTest("same rate is an exact copy");
+        for (int quality=0; quality<=2; quality++) {
+            SincResampler resampler;
+            resampler.prepare(quality, 1, 1, 256);
+            std::vector<float> input((size_t)resampler.getNumInputSamplesNeeded(256));
+            juce::Random random(quality);
+            for (float& sample: input) {
+                sample = random.nextFloat() * 2 - 1;
+            }
+            std::vector<float> output(256);
+            const float* in = input.data();
+            float* out = output.data();
+            expectEquals(resampler.process(&in, &out, 1, 256), 256, "consumes one input sample per output sample");
+            expect(std::equal(output.begin(), output.end(), input.begin()), "quality " + juce::String(quality));
+        }
+
+        beginTest("consumed input follows the ratio across calls");
+        for (double ratio: { 44100.0 / 48000.0, 48000.0 / 44100.0, 96000.0 / 48000.0, 22050.0 / 48000.0 }) {
+            SincResampler resampler;
+            resampler.prepare(1, ratio, 1, 512);
+            std::vector<float> input((size_t)resampler.getNumInputSamplesNeeded(512) + 64, 0.25f);
+            std::vector<float> output(512);
+            juce::Random random(3);
+            juce::int64 consumed = 0;
+            juce::int64 produced = 0;
+            for (int call=0; call<500; call++) {
+                // callbacks of varying size, as devices deliver them
+                const int numOutputSamples = 1 + random.nextInt(512);
+                expect(resampler.getNumInputSamplesNeeded(numOutputSamples) <= (int)input.size());
+                const float* in = input.data();
+                float* out = output.data();
+                consumed += resampler.process(&in, &out, 1, numOutputSamples);
+                produced += numOutputSamples;
+            }
+            const double expected = produced * ratio;
+            expect(std::abs((double)consumed - expected) < 1, "ratio " + juce::String(ratio) + " consumed "
+                   + juce::String(consumed) + " of " + juce::String(expected));
+        }
+
+        beginTest("a sine keeps its time position without latency");
+        for (int quality=1; quality<=2; quality++) {
+            const double inputRate = 44100;
+            const double outputRate = 48000;
+            const double ratio = inputRate / outputRate;
+            SincResampler resampler;
+            resampler.prepare(quality, ratio, 1, 256);
+            juce::int64 inputPosition = 0;
+            juce::int64 outputPosition = 0;
+            float maxError = 0;
+            for (int call=0; call<40; call++) {
+                std::vector<float> input((size_t)resampler.getNumInputSamplesNeeded(256));
+                for (size_t i=0; i<input.size(); i++) {
+                    input[i] = SineReader::getSample((inputPosition + (juce::int64)i) / inputRate, 1000);
+                }
+                std::vector<float> output(256);
+                const float* in = input.data();
+                float* out = output.data();
+                inputPosition += resampler.process(&in, &out, 1, 256);
+                for (int i=0; i<256; i++) {
+                    // the first taps read the silence before the input
+                    if (outputPosition + i >= 64) {
+                        const float expected = SineReader::getSample((outputPosition + i) / outputRate, 1000);
+                        maxError = std::max(maxError, std::abs(output[(size_t)i] - expected));
+                    }
+                }
+                outputPosition += 256;
+            }
+            expect(maxError < 0.01f, "quality " + juce::String(quality) + " max error " + juce::String(maxError));
+        }
+
+        beginTest("ResamplingReader reads the source at the converted position");
+        {
+            auto reader = std::make_unique<ResamplingReader>(new SineReader(44100, 44100 * 4, 440), 48000);
+            expectEquals(reader->lengthInSamples, (juce::int64)48000 * 4);
+            expectEquals(reader->sampleRate, 48000.0);
+
+            juce::AudioBuffer<float> buffer(2, 512);
+            for (juce::int64 start: { (juce::int64)1000, (juce::int64)24000, (juce::int64)100001 }) {
+                reader->read(&buffer, 0, 512, start, true, true);
+                float maxError = 0;
+                for (int i=0; i<512; i++) {
+                    const float expected = SineReader::getSample((start + i) / 48000.0, 440);
+                    maxError = std::max(maxError, std::abs(buffer.getSample(0, i) - expected));
+                    maxError = std::max(maxError, std::abs(buffer.getSample(1, i) - expected));
+                }
+                expect(maxError < 0.01f, "at " + juce::String(start) + " max error " + juce::String(maxError));
+            }
+        }
+
+        beginTest("ResamplingReader reads in pieces as in one");
+        {
+            auto reader = std::make_unique<ResamplingReader>(new SineReader(44100, 44100 * 2, 1234), 48000);
+            juce::AudioBuffer<float> whole(1, 1024);
+            juce::AudioBuffer<float> pieces(1, 1024);
+            reader->read(&whole, 0, 1024, 30000, true, false);
+            reader->read(&pieces, 0, 300, 30000, true, false);
+            reader->read(&pieces, 300, 724, 30300, true, false);
+            float maxDifference = 0;
+            for (int i=0; i<1024; i++) {
+                maxDifference = std::max(maxDifference, std::abs(whole.getSample(0, i) - pieces.getSample(0, i)));
+            }
+            expect(maxDifference < 1.0e-5f, "max difference " + juce::String(maxDifference));
+        }
+    }
+};
+
+static ResamplerTests resamplerTests;